@@ -24,6 +24,8 @@
 #include <functional>
 #include <memory>
 
+#include "SpriteQuads.h"
+
 
 namespace DirectX
 {
@@ -77,6 +79,14 @@ namespace DirectX
         void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color = Colors::White);
         void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
 
+        // Bulk submission of axis-aligned, unrotated quads that all show the same source rectangle (the whole
+        // texture if null). Vertices are generated straight from the arrays, skipping the per-sprite queue.
+        // Quads are written in order at the point of the call (any sprites queued before are flushed first),
+        // so they aren't sorted. Outside immediate mode, quads and sprites that follow each other in the
+        // vertex buffer with the same texture go to the GPU as one draw call, so packing sprites into an
+        // atlas collapses them into a single draw.
+        void XM_CALLCONV DrawQuads(_In_ ID3D11ShaderResourceView* texture, SpriteQuads const& quads, _In_opt_ RECT const* sourceRectangle = nullptr, FXMVECTOR color = Colors::White, XMFLOAT2 const& origin = Float2Zero, float layerDepth = 0);
+
         // Rotation mode to be applied to the sprite transformation
         void __cdecl SetRotation( DXGI_MODE_ROTATION mode );
         DXGI_MODE_ROTATION __cdecl GetRotation() const;
@@ -0,0 +1,192 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteQuads.h
+//
+// Bulk vertex generation for SpriteBatch::DrawQuads.
+//
+// Quads are axis-aligned and unrotated, all show the same source rectangle (the
+// whole texture by default, or one sprite of an atlas), and are passed as
+// parallel arrays rather than one Draw call each. Vertices are written
+// in the VertexPositionColorTexture layout (position xyz, color rgba, texcoord uv:
+// 9 floats), four quads at a time on SSE2, with a scalar loop for the remainder
+// and for other platforms.
+//
+// Doesn't depend on D3D or DirectXMath, so it can be built and benchmarked
+// anywhere.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DIRECTX_SPRITE_QUADS_SSE2
+#include <xmmintrin.h>
+#endif
+
+
+namespace DirectX
+{
+    // Quads to draw, one element per quad. Each covers the source size times
+    // scale[i], with the origin placed at (x[i], y[i]). The color arrays are
+    // optional: if r is null every quad uses SpriteQuadParams::color.
+    struct SpriteQuads
+    {
+        float const* x = nullptr;
+        float const* y = nullptr;
+        float const* scale = nullptr;
+        float const* r = nullptr;
+        float const* g = nullptr;
+        float const* b = nullptr;
+        float const* a = nullptr;
+        size_t count = 0;
+    };
+
+
+    // Values shared by every quad in the call.
+    struct SpriteQuadParams
+    {
+        float textureWidth = 0;     // Size of the source rectangle, in texels.
+        float textureHeight = 0;
+        float originX = 0;          // In texels, as for SpriteBatch::Draw.
+        float originY = 0;
+        float layerDepth = 0;
+        float color[4] = { 1, 1, 1, 1 };
+
+        // Source rectangle as texture coordinates.
+        float uvLeft = 0;
+        float uvTop = 0;
+        float uvRight = 1;
+        float uvBottom = 1;
+    };
+
+
+    static const size_t SpriteQuadVertexFloats = 9;
+    static const size_t SpriteQuadVertices = 4;
+    static const size_t SpriteQuadFloats = SpriteQuadVertices * SpriteQuadVertexFloats;
+
+
+    // Writes the four vertices of quads [begin, begin + count), in the same corner
+    // order as SpriteBatch: top left, top right, bottom left, bottom right.
+    inline void WriteSpriteQuadVertices(SpriteQuads const& quads,
+        SpriteQuadParams const& params,
+        size_t begin,
+        size_t count,
+        float* vertices)
+    {
+        size_t i = begin;
+        size_t const end = begin + count;
+
+#if defined(DIRECTX_SPRITE_QUADS_SSE2)
+        // Corners are computed for four quads side by side, then each group of
+        // four lanes is transposed into one quad's slice of the vertex stream.
+        // Per quad the 36 floats are nine rows of four (u0 v0 u1 v1 being the
+        // source rectangle):
+        //
+        //   [L T z r] [g b a u0] [v0 R T z] [r g b a] [u1 v0 L B]
+        //   [z r g b] [a u0 v1 R] [B z r g] [b a u1 v1]
+        const __m128 u0 = _mm_set1_ps(params.uvLeft);
+        const __m128 v0 = _mm_set1_ps(params.uvTop);
+        const __m128 u1 = _mm_set1_ps(params.uvRight);
+        const __m128 v1 = _mm_set1_ps(params.uvBottom);
+        const __m128 depth = _mm_set1_ps(params.layerDepth);
+        const __m128 width = _mm_set1_ps(params.textureWidth);
+        const __m128 height = _mm_set1_ps(params.textureHeight);
+        const __m128 originX = _mm_set1_ps(params.originX);
+        const __m128 originY = _mm_set1_ps(params.originY);
+
+        __m128 red = _mm_set1_ps(params.color[0]);
+        __m128 green = _mm_set1_ps(params.color[1]);
+        __m128 blue = _mm_set1_ps(params.color[2]);
+        __m128 alpha = _mm_set1_ps(params.color[3]);
+
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 scale = _mm_loadu_ps(quads.scale + i);
+            const __m128 left = _mm_sub_ps(_mm_loadu_ps(quads.x + i), _mm_mul_ps(originX, scale));
+            const __m128 top = _mm_sub_ps(_mm_loadu_ps(quads.y + i), _mm_mul_ps(originY, scale));
+            const __m128 right = _mm_add_ps(left, _mm_mul_ps(width, scale));
+            const __m128 bottom = _mm_add_ps(top, _mm_mul_ps(height, scale));
+
+            if (quads.r)
+            {
+                red = _mm_loadu_ps(quads.r + i);
+                green = _mm_loadu_ps(quads.g + i);
+                blue = _mm_loadu_ps(quads.b + i);
+                alpha = _mm_loadu_ps(quads.a + i);
+            }
+
+            const __m128 columns[9][4] =
+            {
+                { left, top, depth, red },
+                { green, blue, alpha, u0 },
+                { v0, right, top, depth },
+                { red, green, blue, alpha },
+                { u1, v0, left, bottom },
+                { depth, red, green, blue },
+                { alpha, u0, v1, right },
+                { bottom, depth, red, green },
+                { blue, alpha, u1, v1 },
+            };
+
+            float* out = vertices + (i - begin) * SpriteQuadFloats;
+
+            for (size_t row = 0; row < 9; row++)
+            {
+                __m128 q0 = columns[row][0];
+                __m128 q1 = columns[row][1];
+                __m128 q2 = columns[row][2];
+                __m128 q3 = columns[row][3];
+
+                _MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+
+                _mm_storeu_ps(out + row * 4, q0);
+                _mm_storeu_ps(out + row * 4 + SpriteQuadFloats, q1);
+                _mm_storeu_ps(out + row * 4 + SpriteQuadFloats * 2, q2);
+                _mm_storeu_ps(out + row * 4 + SpriteQuadFloats * 3, q3);
+            }
+        }
+#endif
+
+        for (; i < end; i++)
+        {
+            const float scale = quads.scale[i];
+            const float left = quads.x[i] - params.originX * scale;
+            const float top = quads.y[i] - params.originY * scale;
+            const float right = left + params.textureWidth * scale;
+            const float bottom = top + params.textureHeight * scale;
+
+            const float color[4] =
+            {
+                quads.r ? quads.r[i] : params.color[0],
+                quads.r ? quads.g[i] : params.color[1],
+                quads.r ? quads.b[i] : params.color[2],
+                quads.r ? quads.a[i] : params.color[3],
+            };
+
+            const float corners[SpriteQuadVertices][4] =
+            {
+                { left, top, params.uvLeft, params.uvTop },
+                { right, top, params.uvRight, params.uvTop },
+                { left, bottom, params.uvLeft, params.uvBottom },
+                { right, bottom, params.uvRight, params.uvBottom },
+            };
+
+            float* out = vertices + (i - begin) * SpriteQuadFloats;
+
+            for (size_t v = 0; v < SpriteQuadVertices; v++)
+            {
+                out[0] = corners[v][0];
+                out[1] = corners[v][1];
+                out[2] = params.layerDepth;
+                out[3] = color[0];
+                out[4] = color[1];
+                out[5] = color[2];
+                out[6] = color[3];
+                out[7] = corners[v][2];
+                out[8] = corners[v][3];
+
+                out += SpriteQuadVertexFloats;
+            }
+        }
+    }
+}
@@ -19,6 +19,7 @@
 #include "VertexTypes.h"
 #include "SharedResourcePool.h"
 #include "AlignedNew.h"
+#include "SpriteSort.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -66,6 +67,7 @@ __declspec(align(16)) class SpriteBatch::Impl : public AlignedNew<SpriteBatch::I
 {
 public:
     Impl(_In_ ID3D11DeviceContext* deviceContext);
+    ~Impl();
 
     void XM_CALLCONV Begin(SpriteSortMode sortMode,
         _In_opt_ ID3D11BlendState* blendState,
@@ -83,6 +85,13 @@ public:
         FXMVECTOR originRotationDepth,
         int flags);
 
+    void XM_CALLCONV DrawQuads(_In_ ID3D11ShaderResourceView* texture,
+        SpriteQuads const& quads,
+        _In_opt_ RECT const* sourceRectangle,
+        FXMVECTOR color,
+        XMFLOAT2 const& origin,
+        float layerDepth);
+
 
     // Info about a single sprite that is waiting to be drawn.
     __declspec(align(16)) struct SpriteInfo : public AlignedNew<SpriteInfo>
@@ -116,6 +125,11 @@ private:
     void GrowSortedSprites();
 
     void RenderBatch(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteInfo const* const* sprites, size_t count);
+    void RenderQuads(_In_ ID3D11ShaderResourceView* texture, SpriteQuads const& quads, SpriteQuadParams const& params);
+
+    void QueueDraw(_In_ ID3D11ShaderResourceView* texture, size_t bufferPosition, size_t count);
+    void DrawPending();
+    void DrawAllPending();
 
     static void XM_CALLCONV RenderSprite(_In_ SpriteInfo const* sprite,
         _Out_writes_(VerticesPerSprite) VertexPositionColorTexture* vertices,
@@ -147,6 +161,16 @@ private:
     // mSpriteQueue array, and we take care to keep them in order when sorting is disabled.
     std::vector<SpriteInfo const*> mSortedSprites;
 
+    // Sort keys and index buffers for the sorted modes.
+    SpriteSort::RadixSorter mSortKeys;
+
+
+    // Vertices written to the vertex buffer but not yet drawn. Outside immediate mode, consecutive
+    // batches that share a texture and follow on in the buffer are drawn with a single DrawIndexed.
+    ComPtr<ID3D11ShaderResourceView> mPendingTexture;
+    size_t mPendingStart;
+    size_t mPendingCount;
+
 
     // If each SpriteInfo instance held a refcount on its texture, could end up with
     // many redundant AddRef/Release calls on the same object, so instead we use
@@ -205,6 +229,9 @@ private:
 
         bool inImmediateMode;
 
+        // The SpriteBatch with undrawn vertices in the buffer, which must be drawn before it is discarded.
+        Impl* pendingDrawOwner;
+
     private:
         void CreateVertexBuffer();
     };
@@ -319,7 +346,8 @@ std::vector<short> SpriteBatch::Impl::DeviceResources::CreateIndexValues()
 SpriteBatch::Impl::ContextResources::ContextResources(_In_ ID3D11DeviceContext* context)
   :constantBuffer(GetDevice(context).Get()),
     vertexBufferPosition(0),
-    inImmediateMode(false)
+    inImmediateMode(false),
+    pendingDrawOwner(nullptr)
 {
 #if defined(_XBOX_ONE) && defined(_TITLE)
     ThrowIfFailed(context->QueryInterface(IID_GRAPHICS_PPV_ARGS(deviceContext.GetAddressOf())));
@@ -376,6 +404,8 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
     mViewPort{},
     mSpriteQueueCount(0),
     mSpriteQueueArraySize(0),
+    mPendingStart(0),
+    mPendingCount(0),
     mInBeginEndPair(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
@@ -385,6 +415,16 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
 }
 
 
+SpriteBatch::Impl::~Impl()
+{
+    // Vertices left undrawn by a batch that never reached End are abandoned.
+    if (mContextResources->pendingDrawOwner == this)
+    {
+        mContextResources->pendingDrawOwner = nullptr;
+    }
+}
+
+
 // Begins a batch of sprite drawing operations.
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Impl::Begin(SpriteSortMode sortMode,
@@ -440,6 +480,7 @@ void SpriteBatch::Impl::End()
 
         PrepareForRendering();
         FlushBatch();
+        DrawPending();
     }
 
     // Break circular reference chains, in case the state lambda closed
@@ -528,6 +569,65 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
 }
 
 
+// Draws a batch of axis-aligned quads straight from the caller's arrays.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::DrawQuads(ID3D11ShaderResourceView* texture,
+    SpriteQuads const& quads,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    XMFLOAT2 const& origin,
+    float layerDepth)
+{
+    if (!texture)
+        throw std::exception("Texture cannot be null");
+
+    if (!mInBeginEndPair)
+        throw std::exception("Begin must be called before DrawQuads");
+
+    if (!quads.count)
+        return;
+
+    if (mSortMode != SpriteSortMode_Immediate)
+    {
+        if (mContextResources->inImmediateMode)
+            throw std::exception("Cannot draw quads from one SpriteBatch while another is using SpriteSortMode_Immediate");
+
+        // Keep the submission order: anything queued so far goes first.
+        PrepareForRendering();
+        FlushBatch();
+    }
+
+    XMVECTOR textureSize = GetTextureSize(texture);
+
+    float textureWidth = XMVectorGetX(textureSize);
+    float textureHeight = XMVectorGetY(textureSize);
+
+    SpriteQuadParams params;
+
+    if (sourceRectangle)
+    {
+        params.textureWidth = float(sourceRectangle->right - sourceRectangle->left);
+        params.textureHeight = float(sourceRectangle->bottom - sourceRectangle->top);
+        params.uvLeft = sourceRectangle->left / textureWidth;
+        params.uvTop = sourceRectangle->top / textureHeight;
+        params.uvRight = sourceRectangle->right / textureWidth;
+        params.uvBottom = sourceRectangle->bottom / textureHeight;
+    }
+    else
+    {
+        params.textureWidth = textureWidth;
+        params.textureHeight = textureHeight;
+    }
+
+    params.originX = origin.x;
+    params.originY = origin.y;
+    params.layerDepth = layerDepth;
+    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(params.color), color);
+
+    RenderQuads(texture, quads, params);
+}
+
+
 // Dynamically expands the array used to store pending sprite information.
 void SpriteBatch::Impl::GrowSpriteQueue()
 {
@@ -674,34 +774,46 @@ void SpriteBatch::Impl::SortSprites()
         GrowSortedSprites();
     }
 
+    // Sort an index per sprite by a packed key, rather than comparing through the
+    // sprite pointers. The radix sort is stable, so sprites with equal keys stay
+    // in the order they were drawn.
+    uint64_t* keys = mSortKeys.Keys(mSpriteQueueCount);
+
     switch (mSortMode)
     {
         case SpriteSortMode_Texture:
             // Sort by texture.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            for (size_t i = 0; i < mSpriteQueueCount; i++)
             {
-                return x->texture < y->texture;
-            });
+                keys[i] = SpriteSort::TextureKey(mSpriteQueue[i].texture);
+            }
             break;
 
         case SpriteSortMode_BackToFront:
             // Sort back to front.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            for (size_t i = 0; i < mSpriteQueueCount; i++)
             {
-                return x->originRotationDepth.w > y->originRotationDepth.w;
-            });
+                keys[i] = SpriteSort::DescendingDepthKey(mSpriteQueue[i].originRotationDepth.w);
+            }
             break;
 
         case SpriteSortMode_FrontToBack:
             // Sort front to back.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            for (size_t i = 0; i < mSpriteQueueCount; i++)
             {
-                return x->originRotationDepth.w < y->originRotationDepth.w;
-            });
+                keys[i] = SpriteSort::AscendingDepthKey(mSpriteQueue[i].originRotationDepth.w);
+            }
             break;
 
         default:
-            break;
+            return;
+    }
+
+    uint32_t const* order = mSortKeys.Sort(mSpriteQueueCount);
+
+    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    {
+        mSortedSprites[i] = &mSpriteQueue[order[i]];
     }
 }
 
@@ -726,9 +838,6 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 {
     auto deviceContext = mContextResources->deviceContext.Get();
 
-    // Draw using the specified texture.
-    deviceContext->PSSetShaderResources(0, 1, &texture);
-
     XMVECTOR textureSize = GetTextureSize(texture);
     XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
             
@@ -761,6 +870,12 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 
         auto vertices = static_cast<VertexPositionColorTexture*>(grfxMemory);
 #else
+        // Anything still to be drawn from the buffer has to go before it is discarded.
+        if (mContextResources->vertexBufferPosition == 0)
+        {
+            DrawAllPending();
+        }
+
         // Lock the vertex buffer.
         D3D11_MAP mapType = (mContextResources->vertexBufferPosition == 0) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
 
@@ -790,10 +905,7 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 #endif
 
         // Ok lads, the time has come for us draw ourselves some sprites!
-        UINT startIndex = (UINT)mContextResources->vertexBufferPosition * IndicesPerSprite;
-        UINT indexCount = (UINT)batchSize * IndicesPerSprite;
-
-        deviceContext->DrawIndexed(indexCount, startIndex, 0);
+        QueueDraw(texture, mContextResources->vertexBufferPosition, batchSize);
 
         // Advance the buffer position.
 #if !defined(_XBOX_ONE) || !defined(_TITLE)
@@ -806,6 +918,155 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 }
 
 
+// Submits quads to the GPU, generating their vertices straight into the vertex buffer.
+_Use_decl_annotations_
+void SpriteBatch::Impl::RenderQuads(ID3D11ShaderResourceView* texture, SpriteQuads const& quads, SpriteQuadParams const& params)
+{
+    static_assert(sizeof(VertexPositionColorTexture) == SpriteQuadVertexFloats * sizeof(float), "SpriteQuads writes the VertexPositionColorTexture layout");
+
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    size_t begin = 0;
+    size_t count = quads.count;
+
+    while (count > 0)
+    {
+        // Same buffer management as RenderBatch.
+        size_t batchSize = count;
+        size_t remainingSpace = MaxBatchSize - mContextResources->vertexBufferPosition;
+
+        if (batchSize > remainingSpace)
+        {
+            if (remainingSpace < MinBatchSize)
+            {
+                mContextResources->vertexBufferPosition = 0;
+
+                batchSize = std::min(count, MaxBatchSize);
+            }
+            else
+            {
+                batchSize = remainingSpace;
+            }
+        }
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+        void *grfxMemory = GraphicsMemory::Get().Allocate(deviceContext, sizeof(VertexPositionColorTexture) * batchSize * VerticesPerSprite, 64);
+
+        auto vertices = static_cast<VertexPositionColorTexture*>(grfxMemory);
+#else
+        if (mContextResources->vertexBufferPosition == 0)
+        {
+            DrawAllPending();
+        }
+
+        D3D11_MAP mapType = (mContextResources->vertexBufferPosition == 0) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
+        D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+
+        ThrowIfFailed(
+            deviceContext->Map(mContextResources->vertexBuffer.Get(), 0, mapType, 0, &mappedBuffer)
+        );
+
+        auto vertices = static_cast<VertexPositionColorTexture*>(mappedBuffer.pData) + mContextResources->vertexBufferPosition * VerticesPerSprite;
+#endif
+
+        WriteSpriteQuadVertices(quads, params, begin, batchSize, reinterpret_cast<float*>(vertices));
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+        deviceContext->IASetPlacementVertexBuffer(0, mContextResources->vertexBuffer.Get(), grfxMemory, sizeof(VertexPositionColorTexture));
+#else
+        deviceContext->Unmap(mContextResources->vertexBuffer.Get(), 0);
+#endif
+
+        QueueDraw(texture, mContextResources->vertexBufferPosition, batchSize);
+
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+        mContextResources->vertexBufferPosition += batchSize;
+#endif
+
+        begin += batchSize;
+        count -= batchSize;
+    }
+}
+
+
+// Draws vertices just written to the buffer, or holds on to them while the draw can still be merged
+// with what comes next.
+_Use_decl_annotations_
+void SpriteBatch::Impl::QueueDraw(ID3D11ShaderResourceView* texture, size_t bufferPosition, size_t count)
+{
+    if (mPendingCount && (texture != mPendingTexture.Get() || bufferPosition != mPendingStart + mPendingCount))
+    {
+        DrawPending();
+    }
+
+    if (!mPendingCount)
+    {
+        mPendingTexture = texture;
+        mPendingStart = bufferPosition;
+    }
+
+    mPendingCount += count;
+    mContextResources->pendingDrawOwner = this;
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    // Each batch has its own placement vertex buffer.
+    DrawPending();
+#else
+    if (mSortMode == SpriteSortMode_Immediate)
+    {
+        DrawPending();
+    }
+#endif
+}
+
+
+// Issues the held draw.
+void SpriteBatch::Impl::DrawPending()
+{
+    if (!mPendingCount)
+        return;
+
+    auto deviceContext = mContextResources->deviceContext.Get();
+    ID3D11ShaderResourceView* texture = mPendingTexture.Get();
+
+    deviceContext->PSSetShaderResources(0, 1, &texture);
+
+    UINT startIndex = (UINT)mPendingStart * IndicesPerSprite;
+    UINT indexCount = (UINT)mPendingCount * IndicesPerSprite;
+
+    deviceContext->DrawIndexed(indexCount, startIndex, 0);
+
+    mPendingTexture.Reset();
+    mPendingCount = 0;
+
+    if (mContextResources->pendingDrawOwner == this)
+    {
+        mContextResources->pendingDrawOwner = nullptr;
+    }
+}
+
+
+// Issues held draws before the vertex buffer is discarded, including another SpriteBatch's on the same
+// context, which needs its own device state set for it.
+void SpriteBatch::Impl::DrawAllPending()
+{
+    Impl* owner = mContextResources->pendingDrawOwner;
+
+    if (owner == this)
+    {
+        DrawPending();
+    }
+    else if (owner)
+    {
+        owner->PrepareForRendering();
+        owner->DrawPending();
+
+        PrepareForRendering();
+    }
+}
+
+
 // Generates vertex data for drawing a single sprite.
 _Use_decl_annotations_
 void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
@@ -1181,6 +1442,18 @@ void XM_CALLCONV SpriteBatch::Draw(ID3D11ShaderResourceView* texture,
 }
 
 
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::DrawQuads(ID3D11ShaderResourceView* texture,
+    SpriteQuads const& quads,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    XMFLOAT2 const& origin,
+    float layerDepth)
+{
+    pImpl->DrawQuads(texture, quads, sourceRectangle, color, origin, layerDepth);
+}
+
+
 void SpriteBatch::SetRotation( DXGI_MODE_ROTATION mode )
 {
     pImpl->mRotation = mode;
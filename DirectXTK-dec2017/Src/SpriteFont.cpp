@@ -20,6 +20,7 @@
 #include "DirectXHelpers.h"
 #include "BinaryReader.h"
 #include "LoaderHelpers.h"
+#include "SpriteFontLayout.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -35,6 +36,9 @@ public:
     Glyph const* FindGlyph(wchar_t character) const;
 
     void SetDefaultCharacter(wchar_t character);
+    void SetLineSpacing(float spacing);
+
+    SpriteFontLayout::Layout<Glyph> const& GetLayout(_In_z_ wchar_t const* text) const;
 
     template<typename TAction>
     void ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const;
@@ -43,8 +47,13 @@ public:
     // Fields.
     ComPtr<ID3D11ShaderResourceView> texture;
     std::vector<Glyph> glyphs;
+    SpriteFontLayout::GlyphTable<Glyph> glyphTable;
     Glyph const* defaultGlyph;
     float lineSpacing;
+
+    // Layouts of recently drawn and measured strings. Like SpriteBatch, a font is
+    // only used from one thread at a time.
+    mutable SpriteFontLayout::LayoutCache<Glyph> layouts;
 };
 
 
@@ -54,23 +63,13 @@ const XMFLOAT2 SpriteFont::Float2Zero(0, 0);
 static const char spriteFontMagic[] = "DXTKfont";
 
 
-// Comparison operators make our sorted glyph vector work with std::binary_search and lower_bound.
+// Comparison operator lets std::is_sorted check user specified glyphs are in order.
 namespace DirectX
 {
     static inline bool operator< (SpriteFont::Glyph const& left, SpriteFont::Glyph const& right)
     {
         return left.Character < right.Character;
     }
-
-    static inline bool operator< (wchar_t left, SpriteFont::Glyph const& right)
-    {
-        return left < right.Character;
-    }
-
-    static inline bool operator< (SpriteFont::Glyph const& left, wchar_t right)
-    {
-        return left.Character < right;
-    }
 }
 
 
@@ -93,6 +92,7 @@ SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, boo
     auto glyphData = reader->ReadArray<Glyph>(glyphCount);
 
     glyphs.assign(glyphData, glyphData + glyphCount);
+    glyphTable.Build(glyphs.data(), glyphs.size());
 
     // Read font properties.
     lineSpacing = reader->Read<float>();
@@ -143,17 +143,19 @@ SpriteFont::Impl::Impl(ID3D11ShaderResourceView* texture, Glyph const* glyphs, s
     {
         throw std::exception("Glyphs must be in ascending codepoint order");
     }
+
+    glyphTable.Build(this->glyphs.data(), this->glyphs.size());
 }
 
 
 // Looks up the requested glyph, falling back to the default character if it is not in the font.
 SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
 {
-    auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), character);
+    auto glyph = glyphTable.Find(character);
 
-    if (glyph != glyphs.end() && glyph->Character == character)
+    if (glyph)
     {
-        return &*glyph;
+        return glyph;
     }
 
     if (defaultGlyph)
@@ -175,53 +177,37 @@ void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
     {
         defaultGlyph = FindGlyph(character);
     }
+
+    // Missing characters lay out differently now.
+    layouts.Clear();
 }
 
 
-// The core glyph layout algorithm, shared between DrawString and MeasureString.
-template<typename TAction>
-void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const
+void SpriteFont::Impl::SetLineSpacing(float spacing)
 {
-    float x = 0;
-    float y = 0;
-
-    for (; *text; text++)
-    {
-        wchar_t character = *text;
-
-        switch (character)
-        {
-            case '\r':
-                // Skip carriage returns.
-                continue;
+    lineSpacing = spacing;
 
-            case '\n':
-                // New line.
-                x = 0;
-                y += lineSpacing;
-                break;
-
-            default:
-                // Output this character.
-                auto glyph = FindGlyph(character);
-
-                x += glyph->XOffset;
+    layouts.Clear();
+}
 
-                if (x < 0)
-                    x = 0;
 
-                float advance = glyph->Subrect.right - glyph->Subrect.left + glyph->XAdvance;
+// Looks up the layout of a string, laying it out if it isn't cached.
+SpriteFontLayout::Layout<SpriteFont::Glyph> const& SpriteFont::Impl::GetLayout(_In_z_ wchar_t const* text) const
+{
+    return layouts.Get(text, [this](wchar_t const* str, SpriteFontLayout::Layout<Glyph>& layout)
+    {
+        SpriteFontLayout::LayOut(str, [this](wchar_t character) { return FindGlyph(character); }, lineSpacing, layout);
+    });
+}
 
-                if ( !iswspace(character)
-                     || ( ( glyph->Subrect.right - glyph->Subrect.left ) > 1 )
-                     || ( ( glyph->Subrect.bottom - glyph->Subrect.top ) > 1 ) )
-                {
-                    action(glyph, x, y, advance);
-                }
 
-                x += advance;
-                break;
-        }
+// Calls action for each glyph of the string's cached layout. Shared between DrawString and the measuring functions.
+template<typename TAction>
+void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const
+{
+    for (auto const& placed : GetLayout(text).glyphs)
+    {
+        action(placed.glyph, placed.x, placed.y, placed.advance);
     }
 }
 
@@ -315,18 +301,22 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
         { { { 1, 1, 0, 0 } } },
     };
 
+    auto const& layout = pImpl->GetLayout(text);
+
     XMVECTOR baseOffset = origin;
 
     // If the text is mirrored, offset the start position accordingly.
     if (effects)
     {
-        baseOffset -= MeasureString(text) * axisIsMirroredTable[effects & 3];
+        baseOffset -= XMVectorSet(layout.width, layout.height, 0, 0) * axisIsMirroredTable[effects & 3];
     }
 
     // Draw each character in turn.
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    for (auto const& placed : layout.glyphs)
     {
-        UNREFERENCED_PARAMETER(advance);
+        Glyph const* glyph = placed.glyph;
+        float x = placed.x;
+        float y = placed.y;
 
         XMVECTOR offset = XMVectorMultiplyAdd(XMVectorSet(x, y + glyph->YOffset, 0, 0), axisDirectionTable[effects & 3], baseOffset);
         
@@ -342,27 +332,16 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
         }
 
         spriteBatch->Draw(pImpl->texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
-    });
+    }
 }
 
 
 XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
 {
-    XMVECTOR result = XMVectorZero();
-
-    pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
-    {
-        UNREFERENCED_PARAMETER(advance);
-
-        float w = (float)(glyph->Subrect.right - glyph->Subrect.left);
-        float h = (float)(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
-
-        h = std::max(h, pImpl->lineSpacing);
+    // Extents are worked out along with the layout.
+    auto const& layout = pImpl->GetLayout(text);
 
-        result = XMVectorMax(result, XMVectorSet(x + w, y + h, 0, 0));
-    });
-
-    return result;
+    return XMVectorSet(layout.width, layout.height, 0, 0);
 }
 
 
@@ -422,7 +401,7 @@ float SpriteFont::GetLineSpacing() const
 
 void SpriteFont::SetLineSpacing(float spacing)
 {
-    pImpl->lineSpacing = spacing;
+    pImpl->SetLineSpacing(spacing);
 }
 
 
@@ -441,7 +420,7 @@ void SpriteFont::SetDefaultCharacter(wchar_t character)
 
 bool SpriteFont::ContainsCharacter(wchar_t character) const
 {
-    return std::binary_search(pImpl->glyphs.begin(), pImpl->glyphs.end(), character);
+    return pImpl->glyphTable.Find(character) != nullptr;
 }
 
 
@@ -0,0 +1,277 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteFontLayout.h
+//
+// Glyph lookup and string layout caching for SpriteFont.
+//
+// GlyphTable maps characters to glyphs with a direct-mapped array over the range of
+// the Basic Multilingual Plane the font covers, instead of a binary search per
+// character. LayoutCache keeps the laid out glyphs and measured extents of recently
+// drawn strings, so a label drawn or measured every frame is laid out once and then
+// costs a single hash lookup.
+//
+// Templated on the glyph type, and doesn't depend on D3D or DirectXMath, so it can be
+// built and benchmarked anywhere.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cwctype>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace SpriteFontLayout
+    {
+        // One glyph of a laid out string, at its position relative to the string's origin.
+        template<typename TGlyph>
+        struct PlacedGlyph
+        {
+            TGlyph const* glyph;
+            float x;
+            float y;
+            float advance;
+        };
+
+
+        template<typename TGlyph>
+        struct Layout
+        {
+            std::vector<PlacedGlyph<TGlyph>> glyphs;
+            float width = 0;            // As returned by SpriteFont::MeasureString.
+            float height = 0;
+        };
+
+
+        // Characters in the font's BMP range index straight into a table of glyph
+        // pointers. Characters outside it (only possible where wchar_t is 32-bit) are
+        // binary searched. Glyphs must be sorted by character and outlive the table.
+        template<typename TGlyph>
+        class GlyphTable
+        {
+        public:
+            void Build(TGlyph const* glyphs, size_t count)
+            {
+                mGlyphs = glyphs;
+                mCount = count;
+                mFirst = 0;
+                mTable.clear();
+
+                if (!count || glyphs[0].Character > LastBmpCharacter)
+                    return;
+
+                mFirst = glyphs[0].Character;
+
+                uint32_t last = mFirst;
+
+                for (size_t i = 0; i < count && glyphs[i].Character <= LastBmpCharacter; i++)
+                {
+                    last = glyphs[i].Character;
+                }
+
+                mTable.assign(last - mFirst + 1, nullptr);
+
+                for (size_t i = 0; i < count && glyphs[i].Character <= last; i++)
+                {
+                    mTable[glyphs[i].Character - mFirst] = &glyphs[i];
+                }
+            }
+
+            // Returns null if the font doesn't have the character.
+            TGlyph const* Find(uint32_t character) const
+            {
+                // Characters below mFirst wrap around to large indices.
+                uint32_t index = character - mFirst;
+
+                if (index < mTable.size())
+                    return mTable[index];
+
+                if (character <= LastBmpCharacter)
+                    return nullptr;
+
+                auto glyph = std::lower_bound(mGlyphs, mGlyphs + mCount, character,
+                    [](TGlyph const& g, uint32_t c) { return g.Character < c; });
+
+                return (glyph != mGlyphs + mCount && glyph->Character == character) ? glyph : nullptr;
+            }
+
+        private:
+            static const uint32_t LastBmpCharacter = 0xFFFF;
+
+            TGlyph const* mGlyphs = nullptr;
+            size_t mCount = 0;
+            uint32_t mFirst = 0;
+            std::vector<TGlyph const*> mTable;
+        };
+
+
+        // SpriteFont's layout rules: '\r' is skipped, '\n' starts a new line, and
+        // whitespace with an empty glyph advances without being placed. findGlyph must
+        // return a glyph for every character (or throw).
+        template<typename TGlyph, typename TFindGlyph>
+        void LayOut(wchar_t const* text, TFindGlyph findGlyph, float lineSpacing, Layout<TGlyph>& layout)
+        {
+            layout.glyphs.clear();
+            layout.width = 0;
+            layout.height = 0;
+
+            float x = 0;
+            float y = 0;
+
+            for (; *text; text++)
+            {
+                wchar_t character = *text;
+
+                switch (character)
+                {
+                    case '\r':
+                        continue;
+
+                    case '\n':
+                        x = 0;
+                        y += lineSpacing;
+                        break;
+
+                    default:
+                        TGlyph const* glyph = findGlyph(character);
+
+                        x += glyph->XOffset;
+
+                        if (x < 0)
+                            x = 0;
+
+                        float w = float(glyph->Subrect.right - glyph->Subrect.left);
+                        float h = float(glyph->Subrect.bottom - glyph->Subrect.top);
+                        float advance = w + glyph->XAdvance;
+
+                        if (!iswspace(character) || w > 1 || h > 1)
+                        {
+                            layout.glyphs.push_back({ glyph, x, y, advance });
+
+                            layout.width = std::max(layout.width, x + w);
+                            layout.height = std::max(layout.height, y + std::max(h + glyph->YOffset, lineSpacing));
+                        }
+
+                        x += advance;
+                        break;
+                }
+            }
+        }
+
+
+        // Least recently used cache of string layouts. Entries are found by a hash of
+        // the text and confirmed by comparing it. Evicted entries keep their buffers for
+        // the next string, and a steady set of strings is laid out once and from then on
+        // only looked up. Very long strings are laid out every time rather than cached.
+        template<typename TGlyph>
+        class LayoutCache
+        {
+        public:
+            static const size_t DefaultCapacity = 256;
+            static const size_t MaxCachedLength = 256;
+
+            explicit LayoutCache(size_t capacity = DefaultCapacity)
+              : mCapacity(std::max<size_t>(capacity, 1))
+            {
+                mIndex.reserve(mCapacity);
+            }
+
+            // Returns the layout of text, calling layOut(text, layout) on a miss. The
+            // reference is valid until the next call.
+            template<typename TLayOut>
+            Layout<TGlyph> const& Get(wchar_t const* text, TLayOut layOut)
+            {
+                uint64_t hash = 14695981039346656037ull;
+                size_t length = 0;
+
+                for (; text[length]; length++)
+                {
+                    hash = (hash ^ uint64_t(text[length])) * 1099511628211ull;
+                }
+
+                if (length > MaxCachedLength)
+                {
+                    layOut(text, mUncached);
+                    return mUncached;
+                }
+
+                auto found = mIndex.find(hash);
+
+                if (found != mIndex.end())
+                {
+                    auto entry = found->second;
+
+                    mEntries.splice(mEntries.begin(), mEntries, entry);
+
+                    if (entry->text.size() != length || memcmp(entry->text.data(), text, length * sizeof(wchar_t)) != 0)
+                    {
+                        // Hash collision: the newer string takes the slot.
+                        entry->text.clear();
+                        layOut(text, entry->layout);
+                        entry->text.assign(text, length);
+                    }
+
+                    return entry->layout;
+                }
+
+                if (mEntries.size() < mCapacity)
+                {
+                    mEntries.emplace_front();
+                }
+                else
+                {
+                    auto last = std::prev(mEntries.end());
+                    auto indexed = mIndex.find(last->hash);
+
+                    if (indexed != mIndex.end() && indexed->second == last)
+                    {
+                        mIndex.erase(indexed);
+                    }
+
+                    mEntries.splice(mEntries.begin(), mEntries, last);
+                }
+
+                // Only indexed once laid out, in case layOut throws.
+                Entry& entry = mEntries.front();
+
+                layOut(text, entry.layout);
+
+                entry.hash = hash;
+                entry.text.assign(text, length);
+
+                mIndex.emplace(hash, mEntries.begin());
+
+                return entry.layout;
+            }
+
+            void Clear()
+            {
+                mEntries.clear();
+                mIndex.clear();
+            }
+
+        private:
+            struct Entry
+            {
+                uint64_t hash = 0;
+                std::wstring text;
+                Layout<TGlyph> layout;
+            };
+
+            size_t mCapacity;
+
+            // Most recently used first.
+            std::list<Entry> mEntries;
+            std::unordered_map<uint64_t, typename std::list<Entry>::iterator> mIndex;
+
+            Layout<TGlyph> mUncached;
+        };
+    }
+}
@@ -0,0 +1,167 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteSort.h
+//
+// Key based sorting for SpriteBatch's sorted modes.
+//
+// Each sprite gets an unsigned integer key whose order matches the sort mode's
+// comparison (texture pointer, or layer depth mapped to bits), and a stable LSD
+// radix sort orders sprite indices by key: linear in the sprite count, and it
+// never touches the sprites themselves. Sprites with equal keys keep the order
+// they were drawn in.
+//
+// Doesn't depend on D3D or DirectXMath, so it can be built and benchmarked
+// anywhere.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace SpriteSort
+    {
+        // Orders the same way as comparing the pointers.
+        inline uint64_t TextureKey(void const* texture)
+        {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(texture));
+        }
+
+
+        // Orders the same way as comparing the floats: negative values have
+        // all their bits flipped, positive ones just the sign bit. -0 counts as
+        // +0, as it does for the comparison.
+        inline uint64_t AscendingDepthKey(float depth)
+        {
+            depth += 0.0f;
+
+            uint32_t bits;
+            memcpy(&bits, &depth, sizeof(bits));
+
+            return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        }
+
+
+        inline uint64_t DescendingDepthKey(float depth)
+        {
+            return ~AscendingDepthKey(depth) & 0xFFFFFFFFu;
+        }
+
+
+        // Stable LSD radix sort, 8 bits per pass. Digits that are the same in
+        // every key are skipped, so 32-bit keys or a handful of textures take
+        // few passes, and the histograms for the rest are counted in one pass
+        // over the keys. Buffers are kept between sorts.
+        class RadixSorter
+        {
+        public:
+            // Space for one key per item, to fill before calling Sort.
+            uint64_t* Keys(size_t count)
+            {
+                if (mKeys.size() < count)
+                {
+                    mKeys.resize(count);
+                    mKeyScratch.resize(count);
+                    mIndices.resize(count);
+                    mIndexScratch.resize(count);
+                }
+
+                return mKeys.data();
+            }
+
+            // Returns the item indices in ascending key order.
+            uint32_t const* Sort(size_t count)
+            {
+                uint64_t* keys = mKeys.data();
+                uint64_t* keyScratch = mKeyScratch.data();
+                uint32_t* indices = mIndices.data();
+                uint32_t* indexScratch = mIndexScratch.data();
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    indices[i] = static_cast<uint32_t>(i);
+                }
+
+                if (count < 2)
+                    return indices;
+
+                // Only digits that differ between keys need a pass.
+                uint64_t keyOr = 0;
+                uint64_t keyAnd = ~uint64_t(0);
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    keyOr |= keys[i];
+                    keyAnd &= keys[i];
+                }
+
+                size_t shifts[Digits];
+                size_t numShifts = 0;
+
+                for (size_t shift = 0; shift < 64; shift += 8)
+                {
+                    if (((keyOr ^ keyAnd) >> shift) & 0xFF)
+                    {
+                        shifts[numShifts++] = shift;
+                    }
+                }
+
+                memset(mCounts, 0, sizeof(mCounts));
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    uint64_t key = keys[i];
+
+                    for (size_t pass = 0; pass < numShifts; pass++)
+                    {
+                        mCounts[pass][(key >> shifts[pass]) & 0xFF]++;
+                    }
+                }
+
+                for (size_t pass = 0; pass < numShifts; pass++)
+                {
+                    uint32_t* counts = mCounts[pass];
+                    size_t const shift = shifts[pass];
+
+                    // Counts become the start offset of each bucket.
+                    uint32_t offset = 0;
+
+                    for (size_t bucket = 0; bucket < 256; bucket++)
+                    {
+                        uint32_t bucketCount = counts[bucket];
+                        counts[bucket] = offset;
+                        offset += bucketCount;
+                    }
+
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        uint32_t dest = counts[(keys[i] >> shift) & 0xFF]++;
+
+                        keyScratch[dest] = keys[i];
+                        indexScratch[dest] = indices[i];
+                    }
+
+                    std::swap(keys, keyScratch);
+                    std::swap(indices, indexScratch);
+                }
+
+                return indices;
+            }
+
+        private:
+            static const size_t Digits = 8;
+
+            std::vector<uint64_t> mKeys;
+            std::vector<uint64_t> mKeyScratch;
+            std::vector<uint32_t> mIndices;
+            std::vector<uint32_t> mIndexScratch;
+
+            uint32_t mCounts[Digits][256];
+        };
+    }
+}
@@ -2,22 +2,13 @@
 #include "pch.h"
 #include "Entity.h"
 #include "UIDebugDraw.h"
+#include "Simulation/SimContext.h"
 
 //------------------------------------------------------------------------------
-constexpr int INITIAL_NUM_PLAYER_LIVES = 2;
-
 static const DirectX::SimpleMath::Vector4 CAMERA_LOOKAT
   = {0.0f, 0.0f, 0.0f, 0.0f};
 static const DirectX::SimpleMath::Vector4 CAMERA_UP = {0.0f, 1.0f, 0.0f, 0.0f};
 
-//------------------------------------------------------------------------------
-enum class PlayerState
-{
-  Normal,
-  Dying,
-  Reviving,
-};
-
 //------------------------------------------------------------------------------
 enum class ProfileViz
 {
@@ -28,7 +19,7 @@ enum class ProfileViz
 };
 
 //------------------------------------------------------------------------------
-struct AppContext
+struct AppContext : public SimContext
 {
   const float defaultCameraDistance = 80.0f;
 
@@ -41,56 +32,30 @@ struct AppContext
   DirectX::SimpleMath::Matrix viewToProjection;
   DirectX::SimpleMath::Matrix pixelsToProjection;
   DirectX::SimpleMath::Matrix projectionToPixels;
+  DirectX::SimpleMath::Matrix worldToPixels;    // For world space sprites
   float cameraRotationX = 0.0f;
   float cameraRotationY = 0.0f;
   float cameraDistance  = defaultCameraDistance;
 
-  size_t nextPlayerShotIdx = PLAYER_SHOTS_IDX;
-  size_t nextEnemyShotIdx  = ENEMY_SHOTS_IDX;
-  size_t nextEnemyIdx      = ENEMIES_IDX;
-  Entity entities[NUM_ENTITIES];
-
-  DirectX::SimpleMath::Vector3 playerAccel = {};
-  int playerScore                          = 0;
-  int playerLives                          = INITIAL_NUM_PLAYER_LIVES;
-  PlayerState playerState                  = PlayerState::Normal;
-  float playerDeathTimerS                  = 0.0f;
-  float playerReviveTimerS                 = 0.0f;
-
-  ui::Text uiScore;
-  ui::Text uiLives;
-
-  ProfileViz profileViz   = ProfileViz::Basic;
-  bool debugDraw          = false;
-  bool isMidiConnected    = false;
-  float playerSpeed       = 200.0f;
-  float playerFriction    = 60.0f;
-  float playerMaxVelocity = 40.0f;
-  float playerMinVelocity = 0.3f;
+  ui::FormattedText<32> uiScore;
+  ui::FormattedText<32> uiLives;
+
+  ProfileViz profileViz = ProfileViz::Basic;
+  bool debugDraw        = false;
+  bool isMidiConnected  = false;
 
   size_t editorLevelIdx     = 0;
   size_t editorFormationIdx = 0;
   size_t editorPathIdx      = 0;
 
-  ui::Text uiDebugVarsTitle;
-  ui::Text uiPlayerSpeed;
-  ui::Text uiPlayerFriction;
-  ui::Text uiPlayerMaxVelocity;
-  ui::Text uiPlayerMinVelocity;
-  ui::Text uiCameraDist;
+  ui::FormattedText<> uiDebugVarsTitle;
+  ui::FormattedText<> uiPlayerSpeed;
+  ui::FormattedText<> uiPlayerFriction;
+  ui::FormattedText<> uiPlayerMaxVelocity;
+  ui::FormattedText<> uiPlayerMinVelocity;
+  ui::FormattedText<> uiCameraDist;
   ui::Text uiControlInfo;
 
-  //----------------------------------------------------------------------------
-  void resetPlayer()
-  {
-    playerAccel        = DirectX::SimpleMath::Vector3();
-    playerScore        = 0;
-    playerLives        = INITIAL_NUM_PLAYER_LIVES;
-    playerState        = PlayerState::Normal;
-    playerDeathTimerS  = 0.0f;
-    playerReviveTimerS = 0.0f;
-  }
-
   //----------------------------------------------------------------------------
   void resetCamera()
   {
@@ -124,7 +89,8 @@ struct AppContext
   //----------------------------------------------------------------------------
   void updateViewMatrix()
   {
-    worldToView = XMMatrixLookAtRH(cameraPos(), CAMERA_LOOKAT, CAMERA_UP);
+    worldToView   = XMMatrixLookAtRH(cameraPos(), CAMERA_LOOKAT, CAMERA_UP);
+    worldToPixels = worldToView * viewToProjection * projectionToPixels;
   }
 };
 
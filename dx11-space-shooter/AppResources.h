@@ -4,31 +4,32 @@
 #include "DeviceResources.h"
 #include "ResourceIDs.h"    // ModelResource, AudioResource
 #include "Entity.h"         // ModelData
+#include "D3D11RenderBackend.h"
+#include "Render/CommandList.h"
+#include "Simulation/InputRecording.h"
+#include "Simulation/JobSystem.h"
+#include "Simulation/SimRandom.h"
 #include "Starfield.h"
 #include "Explosions.h"
+#include "TextureAtlas.h"
 #include "MenuManager.h"
 #include "ScoreBoard.h"
 #include "midi-controller/MidiController.h"
-
-//------------------------------------------------------------------------------
-struct Texture
-{
-  DirectX::XMVECTOR origin;
-  int width  = 0;
-  int height = 0;
-  Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> texture;
-
-  void CreateFromFile(ID3D11Device* d3dDevice, const wchar_t* fileName);
-};
+#include "utils/LinearArena.h"
 
 //------------------------------------------------------------------------------
 struct AppResources
 {
   // Random Generators
   std::random_device randDevice;
-  std::default_random_engine randEngine;
+  sim::Random randEngine;
 
   DX::StepTimer m_timer;
+  sim::JobSystem jobs;
+
+  // Scratch memory for the current frame, reset at the start of each tick
+  static constexpr size_t FRAME_ARENA_SIZE = 256 * 1024;
+  memory::LinearArena frameArena{FRAME_ARENA_SIZE};
 
   std::unique_ptr<DX::DeviceResources> m_deviceResources;
   std::unique_ptr<DirectX::Keyboard> m_keyboard;
@@ -40,10 +41,10 @@ struct AppResources
   midi::MidiController midiController;
   midi::MidiControllerTracker midiTracker;
 
+  sim::InputRecorder inputRecorder;
+
   std::unique_ptr<DirectX::CommonStates> m_states;
-  Texture starTexture;
-  Texture explosionTexture;
-  Texture shotTexture;
+  TextureAtlas atlas;
 
   std::unique_ptr<DirectX::SpriteBatch> m_spriteBatch;
   std::unique_ptr<DirectX::SpriteFont> font8pt;
@@ -53,7 +54,12 @@ struct AppResources
   std::unique_ptr<DirectX::SpriteFont> fontMono16pt;
   std::unique_ptr<DirectX::SpriteFont> fontMono32pt;
 
+  // The world is recorded into renderCommands each frame, then submitted
+  render::CommandList renderCommands;
+  D3D11RenderBackend renderBackend{*this};
+
   std::unique_ptr<DX::DebugBatchType> m_batch;
+  DX::PathDebugCache pathDebugCache;
   Microsoft::WRL::ComPtr<ID3D11InputLayout> m_debugInputLayout;
   std::unique_ptr<DirectX::BasicEffect> m_debugEffect;
 
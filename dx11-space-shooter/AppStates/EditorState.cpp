@@ -65,7 +65,8 @@ EditorState::Impl::update(const DX::StepTimer& timer)
 {
   TRACE
   m_resources.starField->update(timer);
-  m_gameLogic.m_enemies.incrementCurrentTime(timer);
+  m_gameLogic.m_enemies.incrementCurrentTime(
+    m_gameLogic.advanceSimClock(timer));
 
   m_modes.pCurrentMode->update(timer);
 
@@ -87,7 +88,14 @@ EditorState::Impl::render()
 {
   TRACE
   renderStarField();
-  m_gameLogic.renderEntityModels();
+
+  auto& commands = m_gameLogic.beginCommands();
+  m_gameLogic.recordEntityModels(commands);
+  if (m_context.debugDraw)
+  {
+    m_gameLogic.recordEntityBounds(commands);
+  }
+  m_resources.renderBackend.execute(commands);
 
   DX::DrawContext drawContext(m_context, m_resources);
   if (m_context.debugDraw)
@@ -234,6 +242,13 @@ void
 EditorState::enter()
 {
   TRACE
+  auto& recorder = m_resources.inputRecorder;
+  if (recorder.isRecording())
+  {
+    LOG_WARNING("Level edits can't be recorded, input recording stopped");
+    recorder.stop();
+    recorder.recording().save(sim::DEFAULT_INPUT_RECORDING_FILENAME);
+  }
   m_gameLogic.m_enemies.reset();
   m_pImpl->init();
 }
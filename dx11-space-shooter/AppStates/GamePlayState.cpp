@@ -11,16 +11,11 @@
 extern void ExitGame();
 
 //------------------------------------------------------------------------------
-constexpr float CAMERA_SPEED_X       = 1.0f;
-constexpr float CAMERA_SPEED_Y       = 1.0f;
-constexpr float CAMERA_MIN_DIST      = 30.0f;
-constexpr float UNIT_DIAGONAL_LENGTH = 0.7071067811865475f;
+constexpr float CAMERA_SPEED_X  = 1.0f;
+constexpr float CAMERA_SPEED_Y  = 1.0f;
+constexpr float CAMERA_MIN_DIST = 30.0f;
 
-constexpr size_t CAMERA_DIST_CONTROL         = 16;
-constexpr size_t PLAYER_SPEED_CONTROL        = 17;
-constexpr size_t PLAYER_FRICTION_CONTROL     = 18;
-constexpr size_t PLAYER_MAX_VELOCITY_CONTROL = 19;
-constexpr size_t PLAYER_MIN_VELOCITY_CONTROL = 20;
+constexpr size_t CAMERA_DIST_CONTROL = 16;
 
 //------------------------------------------------------------------------------
 void
@@ -29,8 +24,9 @@ GamePlayState::handleInput(const DX::StepTimer& timer)
   TRACE
   float elapsedTimeS = static_cast<float>(timer.GetElapsedSeconds());
 
-  auto& kb      = m_resources.kbTracker;
-  auto& kbState = m_resources.kbTracker.lastState;
+  auto& kb       = m_resources.kbTracker;
+  auto& kbState  = m_resources.kbTracker.lastState;
+  auto& recorder = m_resources.inputRecorder;
   using DirectX::Keyboard;
 
   if (kb.IsKeyPressed(Keyboard::Escape))
@@ -38,12 +34,33 @@ GamePlayState::handleInput(const DX::StepTimer& timer)
     m_states.changeState(&m_states.paused);
   }
 
-  // Debug options
+  // Player controls
+  sim::PlayerInput input;
+  auto setHeld = [&input](bool isDown, sim::InputButton button) {
+    input.held |= isDown ? button : 0;
+  };
+  setHeld(kbState.Up, sim::Input_Up);
+  setHeld(kbState.Down, sim::Input_Down);
+  setHeld(kbState.Left, sim::Input_Left);
+  setHeld(kbState.Right, sim::Input_Right);
+  if (
+    kb.IsKeyPressed(Keyboard::LeftControl) || kb.IsKeyPressed(Keyboard::Space))
+  {
+    input.pressed |= sim::Input_Fire;
+  }
   if (kb.IsKeyPressed(Keyboard::E))
   {
-    auto pos = m_context.entities[PLAYERS_IDX].position
-               + m_context.entities[PLAYERS_IDX].model->bound.Center;
-    m_resources.explosions->emit(pos, DirectX::SimpleMath::Vector3());
+    input.pressed |= sim::Input_Explode;
+  }
+  recorder.recordInput(input);
+
+  // Debug options
+  if (input.isPressed(sim::Input_Explode))
+  {
+    auto pos = m_context.entities.position(PLAYERS_IDX)
+               + m_context.bound(PLAYERS_IDX).Center;
+    m_resources.explosions->emit(
+      toVector3(pos), DirectX::SimpleMath::Vector3());
   }
 
   if (kb.IsKeyPressed(Keyboard::F2))
@@ -57,36 +74,25 @@ GamePlayState::handleInput(const DX::StepTimer& timer)
 
   const auto& midiMask  = m_resources.midiTracker.dirtyMask;
   const auto& midiState = m_resources.midiTracker.currentState;
-  if (midiMask.test(CAMERA_DIST_CONTROL))
-  {
-    m_context.cameraDistance
-      = static_cast<float>(midiState[CAMERA_DIST_CONTROL]) + CAMERA_MIN_DIST;
-    m_context.updateViewMatrix();
-    m_gameLogic.updateUIDebugVariables();
-  }
-  if (midiMask.test(PLAYER_SPEED_CONTROL))
-  {
-    m_context.playerSpeed
-      = static_cast<float>(midiState[PLAYER_SPEED_CONTROL] * 2);
-    m_gameLogic.updateUIDebugVariables();
-  }
-  if (midiMask.test(PLAYER_FRICTION_CONTROL))
-  {
-    m_context.playerFriction
-      = static_cast<float>(midiState[PLAYER_FRICTION_CONTROL] * 2);
-    m_gameLogic.updateUIDebugVariables();
-  }
-  if (midiMask.test(PLAYER_MAX_VELOCITY_CONTROL))
-  {
-    m_context.playerMaxVelocity
-      = static_cast<float>(midiState[PLAYER_MAX_VELOCITY_CONTROL] * 2);
-    m_gameLogic.updateUIDebugVariables();
-  }
-  if (midiMask.test(PLAYER_MIN_VELOCITY_CONTROL))
-  {
-    m_context.playerMinVelocity
-      = static_cast<float>(midiState[PLAYER_MIN_VELOCITY_CONTROL]) / 10.f;
-    m_gameLogic.updateUIDebugVariables();
+  for (size_t id = 0; id < midi::MAX_CONTROLLERS; ++id)
+  {
+    if (!midiMask.test(id))
+    {
+      continue;
+    }
+    recorder.recordMidiChange(id, midiState[id]);
+
+    if (id == CAMERA_DIST_CONTROL)
+    {
+      m_context.cameraDistance
+        = static_cast<float>(midiState[id]) + CAMERA_MIN_DIST;
+      m_context.updateViewMatrix();
+      m_gameLogic.updateUIDebugVariables();
+    }
+    else if (m_gameLogic.m_sim.applyMidiControl(id, midiState[id]))
+    {
+      m_gameLogic.updateUIDebugVariables();
+    }
   }
   m_resources.midiTracker.flush();
 
@@ -118,43 +124,8 @@ GamePlayState::handleInput(const DX::StepTimer& timer)
     m_context.updateViewMatrix();
   }
 
-  // Player Movement
-
-  // NB. Must be reset, even while dead.
-  m_context.playerAccel = DirectX::SimpleMath::Vector3();
-  if (m_context.playerState == PlayerState::Dying)
-  {
-    return;
-  }
-
-  if (kbState.Up)
-  {
-    m_context.playerAccel.y = 1.0f;
-  }
-  else if (kbState.Down)
-  {
-    m_context.playerAccel.y = -1.0f;
-  }
-
-  if (kbState.Left)
-  {
-    m_context.playerAccel.x = -1.0f;
-  }
-  else if (kbState.Right)
-  {
-    m_context.playerAccel.x = 1.0f;
-  }
-
-  if (m_context.playerAccel.x != 0.0f && m_context.playerAccel.y != 0.0f)
-  {
-    m_context.playerAccel *= UNIT_DIAGONAL_LENGTH;
-  }
-
-  if (
-    kb.IsKeyPressed(Keyboard::LeftControl) || kb.IsKeyPressed(Keyboard::Space))
-  {
-    m_gameLogic.m_enemies.emitPlayerShot();
-  }
+  // Player movement
+  m_gameLogic.m_sim.applyInput(input);
 }
 
 //------------------------------------------------------------------------------
@@ -162,9 +133,16 @@ void
 GamePlayState::update(const DX::StepTimer& timer)
 {
   TRACE
-  m_resources.starField->update(timer);
-  m_resources.explosions->update(timer);
-  if (GameLogic::GameStatus::GameOver == m_gameLogic.update(timer))
+  auto& jobs = m_resources.jobs;
+
+  // The star field and explosions don't depend on the gameplay, so they run
+  // alongside it. Kills emit explosions, so collision waits for those.
+  m_resources.starField->scheduleUpdate(timer, jobs);
+  auto* explosions = m_resources.explosions->scheduleUpdate(timer, jobs);
+  const auto status = m_gameLogic.update(timer, {explosions});
+  jobs.waitAll();
+
+  if (GameLogic::GameStatus::GameOver == status)
   {
     m_states.changeState(&m_states.gameOver);
   }
@@ -192,6 +170,30 @@ GamePlayState::renderStarField()
   spriteBatch->End();
 }
 
+//------------------------------------------------------------------------------
+void
+GamePlayState::startRecording()
+{
+  TRACE
+  auto& starField = m_resources.starField->sim();
+
+  sim::InputRecording::Setup setup;
+  setup.gameSeed        = m_resources.randDevice();
+  setup.explosionSeed   = m_resources.randDevice();
+  setup.starFieldSeed   = m_resources.randDevice();
+  setup.stepSeconds     = m_resources.m_timer.GetElapsedSeconds();
+  setup.starFieldBounds = starField.bounds();
+
+  // Restart everything the recording depends on from a known state
+  m_resources.randEngine.seed(setup.gameSeed);
+  m_resources.explosions->sim().random().seed(setup.explosionSeed);
+  starField.reset(setup.starFieldSeed);
+  m_gameLogic.resetSimClock();
+
+  m_resources.inputRecorder.start(setup);
+  LOG_INFO("Input recording started");
+}
+
 //------------------------------------------------------------------------------
 void
 GamePlayState::load()
@@ -220,6 +222,13 @@ GamePlayState::enter()
   TRACE
   if (m_states.previousState() != &m_states.paused)
   {
+    auto& recorder = m_resources.inputRecorder;
+    if (recorder.isArmed())
+    {
+      startRecording();
+    }
+    recorder.recordNewGame();
+
     m_gameLogic.reset();
   }
 }
@@ -28,6 +28,7 @@ public:
 
 private:
   void renderStarField();
+  void startRecording();
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,214 @@
+//------------------------------------------------------------------------------
+// Collision broadphase benchmark
+//
+// Moves a field of "shots" and "enemies" around the play area and tests every
+// shot against the enemies, once by brute force and once through the
+// CollisionGrid. Reports the sphere pairs tested and the time per frame of
+// each, and checks both find the same hits.
+//
+// usage: collision_benchmark [numFrames]
+//------------------------------------------------------------------------------
+#include "Simulation/CollisionGrid.h"
+#include "Simulation/GameSim.h"
+#include "Simulation/SimRandom.h"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//------------------------------------------------------------------------------
+constexpr uint64_t DEFAULT_NUM_FRAMES = 100;
+constexpr size_t ENTITY_COUNTS[]      = {100, 1000, 10000};
+constexpr float SHOT_RADIUS           = 0.2598f;
+constexpr float ENEMY_RADIUS          = 2.0784f;
+constexpr float MAX_SPEED             = 30.0f;
+constexpr float FRAME_TIME_S          = 1.0f / 60.0f;
+
+//------------------------------------------------------------------------------
+struct Bodies
+{
+  std::vector<float> x, y, velX, velY, radius;
+
+  void add(sim::Random& random, float r)
+  {
+    const sim::Vec3& max = GameSim::SHOT_MAX_POSITION;
+    x.push_back(random.uniformFloat(-max.x, max.x));
+    y.push_back(random.uniformFloat(-max.y, max.y));
+    velX.push_back(random.uniformFloat(-MAX_SPEED, MAX_SPEED));
+    velY.push_back(random.uniformFloat(-MAX_SPEED, MAX_SPEED));
+    radius.push_back(r);
+  }
+
+  // Bounce off the edges of the play area
+  void move(float dt)
+  {
+    const sim::Vec3& max = GameSim::SHOT_MAX_POSITION;
+    for (size_t i = 0; i < x.size(); ++i)
+    {
+      x[i] += velX[i] * dt;
+      y[i] += velY[i] * dt;
+      if (x[i] < -max.x || x[i] > max.x)
+      {
+        velX[i] = -velX[i];
+      }
+      if (y[i] < -max.y || y[i] > max.y)
+      {
+        velY[i] = -velY[i];
+      }
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+static bool
+overlaps(const Bodies& a, size_t i, const Bodies& b, size_t j)
+{
+  const float dx = a.x[i] - b.x[j];
+  const float dy = a.y[i] - b.y[j];
+  return std::sqrt(dx * dx + dy * dy) <= (a.radius[i] + b.radius[j]);
+}
+
+//------------------------------------------------------------------------------
+struct Result
+{
+  uint64_t pairs = 0;
+  uint64_t hits  = 0;
+  double seconds = 0.0;
+};
+
+//------------------------------------------------------------------------------
+template <typename Func>
+static Result
+run(size_t numEntities, uint64_t numFrames, Func testFrame)
+{
+  sim::Random random(1);
+  Bodies shots, enemies;
+  const size_t numShots = numEntities / 10;
+  for (size_t i = 0; i < numShots; ++i)
+  {
+    shots.add(random, SHOT_RADIUS);
+  }
+  for (size_t i = numShots; i < numEntities; ++i)
+  {
+    enemies.add(random, ENEMY_RADIUS);
+  }
+
+  Result result;
+  for (uint64_t frame = 0; frame < numFrames; ++frame)
+  {
+    shots.move(FRAME_TIME_S);
+    enemies.move(FRAME_TIME_S);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    testFrame(shots, enemies, result);
+    const auto endTime = std::chrono::steady_clock::now();
+    result.seconds
+      += std::chrono::duration<double>(endTime - startTime).count();
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+static Result
+runBruteForce(size_t numEntities, uint64_t numFrames)
+{
+  return run(
+    numEntities,
+    numFrames,
+    [](const Bodies& shots, const Bodies& enemies, Result& result) {
+      for (size_t i = 0; i < shots.x.size(); ++i)
+      {
+        for (size_t j = 0; j < enemies.x.size(); ++j)
+        {
+          result.pairs++;
+          result.hits += overlaps(shots, i, enemies, j);
+        }
+      }
+    });
+}
+
+//------------------------------------------------------------------------------
+static Result
+runGrid(size_t numEntities, uint64_t numFrames)
+{
+  const sim::Vec3& max = GameSim::SHOT_MAX_POSITION;
+  CollisionGrid grid(
+    -max.x,
+    -max.y,
+    max.x,
+    max.y,
+    GameSim::COLLISION_CELL_SIZE,
+    0,
+    numEntities);
+
+  return run(
+    numEntities,
+    numFrames,
+    [&grid](const Bodies& shots, const Bodies& enemies, Result& result) {
+      for (size_t j = 0; j < enemies.x.size(); ++j)
+      {
+        grid.update(j, enemies.x[j], enemies.y[j], enemies.radius[j]);
+      }
+      for (size_t i = 0; i < shots.x.size(); ++i)
+      {
+        grid.query(shots.x[i], shots.y[i], shots.radius[i], [&](size_t j) {
+          result.pairs++;
+          result.hits += overlaps(shots, i, enemies, j);
+        });
+      }
+    });
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  const uint64_t numFrames
+    = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_NUM_FRAMES;
+
+  std::printf(
+    "%8s %14s %14s %12s %12s %8s\n",
+    "entities",
+    "brute pairs",
+    "grid pairs",
+    "brute ms",
+    "grid ms",
+    "speedup");
+
+  bool hitsMatch = true;
+  for (size_t numEntities : ENTITY_COUNTS)
+  {
+    const Result brute = runBruteForce(numEntities, numFrames);
+    const Result grid  = runGrid(numEntities, numFrames);
+    hitsMatch          = hitsMatch && (brute.hits == grid.hits);
+
+    const double bruteMs = 1000.0 * brute.seconds / numFrames;
+    const double gridMs  = 1000.0 * grid.seconds / numFrames;
+    std::printf(
+      "%8zu %14llu %14llu %12.4f %12.4f %7.1fx\n",
+      numEntities,
+      static_cast<unsigned long long>(brute.pairs / numFrames),
+      static_cast<unsigned long long>(grid.pairs / numFrames),
+      bruteMs,
+      gridMs,
+      (gridMs > 0.0) ? bruteMs / gridMs : 0.0);
+  }
+  std::printf(
+    "(pairs and ms are per frame over %llu frames)\n",
+    static_cast<unsigned long long>(numFrames));
+
+  if (!hitsMatch)
+  {
+    LOG_ERROR("Grid and brute force found different hits");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
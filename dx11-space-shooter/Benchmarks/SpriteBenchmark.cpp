@@ -0,0 +1,504 @@
+//------------------------------------------------------------------------------
+// Sprite vertex generation benchmark
+//
+// Generates the vertices for a field of sprites two ways: once through a CPU
+// copy of SpriteBatch's per-sprite path (Draw packs a SpriteInfo into the
+// queue, End walks the sorted pointers and RenderSprite builds each quad), and
+// once through the bulk DrawQuads path (WriteSpriteQuadVertices straight from
+// the arrays). Both write into a vertex buffer sized like SpriteBatch's.
+// Reports the time per frame and vertices per second of each, and checks both
+// produce the same vertices. Nothing is sent to a GPU.
+//
+// usage: sprite_benchmark [numFrames]
+//------------------------------------------------------------------------------
+#include "SpriteQuads.h"
+
+#include "Simulation/SimRandom.h"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#if defined(DIRECTX_SPRITE_QUADS_SSE2)
+#include <emmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+constexpr uint64_t DEFAULT_NUM_FRAMES = 200;
+constexpr size_t SPRITE_COUNTS[]      = {1000, 4000, 16000};
+constexpr float SCREEN_WIDTH          = 1920.0f;
+constexpr float SCREEN_HEIGHT         = 1080.0f;
+constexpr float TEXTURE_SIZE          = 32.0f;
+
+// SpriteBatch's vertex buffer holds this many sprites
+constexpr size_t MAX_BATCH_SIZE = 2048;
+constexpr size_t MIN_BATCH_SIZE = 128;
+
+//------------------------------------------------------------------------------
+struct Sprites
+{
+  std::vector<float> x, y, scale, r, g, b, a;
+
+  explicit Sprites(size_t count)
+  {
+    sim::Random random(1);
+    for (size_t i = 0; i < count; ++i)
+    {
+      x.push_back(random.uniformFloat(0.0f, SCREEN_WIDTH));
+      y.push_back(random.uniformFloat(0.0f, SCREEN_HEIGHT));
+      scale.push_back(random.uniformFloat(0.2f, 2.0f));
+      r.push_back(random.uniformFloat(0.0f, 1.0f));
+      g.push_back(random.uniformFloat(0.0f, 1.0f));
+      b.push_back(random.uniformFloat(0.0f, 1.0f));
+      a.push_back(random.uniformFloat(0.0f, 1.0f));
+    }
+  }
+
+  DirectX::SpriteQuads quads() const
+  {
+    DirectX::SpriteQuads q;
+    q.x     = x.data();
+    q.y     = y.data();
+    q.scale = scale.data();
+    q.r     = r.data();
+    q.g     = g.data();
+    q.b     = b.data();
+    q.a     = a.data();
+    q.count = x.size();
+    return q;
+  }
+};
+
+//------------------------------------------------------------------------------
+// Stand-in for the mapped D3D vertex buffer, with SpriteBatch's wrapping.
+// Every vertex written is also kept when validating.
+struct VertexBuffer
+{
+  std::vector<float> data
+    = std::vector<float>(MAX_BATCH_SIZE * DirectX::SpriteQuadFloats);
+  size_t position = 0;
+
+  std::vector<float>* capture = nullptr;
+
+  // Returns the space for up to count sprites and how many fit
+  float* map(size_t count, size_t& batchSize)
+  {
+    batchSize                   = count;
+    const size_t remainingSpace = MAX_BATCH_SIZE - position;
+    if (batchSize > remainingSpace)
+    {
+      if (remainingSpace < MIN_BATCH_SIZE)
+      {
+        position  = 0;
+        batchSize = std::min(count, MAX_BATCH_SIZE);
+      }
+      else
+      {
+        batchSize = remainingSpace;
+      }
+    }
+    return data.data() + position * DirectX::SpriteQuadFloats;
+  }
+
+  void unmap(size_t batchSize)
+  {
+    if (capture)
+    {
+      const float* begin = data.data() + position * DirectX::SpriteQuadFloats;
+      capture->insert(
+        capture->end(),
+        begin,
+        begin + batchSize * DirectX::SpriteQuadFloats);
+    }
+    position += batchSize;
+  }
+};
+
+#if defined(DIRECTX_SPRITE_QUADS_SSE2)
+//------------------------------------------------------------------------------
+// SpriteBatch's per-sprite path, with the DirectXMath calls spelled out as
+// the SSE they compile to.
+//------------------------------------------------------------------------------
+class PerSpriteBatch
+{
+public:
+  //----------------------------------------------------------------------------
+  // SpriteBatch::Draw(texture, position, nullptr, color, rotation, origin,
+  // scale, effects, layerDepth) and Impl::Draw
+  void draw(
+    const void* texture,
+    __m128 position,
+    __m128 color,
+    float rotation,
+    __m128 origin,
+    __m128 scale,
+    float layerDepth)
+  {
+    const __m128 destination = _mm_movelh_ps(position, scale);
+    const __m128 rotationDepth
+      = _mm_unpacklo_ps(_mm_set1_ps(rotation), _mm_set1_ps(layerDepth));
+    const __m128 originRotationDepth = _mm_movelh_ps(origin, rotationDepth);
+
+    if (m_queueCount >= m_queueSize)
+    {
+      growQueue();
+    }
+    SpriteInfo* sprite = &m_queue[m_queueCount];
+
+    _mm_store_ps(sprite->source, _mm_setr_ps(0.0f, 0.0f, 1.0f, 1.0f));
+    _mm_store_ps(sprite->destination, destination);
+    _mm_store_ps(sprite->color, color);
+    _mm_store_ps(sprite->originRotationDepth, originRotationDepth);
+    sprite->texture = texture;
+    sprite->flags   = 0;
+
+    m_queueCount++;
+    if (m_textureReferences.empty() || texture != m_textureReferences.back())
+    {
+      m_textureReferences.push_back(texture);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Impl::End with SpriteSortMode_Deferred: FlushBatch and RenderBatch
+  void end(VertexBuffer& buffer, __m128 textureSize)
+  {
+    if (m_sorted.size() < m_queueCount)
+    {
+      const size_t previousSize = m_sorted.size();
+      m_sorted.resize(m_queueCount);
+      for (size_t i = previousSize; i < m_queueCount; ++i)
+      {
+        m_sorted[i] = &m_queue[i];
+      }
+    }
+
+    const void* batchTexture = nullptr;
+    size_t batchStart        = 0;
+    for (size_t pos = 0; pos < m_queueCount; ++pos)
+    {
+      if (m_sorted[pos]->texture != batchTexture)
+      {
+        if (pos > batchStart)
+        {
+          renderBatch(buffer, textureSize, batchStart, pos - batchStart);
+        }
+        batchTexture = m_sorted[pos]->texture;
+        batchStart   = pos;
+      }
+    }
+    renderBatch(buffer, textureSize, batchStart, m_queueCount - batchStart);
+
+    m_queueCount = 0;
+    m_textureReferences.clear();
+  }
+
+private:
+  struct alignas(16) SpriteInfo
+  {
+    float source[4];
+    float destination[4];
+    float color[4];
+    float originRotationDepth[4];
+    const void* texture;
+    int flags;
+  };
+
+  //----------------------------------------------------------------------------
+  void growQueue()
+  {
+    const size_t newSize = std::max<size_t>(64, m_queueSize * 2);
+    std::unique_ptr<SpriteInfo[]> newQueue(new SpriteInfo[newSize]);
+    std::copy(m_queue.get(), m_queue.get() + m_queueCount, newQueue.get());
+    m_queue     = std::move(newQueue);
+    m_queueSize = newSize;
+    m_sorted.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  void renderBatch(
+    VertexBuffer& buffer, __m128 textureSize, size_t start, size_t count)
+  {
+    const __m128 inverseTextureSize
+      = _mm_div_ps(_mm_set1_ps(1.0f), textureSize);
+    while (count > 0)
+    {
+      size_t batchSize = 0;
+      float* vertices  = buffer.map(count, batchSize);
+      for (size_t i = 0; i < batchSize; ++i)
+      {
+        renderSprite(
+          m_sorted[start + i], vertices, textureSize, inverseTextureSize);
+        vertices += DirectX::SpriteQuadFloats;
+      }
+      buffer.unmap(batchSize);
+
+      start += batchSize;
+      count -= batchSize;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Impl::RenderSprite
+  static void renderSprite(
+    const SpriteInfo* sprite,
+    float* vertices,
+    __m128 textureSize,
+    __m128 inverseTextureSize)
+  {
+    __m128 source                    = _mm_load_ps(sprite->source);
+    const __m128 destination         = _mm_load_ps(sprite->destination);
+    const __m128 color               = _mm_load_ps(sprite->color);
+    const __m128 originRotationDepth = _mm_load_ps(sprite->originRotationDepth);
+
+    const float rotation = sprite->originRotationDepth[2];
+    const int flags      = sprite->flags;
+
+    __m128 sourceSize = _mm_shuffle_ps(source, source, _MM_SHUFFLE(3, 2, 3, 2));
+    __m128 destinationSize
+      = _mm_shuffle_ps(destination, destination, _MM_SHUFFLE(3, 2, 3, 2));
+
+    const __m128 isZeroMask = _mm_cmpeq_ps(sourceSize, _mm_setzero_ps());
+    const __m128 nonZeroSourceSize = _mm_or_ps(
+      _mm_andnot_ps(isZeroMask, sourceSize),
+      _mm_and_ps(isZeroMask, _mm_set1_ps(1.192092896e-7f)));
+
+    __m128 origin = _mm_div_ps(originRotationDepth, nonZeroSourceSize);
+
+    constexpr int SOURCE_IN_TEXELS    = 4;
+    constexpr int DEST_SIZE_IN_PIXELS = 8;
+    if (flags & SOURCE_IN_TEXELS)
+    {
+      source     = _mm_mul_ps(source, inverseTextureSize);
+      sourceSize = _mm_mul_ps(sourceSize, inverseTextureSize);
+    }
+    else
+    {
+      origin = _mm_mul_ps(origin, inverseTextureSize);
+    }
+    if (!(flags & DEST_SIZE_IN_PIXELS))
+    {
+      destinationSize = _mm_mul_ps(destinationSize, textureSize);
+    }
+
+    __m128 rotationMatrix1 = _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    __m128 rotationMatrix2 = _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f);
+    if (rotation != 0)
+    {
+      const float sin = std::sin(rotation);
+      const float cos = std::cos(rotation);
+      rotationMatrix1 = _mm_setr_ps(cos, sin, 0.0f, 0.0f);
+      rotationMatrix2 = _mm_setr_ps(-sin, cos, 0.0f, 0.0f);
+    }
+
+    static const __m128 cornerOffsets[DirectX::SpriteQuadVertices] = {
+      _mm_setr_ps(0.0f, 0.0f, 0.0f, 0.0f),
+      _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f),
+      _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f),
+      _mm_setr_ps(1.0f, 1.0f, 0.0f, 0.0f),
+    };
+
+    const int mirrorBits = flags & 3;
+    for (size_t i = 0; i < DirectX::SpriteQuadVertices; ++i)
+    {
+      float* vertex = vertices + i * DirectX::SpriteQuadVertexFloats;
+
+      const __m128 cornerOffset
+        = _mm_mul_ps(_mm_sub_ps(cornerOffsets[i], origin), destinationSize);
+
+      const __m128 position1 = _mm_add_ps(
+        _mm_mul_ps(
+          _mm_shuffle_ps(cornerOffset, cornerOffset, _MM_SHUFFLE(0, 0, 0, 0)),
+          rotationMatrix1),
+        destination);
+      const __m128 position2 = _mm_add_ps(
+        _mm_mul_ps(
+          _mm_shuffle_ps(cornerOffset, cornerOffset, _MM_SHUFFLE(1, 1, 1, 1)),
+          rotationMatrix2),
+        position1);
+
+      // x, y, depth, rotation: the rotation lands in color.r and is
+      // overwritten straight away
+      const __m128 position = _mm_shuffle_ps(
+        position2, originRotationDepth, _MM_SHUFFLE(2, 3, 1, 0));
+      _mm_storeu_ps(vertex, position);
+      _mm_storeu_ps(vertex + 3, color);
+
+      const __m128 textureCoordinate = _mm_add_ps(
+        _mm_mul_ps(cornerOffsets[i ^ mirrorBits], sourceSize), source);
+      _mm_storel_pi(reinterpret_cast<__m64*>(vertex + 7), textureCoordinate);
+    }
+  }
+
+  std::unique_ptr<SpriteInfo[]> m_queue;
+  size_t m_queueCount = 0;
+  size_t m_queueSize  = 0;
+  std::vector<const SpriteInfo*> m_sorted;
+  std::vector<const void*> m_textureReferences;
+};
+
+//------------------------------------------------------------------------------
+struct Result
+{
+  double seconds = 0.0;
+  std::vector<float> vertices;    // From the first frame
+};
+
+//------------------------------------------------------------------------------
+template <typename Func>
+static Result
+run(uint64_t numFrames, Func renderFrame)
+{
+  VertexBuffer buffer;
+  Result result;
+  for (uint64_t frame = 0; frame < numFrames; ++frame)
+  {
+    buffer.capture = (frame == 0) ? &result.vertices : nullptr;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    renderFrame(buffer);
+    const auto endTime = std::chrono::steady_clock::now();
+    result.seconds
+      += std::chrono::duration<double>(endTime - startTime).count();
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+static Result
+runPerSprite(const Sprites& sprites, uint64_t numFrames)
+{
+  static const int texture = 0;
+  PerSpriteBatch batch;
+  const __m128 textureSize = _mm_set1_ps(TEXTURE_SIZE);
+  const __m128 origin
+    = _mm_setr_ps(TEXTURE_SIZE / 2.0f, TEXTURE_SIZE / 2.0f, 0.0f, 0.0f);
+
+  return run(numFrames, [&](VertexBuffer& buffer) {
+    for (size_t i = 0; i < sprites.x.size(); ++i)
+    {
+      batch.draw(
+        &texture,
+        _mm_setr_ps(sprites.x[i], sprites.y[i], 0.0f, 0.0f),
+        _mm_setr_ps(sprites.r[i], sprites.g[i], sprites.b[i], sprites.a[i]),
+        0.0f,
+        origin,
+        _mm_set1_ps(sprites.scale[i]),
+        0.0f);
+    }
+    batch.end(buffer, textureSize);
+  });
+}
+
+//------------------------------------------------------------------------------
+static Result
+runBulk(const Sprites& sprites, uint64_t numFrames)
+{
+  DirectX::SpriteQuadParams params;
+  params.textureWidth  = TEXTURE_SIZE;
+  params.textureHeight = TEXTURE_SIZE;
+  params.originX       = TEXTURE_SIZE / 2.0f;
+  params.originY       = TEXTURE_SIZE / 2.0f;
+
+  const DirectX::SpriteQuads quads = sprites.quads();
+  return run(numFrames, [&](VertexBuffer& buffer) {
+    size_t begin = 0;
+    size_t count = quads.count;
+    while (count > 0)
+    {
+      size_t batchSize = 0;
+      float* vertices  = buffer.map(count, batchSize);
+      DirectX::WriteSpriteQuadVertices(
+        quads, params, begin, batchSize, vertices);
+      buffer.unmap(batchSize);
+
+      begin += batchSize;
+      count -= batchSize;
+    }
+  });
+}
+
+//------------------------------------------------------------------------------
+// Positions are computed in a different order, so allow for rounding
+static bool
+sameVertices(const std::vector<float>& a, const std::vector<float>& b)
+{
+  if (a.size() != b.size())
+  {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    if (std::fabs(a[i] - b[i]) > 1e-3f * std::max(1.0f, std::fabs(a[i])))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+#if defined(DIRECTX_SPRITE_QUADS_SSE2)
+  const uint64_t numFrames
+    = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_NUM_FRAMES;
+
+  std::printf(
+    "%8s %12s %12s %14s %14s %8s\n",
+    "sprites",
+    "draw ms",
+    "bulk ms",
+    "draw Mverts/s",
+    "bulk Mverts/s",
+    "speedup");
+
+  bool verticesMatch = true;
+  for (size_t numSprites : SPRITE_COUNTS)
+  {
+    const Sprites sprites(numSprites);
+    const Result perSprite = runPerSprite(sprites, numFrames);
+    const Result bulk      = runBulk(sprites, numFrames);
+    verticesMatch
+      = verticesMatch && sameVertices(perSprite.vertices, bulk.vertices);
+
+    const double numVertices = static_cast<double>(
+      numSprites * DirectX::SpriteQuadVertices * numFrames);
+    std::printf(
+      "%8zu %12.4f %12.4f %14.1f %14.1f %7.1fx\n",
+      numSprites,
+      1000.0 * perSprite.seconds / numFrames,
+      1000.0 * bulk.seconds / numFrames,
+      numVertices / perSprite.seconds / 1e6,
+      numVertices / bulk.seconds / 1e6,
+      (bulk.seconds > 0.0) ? perSprite.seconds / bulk.seconds : 0.0);
+  }
+  std::printf(
+    "(ms are per frame over %llu frames)\n",
+    static_cast<unsigned long long>(numFrames));
+
+  if (!verticesMatch)
+  {
+    LOG_ERROR("Per-sprite and bulk paths generated different vertices");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+#else
+  (void)argc;
+  (void)argv;
+  LOG_ERROR("The per-sprite comparison needs SSE2");
+  return EXIT_FAILURE;
+#endif
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+// Sprite font layout benchmark
+//
+// Measures and lays out a frame's worth of UI labels, like the HUD, profiler
+// list and menus do with SpriteFont each frame, two ways: once the old way
+// (a binary search per character and the layout redone on every
+// MeasureString/DrawString), and once with the glyph table and layout cache
+// SpriteFont now uses. Most labels stay the same from frame to frame and a
+// few change. Reports the time per frame of each, and checks both give the
+// same extents and glyph positions.
+//
+// usage: sprite_font_benchmark [numFrames]
+//------------------------------------------------------------------------------
+#include "SpriteFontLayout.h"
+
+#include "Simulation/SimRandom.h"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+constexpr uint64_t DEFAULT_NUM_FRAMES = 2000;
+constexpr size_t NUM_STATIC_LABELS    = 60;
+constexpr size_t NUM_CHANGING_LABELS  = 10;
+constexpr size_t LABEL_LENGTH         = 32;
+constexpr float LINE_SPACING          = 52.0f;
+
+//------------------------------------------------------------------------------
+// The layout of DirectX::SpriteFont::Glyph
+struct Glyph
+{
+  uint32_t Character;
+  struct
+  {
+    int32_t left, top, right, bottom;
+  } Subrect;
+  float XOffset;
+  float YOffset;
+  float XAdvance;
+};
+
+using Layout = DirectX::SpriteFontLayout::Layout<Glyph>;
+
+//------------------------------------------------------------------------------
+// Printable ASCII, as MakeSpriteFont writes by default
+static std::vector<Glyph>
+makeFont()
+{
+  sim::Random random(1);
+  std::vector<Glyph> glyphs;
+  for (uint32_t c = 32; c < 127; ++c)
+  {
+    Glyph g;
+    g.Character      = c;
+    g.Subrect.left   = static_cast<int32_t>(random.uniformIndex(200));
+    g.Subrect.top    = static_cast<int32_t>(random.uniformIndex(200));
+    g.Subrect.right  = g.Subrect.left + 1 + int32_t(random.uniformIndex(30));
+    g.Subrect.bottom = g.Subrect.top + 1 + int32_t(random.uniformIndex(40));
+    g.XOffset        = random.uniformFloat(-1.0f, 2.0f);
+    g.YOffset        = random.uniformFloat(0.0f, 12.0f);
+    g.XAdvance       = random.uniformFloat(-1.0f, 1.0f);
+    glyphs.push_back(g);
+  }
+  return glyphs;
+}
+
+//------------------------------------------------------------------------------
+static std::vector<std::wstring>
+makeStaticLabels()
+{
+  sim::Random random(2);
+  std::vector<std::wstring> labels;
+  for (size_t i = 0; i < NUM_STATIC_LABELS; ++i)
+  {
+    std::wstring label;
+    for (size_t c = 0; c < LABEL_LENGTH; ++c)
+    {
+      label += static_cast<wchar_t>(32 + random.uniformIndex(95));
+    }
+    labels.push_back(label);
+  }
+  return labels;
+}
+
+//------------------------------------------------------------------------------
+// SpriteFont::Impl::FindGlyph and ForEachGlyph before the glyph table, doing
+// what MeasureString then gathered
+static void
+layOutBySearch(
+  const std::vector<Glyph>& glyphs, const wchar_t* text, Layout& layout)
+{
+  auto findGlyph = [&](wchar_t character) {
+    auto glyph = std::lower_bound(
+      glyphs.begin(), glyphs.end(), character, [](const Glyph& g, wchar_t c) {
+        return g.Character < static_cast<uint32_t>(c);
+      });
+    return &*glyph;
+  };
+  DirectX::SpriteFontLayout::LayOut(text, findGlyph, LINE_SPACING, layout);
+}
+
+//------------------------------------------------------------------------------
+// What DrawString does per glyph, short of handing it to SpriteBatch
+static float
+drawLayout(const Layout& layout)
+{
+  float sum = 0.0f;
+  for (const auto& placed : layout.glyphs)
+  {
+    sum += placed.x + placed.y + placed.glyph->YOffset;
+  }
+  return sum;
+}
+
+//------------------------------------------------------------------------------
+static bool
+sameLayout(const Layout& a, const Layout& b)
+{
+  if (a.width != b.width || a.height != b.height
+      || a.glyphs.size() != b.glyphs.size())
+  {
+    return false;
+  }
+  for (size_t i = 0; i < a.glyphs.size(); ++i)
+  {
+    if (a.glyphs[i].glyph != b.glyphs[i].glyph
+        || a.glyphs[i].x != b.glyphs[i].x || a.glyphs[i].y != b.glyphs[i].y)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  const uint64_t numFrames
+    = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_NUM_FRAMES;
+
+  const std::vector<Glyph> glyphs        = makeFont();
+  const std::vector<std::wstring> labels = makeStaticLabels();
+
+  DirectX::SpriteFontLayout::GlyphTable<Glyph> table;
+  table.Build(glyphs.data(), glyphs.size());
+  DirectX::SpriteFontLayout::LayoutCache<Glyph> cache;
+  auto layOutByTable = [&](const wchar_t* text, Layout& layout) {
+    DirectX::SpriteFontLayout::LayOut(
+      text,
+      [&](wchar_t c) { return table.Find(c); },
+      LINE_SPACING,
+      layout);
+  };
+
+  // Each label is measured (to centre it) and then drawn
+  Layout searched;
+  wchar_t changing[LABEL_LENGTH];
+  bool layoutsMatch = true;
+  float searchSum   = 0.0f;
+  float cacheSum    = 0.0f;
+  double searchS    = 0.0;
+  double cacheS     = 0.0;
+  for (uint64_t frame = 0; frame < numFrames; ++frame)
+  {
+    auto startTime = std::chrono::steady_clock::now();
+    for (const auto& label : labels)
+    {
+      layOutBySearch(glyphs, label.c_str(), searched);
+      searchSum += searched.width;
+      layOutBySearch(glyphs, label.c_str(), searched);
+      searchSum += drawLayout(searched);
+    }
+    for (size_t i = 0; i < NUM_CHANGING_LABELS; ++i)
+    {
+      std::swprintf(
+        changing, LABEL_LENGTH, L"Score: %llu", (unsigned long long)frame + i);
+      layOutBySearch(glyphs, changing, searched);
+      searchSum += searched.width;
+      layOutBySearch(glyphs, changing, searched);
+      searchSum += drawLayout(searched);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    searchS += std::chrono::duration<double>(endTime - startTime).count();
+
+    startTime = std::chrono::steady_clock::now();
+    for (const auto& label : labels)
+    {
+      cacheSum += cache.Get(label.c_str(), layOutByTable).width;
+      cacheSum += drawLayout(cache.Get(label.c_str(), layOutByTable));
+    }
+    for (size_t i = 0; i < NUM_CHANGING_LABELS; ++i)
+    {
+      std::swprintf(
+        changing, LABEL_LENGTH, L"Score: %llu", (unsigned long long)frame + i);
+      cacheSum += cache.Get(changing, layOutByTable).width;
+      cacheSum += drawLayout(cache.Get(changing, layOutByTable));
+    }
+    endTime = std::chrono::steady_clock::now();
+    cacheS += std::chrono::duration<double>(endTime - startTime).count();
+
+    if (frame == 0 || frame + 1 == numFrames)
+    {
+      for (const auto& label : labels)
+      {
+        layOutBySearch(glyphs, label.c_str(), searched);
+        const Layout& cached = cache.Get(label.c_str(), layOutByTable);
+        layoutsMatch         = layoutsMatch && sameLayout(searched, cached);
+      }
+    }
+  }
+
+  const size_t labelsPerFrame = NUM_STATIC_LABELS + NUM_CHANGING_LABELS;
+  const double searchUs       = 1e6 * searchS / numFrames;
+  const double cacheUs        = 1e6 * cacheS / numFrames;
+  std::printf("%20s %12s %12s %8s\n", "", "search us", "cached us", "speedup");
+  std::printf(
+    "%20s %12.2f %12.2f %7.1fx\n",
+    "labels per frame",
+    searchUs,
+    cacheUs,
+    (cacheUs > 0.0) ? searchUs / cacheUs : 0.0);
+  std::printf(
+    "(us are per frame over %llu frames: %zu labels of %zu characters, %zu of "
+    "them changing each frame, each measured and drawn)\n",
+    static_cast<unsigned long long>(numFrames),
+    labelsPerFrame,
+    LABEL_LENGTH,
+    NUM_CHANGING_LABELS);
+
+  if (!layoutsMatch || searchSum != cacheSum)
+  {
+    LOG_ERROR("Cached layouts differ from laying out each time");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,252 @@
+//------------------------------------------------------------------------------
+// Sprite sort benchmark
+//
+// Orders a queue of sprites for each of SpriteBatch's sorted modes, once the
+// old way (std::sort over sprite pointers, comparing through them) and once
+// with the packed keys and radix sort SpriteBatch now uses. Reports the time
+// per sort of each, and checks both give the same order of textures/depths
+// and that the radix sort kept equal sprites in the order they were drawn.
+//
+// usage: sprite_sort_benchmark [numSorts]
+//------------------------------------------------------------------------------
+#include "SpriteSort.h"
+
+#include "Simulation/SimRandom.h"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+//------------------------------------------------------------------------------
+constexpr uint64_t DEFAULT_NUM_SORTS = 50;
+constexpr size_t SPRITE_COUNTS[]     = {1000, 10000, 100000};
+constexpr size_t NUM_TEXTURES        = 8;
+constexpr size_t NUM_DEPTH_LEVELS    = 1000;    // So some depths tie
+
+//------------------------------------------------------------------------------
+enum class Mode
+{
+  Texture,
+  BackToFront,
+  FrontToBack
+};
+
+// The fields SpriteBatch's SpriteInfo holds, at the same size
+struct alignas(16) SpriteInfo
+{
+  float source[4];
+  float destination[4];
+  float color[4];
+  float originRotationDepth[4];
+  const void* texture;
+  int flags;
+};
+
+//------------------------------------------------------------------------------
+static std::vector<SpriteInfo>
+makeSprites(size_t count)
+{
+  static const int textures[NUM_TEXTURES] = {};
+
+  sim::Random random(1);
+  std::vector<SpriteInfo> sprites(count);
+  for (auto& s : sprites)
+  {
+    s.texture = &textures[random.uniformIndex(NUM_TEXTURES)];
+    s.originRotationDepth[3]
+      = random.uniformIndex(NUM_DEPTH_LEVELS) / float(NUM_DEPTH_LEVELS);
+  }
+  return sprites;
+}
+
+//------------------------------------------------------------------------------
+// SpriteBatch::Impl::SortSprites before the radix sort
+static void
+sortByComparison(
+  Mode mode, const std::vector<SpriteInfo>& sprites, const SpriteInfo** sorted)
+{
+  for (size_t i = 0; i < sprites.size(); ++i)
+  {
+    sorted[i] = &sprites[i];
+  }
+
+  const SpriteInfo** end = sorted + sprites.size();
+  switch (mode)
+  {
+  case Mode::Texture:
+    std::sort(sorted, end, [](const SpriteInfo* x, const SpriteInfo* y) {
+      return x->texture < y->texture;
+    });
+    break;
+  case Mode::BackToFront:
+    std::sort(sorted, end, [](const SpriteInfo* x, const SpriteInfo* y) {
+      return x->originRotationDepth[3] > y->originRotationDepth[3];
+    });
+    break;
+  case Mode::FrontToBack:
+    std::sort(sorted, end, [](const SpriteInfo* x, const SpriteInfo* y) {
+      return x->originRotationDepth[3] < y->originRotationDepth[3];
+    });
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// SpriteBatch::Impl::SortSprites now
+static void
+sortByKey(
+  Mode mode,
+  const std::vector<SpriteInfo>& sprites,
+  DirectX::SpriteSort::RadixSorter& sorter,
+  const SpriteInfo** sorted)
+{
+  using namespace DirectX::SpriteSort;
+
+  uint64_t* keys = sorter.Keys(sprites.size());
+  for (size_t i = 0; i < sprites.size(); ++i)
+  {
+    const SpriteInfo& s = sprites[i];
+    switch (mode)
+    {
+    case Mode::Texture: keys[i] = TextureKey(s.texture); break;
+    case Mode::BackToFront:
+      keys[i] = DescendingDepthKey(s.originRotationDepth[3]);
+      break;
+    case Mode::FrontToBack:
+      keys[i] = AscendingDepthKey(s.originRotationDepth[3]);
+      break;
+    }
+  }
+
+  const uint32_t* order = sorter.Sort(sprites.size());
+  for (size_t i = 0; i < sprites.size(); ++i)
+  {
+    sorted[i] = &sprites[order[i]];
+  }
+}
+
+//------------------------------------------------------------------------------
+// Same sequence of keys, and equal keys in drawing order
+static bool
+sameOrder(
+  Mode mode,
+  const std::vector<const SpriteInfo*>& expected,
+  const std::vector<const SpriteInfo*>& actual)
+{
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    const bool sameKey
+      = (mode == Mode::Texture)
+          ? expected[i]->texture == actual[i]->texture
+          : expected[i]->originRotationDepth[3]
+              == actual[i]->originRotationDepth[3];
+    if (!sameKey)
+    {
+      return false;
+    }
+
+    if (i > 0)
+    {
+      const bool tie
+        = (mode == Mode::Texture)
+            ? actual[i - 1]->texture == actual[i]->texture
+            : actual[i - 1]->originRotationDepth[3]
+                == actual[i]->originRotationDepth[3];
+      if (tie && actual[i - 1] > actual[i])
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename Func>
+static double
+timeSorts(uint64_t numSorts, Func sort)
+{
+  const auto startTime = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < numSorts; ++i)
+  {
+    sort();
+  }
+  const auto endTime = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  const uint64_t numSorts
+    = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_NUM_SORTS;
+
+  static const struct
+  {
+    Mode mode;
+    const char* name;
+  } MODES[] = {
+    {Mode::Texture, "Texture"},
+    {Mode::BackToFront, "BackToFront"},
+    {Mode::FrontToBack, "FrontToBack"},
+  };
+
+  std::printf(
+    "%12s %8s %12s %12s %8s\n",
+    "mode",
+    "sprites",
+    "std::sort ms",
+    "radix ms",
+    "speedup");
+
+  bool ordersMatch = true;
+  DirectX::SpriteSort::RadixSorter sorter;
+  for (const auto& m : MODES)
+  {
+    for (size_t numSprites : SPRITE_COUNTS)
+    {
+      const std::vector<SpriteInfo> sprites = makeSprites(numSprites);
+      std::vector<const SpriteInfo*> compared(numSprites);
+      std::vector<const SpriteInfo*> keyed(numSprites);
+
+      const double compareS = timeSorts(numSorts, [&] {
+        sortByComparison(m.mode, sprites, compared.data());
+      });
+      const double keyS = timeSorts(numSorts, [&] {
+        sortByKey(m.mode, sprites, sorter, keyed.data());
+      });
+      ordersMatch = ordersMatch && sameOrder(m.mode, compared, keyed);
+
+      const double compareMs = 1000.0 * compareS / numSorts;
+      const double keyMs     = 1000.0 * keyS / numSorts;
+      std::printf(
+        "%12s %8zu %12.4f %12.4f %7.1fx\n",
+        m.name,
+        numSprites,
+        compareMs,
+        keyMs,
+        (keyMs > 0.0) ? compareMs / keyMs : 0.0);
+    }
+  }
+  std::printf(
+    "(ms are per sort over %llu sorts, %zu textures, %zu depth levels)\n",
+    static_cast<unsigned long long>(numSorts),
+    NUM_TEXTURES,
+    NUM_DEPTH_LEVELS);
+
+  if (!ordersMatch)
+  {
+    LOG_ERROR("Radix sorted sprites are in a different order");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,199 @@
+//------------------------------------------------------------------------------
+// UI text formatting benchmark
+//
+// Formats a frame's worth of UI text like the HUD, debug variables and
+// profiler list: once the old way (fmt::format into a new std::wstring, and
+// utf8ToWstring for profiled function names), and once with compiled format
+// strings into strUtils::InlineWString buffers, as ui::FormattedText does.
+// Reports the time and heap allocations per frame of each, checks both give
+// the same text, and fails if the inline path allocates after warm-up.
+//
+// usage: text_format_benchmark [numFrames]
+//------------------------------------------------------------------------------
+#include "Simulation/SimRandom.h"
+#include "utils/InlineString.h"
+
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include "utils/AllocationCounter.h"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+constexpr uint64_t DEFAULT_NUM_FRAMES = 2000;
+constexpr uint64_t WARM_UP_FRAMES     = 1;
+constexpr size_t NUM_PROFILED         = 40;
+
+static const char* const FUNCTION_NAMES[] = {
+  "GameLogic::update",
+  "GameLogic::render",
+  "GameSim::update",
+  "CollisionGrid::build",
+  "Explosions::render",
+  "StarField::render",
+  "SpriteBatch::End",
+  "Game::drawProfilerList",
+};
+
+//------------------------------------------------------------------------------
+struct ProfiledRecord
+{
+  const char* function;
+  float callsAverage;
+  double minMs;
+  double maxMs;
+};
+
+//------------------------------------------------------------------------------
+// The values shown change every frame, as the timings do
+static void
+updateValues(
+  sim::Random& random,
+  int& score,
+  float& speed,
+  std::vector<ProfiledRecord>& records)
+{
+  score += static_cast<int>(random.uniformIndex(3)) * 10;
+  speed = random.uniformFloat(100.0f, 300.0f);
+  for (auto& record : records)
+  {
+    record.callsAverage = static_cast<float>(random.uniformIndex(20));
+    record.minMs        = random.uniformFloat(0.0f, 0.5f);
+    record.maxMs        = record.minMs + random.uniformFloat(0.0f, 2.0f);
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  const uint64_t numFrames
+    = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_NUM_FRAMES;
+
+  sim::Random random(1);
+  std::vector<ProfiledRecord> records(NUM_PROFILED);
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    records[i].function
+      = FUNCTION_NAMES[i % (sizeof(FUNCTION_NAMES) / sizeof(*FUNCTION_NAMES))];
+  }
+  int score   = 0;
+  float speed = 0.0f;
+
+  // Old: a std::wstring per label
+  std::wstring scoreStr, speedStr;
+  std::vector<std::wstring> profilerStrs(NUM_PROFILED);
+
+  // New: inline buffers and compiled format strings
+  static const auto SCORE_FORMAT = fmt::compile<int>(FMT_STRING(L"Score: {}"));
+  static const auto SPEED_FORMAT
+    = fmt::compile<float>(FMT_STRING(L"Player Speed: {}"));
+  static const auto PROFILER_FORMAT
+    = fmt::compile<fmt::wstring_view, float, double, double>(
+      FMT_STRING(L"{:<35} ({:>2})h    ({:>5.4f} / {:<5.4f})ms"));
+  strUtils::InlineWString<32> scoreText;
+  strUtils::InlineWString<64> speedText;
+  std::vector<strUtils::InlineWString<128>> profilerTexts(NUM_PROFILED);
+  strUtils::InlineWString<64> functionName;
+
+  bool textMatches          = true;
+  uint64_t oldAllocations   = 0;
+  uint64_t newAllocations   = 0;
+  uint64_t numChangedLabels = 0;
+  double oldS               = 0.0;
+  double newS               = 0.0;
+  for (uint64_t frame = 0; frame < numFrames; ++frame)
+  {
+    updateValues(random, score, speed, records);
+    const bool isWarmUp = frame < WARM_UP_FRAMES;
+
+    uint64_t allocStart = memory::AllocationCounter::numAllocations();
+    auto startTime      = std::chrono::steady_clock::now();
+    scoreStr            = fmt::format(L"Score: {}", score);
+    speedStr            = fmt::format(L"Player Speed: {}", speed);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+      const auto& r   = records[i];
+      profilerStrs[i] = fmt::format(
+        L"{:<35} ({:>2})h    ({:>5.4f} / {:<5.4f})ms",
+        strUtils::utf8ToWstring(r.function),
+        r.callsAverage,
+        r.minMs,
+        r.maxMs);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    oldS += std::chrono::duration<double>(endTime - startTime).count();
+    oldAllocations
+      += memory::AllocationCounter::numAllocations() - allocStart;
+
+    allocStart = memory::AllocationCounter::numAllocations();
+    startTime  = std::chrono::steady_clock::now();
+    numChangedLabels += scoreText.format(SCORE_FORMAT, score);
+    numChangedLabels += speedText.format(SPEED_FORMAT, speed);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+      const auto& r = records[i];
+      functionName.assignUtf8(r.function);
+      numChangedLabels += profilerTexts[i].format(
+        PROFILER_FORMAT, functionName.view(), r.callsAverage, r.minMs, r.maxMs);
+    }
+    endTime = std::chrono::steady_clock::now();
+    newS += std::chrono::duration<double>(endTime - startTime).count();
+    if (!isWarmUp)
+    {
+      newAllocations
+        += memory::AllocationCounter::numAllocations() - allocStart;
+    }
+
+    textMatches = textMatches && (scoreStr == scoreText.c_str())
+                  && (speedStr == speedText.c_str());
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+      textMatches
+        = textMatches && (profilerStrs[i] == profilerTexts[i].c_str());
+    }
+  }
+
+  const size_t labelsPerFrame = 2 + NUM_PROFILED;
+  const double oldUs          = 1e6 * oldS / numFrames;
+  const double newUs          = 1e6 * newS / numFrames;
+  std::printf("%16s %12s %14s\n", "", "us / frame", "allocs / frame");
+  std::printf(
+    "%16s %12.2f %14.2f\n",
+    "fmt::format",
+    oldUs,
+    double(oldAllocations) / numFrames);
+  std::printf(
+    "%16s %12.2f %14.2f\n",
+    "compiled inline",
+    newUs,
+    double(newAllocations) / numFrames);
+  std::printf(
+    "(%zu labels per frame over %llu frames, %llu of them changed; "
+    "%.1fx faster)\n",
+    labelsPerFrame,
+    static_cast<unsigned long long>(numFrames),
+    static_cast<unsigned long long>(numChangedLabels),
+    (newUs > 0.0) ? oldUs / newUs : 0.0);
+
+  if (!textMatches)
+  {
+    LOG_ERROR("Inline formatted text differs from fmt::format");
+    return EXIT_FAILURE;
+  }
+  if (newAllocations != 0)
+  {
+    LOG_ERROR("Inline formatting allocated after warm-up");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,209 @@
+#include "pch.h"
+#include "D3D11RenderBackend.h"
+#include "AppResources.h"
+#include "Entity.h"
+
+#include "utils/Log.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using render::Command;
+
+static_assert(
+  sizeof(render::LineVertex) == sizeof(VertexPositionColor),
+  "Line vertices are drawn as VertexPositionColor");
+
+//------------------------------------------------------------------------------
+D3D11RenderBackend::D3D11RenderBackend(AppResources& resources)
+    : m_resources(resources)
+{
+}
+
+//------------------------------------------------------------------------------
+void
+D3D11RenderBackend::execute(const render::CommandList& list)
+{
+  TRACE
+  const auto& commands = list.commands();
+  auto it              = commands.begin();
+  while (it != commands.end())
+  {
+    switch (it->type)
+    {
+      case Command::Type::Model:
+        it = drawModels(list, it, commands.end());
+        break;
+
+      case Command::Type::Sprites:
+        it = drawSprites(list, it, commands.end());
+        break;
+
+      case Command::Type::Lines:
+        it = drawLines(list, it, commands.end());
+        break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Returns the end of the run of models
+//------------------------------------------------------------------------------
+D3D11RenderBackend::CommandIter
+D3D11RenderBackend::drawModels(
+  const render::CommandList& list, CommandIter begin, CommandIter end)
+{
+  TRACE
+  auto* context      = m_resources.m_deviceResources->GetD3DDeviceContext();
+  const auto& states = *m_resources.m_states;
+
+  const Matrix view       = toMatrix(list.worldToView());
+  const Matrix projection = toMatrix(list.viewToProjection());
+
+  const auto runEnd = std::find_if(begin, end, [](const Command& command) {
+    return command.type != Command::Type::Model;
+  });
+
+  // The states ModelMesh::PrepareForRendering sets only depend on these, so
+  // they're set again only when they change. Anything drawn before the run
+  // may have changed them.
+  int preparedKey = -1;
+  auto prepare    = [&](const ModelMesh& mesh, bool alpha) {
+    const int key = (alpha ? (mesh.pmalpha ? 2 : 1) : 0) * 2 + mesh.ccw;
+    if (key != preparedKey)
+    {
+      mesh.PrepareForRendering(context, states, alpha);
+      preparedKey = key;
+    }
+  };
+  auto hasAlphaParts = [](const ModelMesh& mesh) {
+    return std::any_of(
+      mesh.meshParts.begin(), mesh.meshParts.end(), [](const auto& part) {
+        return part->isAlpha;
+      });
+  };
+
+  // As Model::Draw, the opaque parts first and then the alpha parts, but for
+  // the whole run rather than model by model
+  for (bool alpha : {false, true})
+  {
+    for (auto it = begin; it != runEnd; ++it)
+    {
+      const auto& draw   = list.models()[it->idx];
+      const auto& model  = *m_resources.modelData.at(draw.model).model;
+      const Matrix world = toMatrix(draw.world);
+      for (const auto& mesh : model.meshes)
+      {
+        if (alpha && !hasAlphaParts(*mesh))
+        {
+          continue;
+        }
+        prepare(*mesh, alpha);
+        mesh->Draw(context, world, view, projection, alpha);
+      }
+    }
+  }
+  return runEnd;
+}
+
+//------------------------------------------------------------------------------
+// Returns the end of the run of sprites with the same blend
+//------------------------------------------------------------------------------
+D3D11RenderBackend::CommandIter
+D3D11RenderBackend::drawSprites(
+  const render::CommandList& list, CommandIter begin, CommandIter end)
+{
+  TRACE
+  const auto& states = *m_resources.m_states;
+  auto& spriteBatch  = *m_resources.m_spriteBatch;
+
+  const render::BlendMode blend = list.sprites()[begin->idx].blend;
+
+  const auto runEnd = std::find_if(begin, end, [&](const Command& command) {
+    return command.type != Command::Type::Sprites
+           || list.sprites()[command.idx].blend != blend;
+  });
+
+  spriteBatch.Begin(
+    SpriteSortMode_Deferred,
+    (blend == render::BlendMode::Additive) ? states.Additive()
+                                           : states.AlphaBlend());
+  for (auto it = begin; it != runEnd; ++it)
+  {
+    const auto& draw   = list.sprites()[it->idx];
+    const auto& sprite = draw.sprite;
+    const auto arrays  = list.quads(draw);
+
+    SpriteQuads quads;
+    quads.x     = arrays.x;
+    quads.y     = arrays.y;
+    quads.scale = arrays.scale;
+    quads.r     = arrays.r;
+    quads.g     = arrays.g;
+    quads.b     = arrays.b;
+    quads.a     = arrays.a;
+    quads.count = arrays.count;
+
+    const RECT rect = {sprite.left, sprite.top, sprite.right, sprite.bottom};
+    spriteBatch.DrawQuads(
+      texture(sprite.texture),
+      quads,
+      &rect,
+      Colors::White,
+      XMFLOAT2(sprite.originX, sprite.originY));
+  }
+  spriteBatch.End();
+  return runEnd;
+}
+
+//------------------------------------------------------------------------------
+// Returns the end of the run of lines
+//------------------------------------------------------------------------------
+D3D11RenderBackend::CommandIter
+D3D11RenderBackend::drawLines(
+  const render::CommandList& list, CommandIter begin, CommandIter end)
+{
+  TRACE
+  auto* context      = m_resources.m_deviceResources->GetD3DDeviceContext();
+  const auto& states = *m_resources.m_states;
+  auto& effect       = *m_resources.m_debugEffect;
+  auto* batch        = m_resources.m_batch.get();
+
+  const auto runEnd = std::find_if(begin, end, [](const Command& command) {
+    return command.type != Command::Type::Lines;
+  });
+
+  // As DX::DrawContext::begin(Projection::World)
+  context->OMSetBlendState(states.Opaque(), nullptr, 0xFFFFFFFF);
+  context->OMSetDepthStencilState(states.DepthDefault(), 0);
+  context->RSSetState(states.CullNone());
+  context->IASetInputLayout(m_resources.m_debugInputLayout.Get());
+  effect.SetView(toMatrix(list.worldToView()));
+  effect.SetProjection(toMatrix(list.viewToProjection()));
+  effect.Apply(context);
+
+  batch->Begin();
+  for (auto it = begin; it != runEnd; ++it)
+  {
+    const auto& draw = list.lines()[it->idx];
+    DX::DrawLineList(
+      batch,
+      reinterpret_cast<const VertexPositionColor*>(list.lineVertices(draw)),
+      draw.numVertices);
+  }
+  batch->End();
+  return runEnd;
+}
+
+//------------------------------------------------------------------------------
+ID3D11ShaderResourceView*
+D3D11RenderBackend::texture(render::TextureId textureId) const
+{
+  switch (textureId)
+  {
+    case render::TextureId::Atlas:
+    default:
+      return m_resources.atlas.texture();
+  }
+}
+
+//------------------------------------------------------------------------------
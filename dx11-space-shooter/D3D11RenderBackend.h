@@ -0,0 +1,38 @@
+#pragma once
+#include "pch.h"
+#include "Render/CommandList.h"
+
+struct AppResources;
+
+//------------------------------------------------------------------------------
+// Submits a render::CommandList to the device.
+//
+// Runs of model draws share their states: a mesh's blend, depth, rasterizer
+// and sampler states are only set when they differ from the previous mesh's,
+// rather than for every mesh of every model. Runs of sprite draws with the
+// same blend go through one SpriteBatch Begin/End, and line draws through the
+// debug PrimitiveBatch.
+//------------------------------------------------------------------------------
+class D3D11RenderBackend
+{
+public:
+  explicit D3D11RenderBackend(AppResources& resources);
+
+  void execute(const render::CommandList& list);
+
+private:
+  using CommandIter = std::vector<render::Command>::const_iterator;
+
+  AppResources& m_resources;
+
+  CommandIter drawModels(
+    const render::CommandList& list, CommandIter begin, CommandIter end);
+  CommandIter drawSprites(
+    const render::CommandList& list, CommandIter begin, CommandIter end);
+  CommandIter drawLines(
+    const render::CommandList& list, CommandIter begin, CommandIter end);
+
+  ID3D11ShaderResourceView* texture(render::TextureId textureId) const;
+};
+
+//------------------------------------------------------------------------------
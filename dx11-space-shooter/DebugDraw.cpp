@@ -15,6 +15,7 @@
 #include "DebugDraw.h"
 #include "AppContext.h"
 #include "AppResources.h"
+#include "Simulation/LevelData.h"
 
 using namespace DirectX;
 
@@ -167,17 +168,9 @@ void XM_CALLCONV
 DX::Draw(
   DX::DebugBatchType* batch, const BoundingSphere& sphere, FXMVECTOR color)
 {
-  XMVECTOR origin = XMLoadFloat3(&sphere.Center);
-
-  const float radius = sphere.Radius;
-
-  XMVECTOR xaxis = g_XMIdentityR0 * radius;
-  XMVECTOR yaxis = g_XMIdentityR1 * radius;
-  XMVECTOR zaxis = g_XMIdentityR2 * radius;
-
-  DrawRing(batch, origin, xaxis, zaxis, color);
-  DrawRing(batch, origin, xaxis, yaxis, color);
-  DrawRing(batch, origin, yaxis, zaxis, color);
+  VertexPositionColor verts[LINE_LIST_SPHERE_SIZE];
+  WriteSphere(verts, sphere, color);
+  batch->Draw(D3D11_PRIMITIVE_TOPOLOGY_LINELIST, verts, LINE_LIST_SPHERE_SIZE);
 }
 
 //------------------------------------------------------------------------------
@@ -300,7 +293,7 @@ DX::DrawRing(
   FXMVECTOR minorAxis,
   GXMVECTOR color)
 {
-  static const size_t c_ringSegments = 32;
+  static const size_t c_ringSegments = RING_SEGMENTS;
 
   VertexPositionColor verts[c_ringSegments + 1];
 
@@ -410,7 +403,7 @@ DX::DrawCurve(
   FXMVECTOR control,
   GXMVECTOR color)
 {
-  static const size_t numSegments = 20;
+  static const size_t numSegments = CURVE_SEGMENTS;
   VertexPositionColor verts[numSegments + 1];
   const FLOAT tDelta = 1.0f / float(numSegments);
   FLOAT t            = tDelta;
@@ -446,3 +439,280 @@ DX::DrawLine(
 }
 
 //------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+void
+DX::DrawPath(
+  DX::DebugBatchType* batch,
+  const Path& path,
+  size_t selectedPointIdx,
+  size_t selectedControlIdx)
+{
+  std::vector<VertexPositionColor> vertices(LineListPathSize(path));
+  WritePath(vertices.data(), path, selectedPointIdx, selectedControlIdx);
+  DrawLineList(batch, vertices.data(), vertices.size());
+}
+
+//------------------------------------------------------------------------------
+VertexPositionColor* XM_CALLCONV
+DX::WriteRing(
+  VertexPositionColor* out,
+  FXMVECTOR origin,
+  FXMVECTOR majorAxis,
+  FXMVECTOR minorAxis,
+  GXMVECTOR color)
+{
+  // Same incremental rotation as DrawRing
+  const FLOAT fAngleDelta = XM_2PI / float(RING_SEGMENTS);
+  const XMVECTOR cosDelta = XMVectorReplicate(cosf(fAngleDelta));
+  const XMVECTOR sinDelta = XMVectorReplicate(sinf(fAngleDelta));
+  XMVECTOR incrementalSin = XMVectorZero();
+  XMVECTOR incrementalCos = XMVectorSplatOne();
+  XMFLOAT4 packedColor;
+  XMStoreFloat4(&packedColor, color);
+
+  XMFLOAT3 points[RING_SEGMENTS];
+  for (size_t i = 0; i < RING_SEGMENTS; i++)
+  {
+    XMVECTOR pos = XMVectorMultiplyAdd(majorAxis, incrementalCos, origin);
+    pos          = XMVectorMultiplyAdd(minorAxis, incrementalSin, pos);
+    XMStoreFloat3(&points[i], pos);
+    XMVECTOR newCos = incrementalCos * cosDelta - incrementalSin * sinDelta;
+    XMVECTOR newSin = incrementalCos * sinDelta + incrementalSin * cosDelta;
+    incrementalCos  = newCos;
+    incrementalSin  = newSin;
+  }
+
+  for (size_t i = 0; i < RING_SEGMENTS; i++)
+  {
+    out[0].position = points[i];
+    out[0].color    = packedColor;
+    out[1].position = points[(i + 1) % RING_SEGMENTS];
+    out[1].color    = packedColor;
+    out += 2;
+  }
+  return out;
+}
+
+//------------------------------------------------------------------------------
+// The three rings of a unit sphere at the origin, worked out once
+static const XMFLOAT3*
+unitSphereLineList()
+{
+  static const auto s_positions = [] {
+    std::array<VertexPositionColor, DX::LINE_LIST_SPHERE_SIZE> verts;
+    auto out = verts.data();
+    out = DX::WriteRing(out, g_XMZero, g_XMIdentityR0, g_XMIdentityR2, g_XMOne);
+    out = DX::WriteRing(out, g_XMZero, g_XMIdentityR0, g_XMIdentityR1, g_XMOne);
+    out = DX::WriteRing(out, g_XMZero, g_XMIdentityR1, g_XMIdentityR2, g_XMOne);
+
+    std::array<XMFLOAT3, DX::LINE_LIST_SPHERE_SIZE> positions;
+    for (size_t i = 0; i < verts.size(); ++i)
+    {
+      positions[i] = verts[i].position;
+    }
+    return positions;
+  }();
+  return s_positions.data();
+}
+
+//------------------------------------------------------------------------------
+VertexPositionColor* XM_CALLCONV
+DX::WriteSphere(
+  VertexPositionColor* out, const BoundingSphere& sphere, FXMVECTOR color)
+{
+  const XMVECTOR center = XMLoadFloat3(&sphere.Center);
+  const XMVECTOR radius = XMVectorReplicate(sphere.Radius);
+  XMFLOAT4 packedColor;
+  XMStoreFloat4(&packedColor, color);
+
+  const XMFLOAT3* unitPositions = unitSphereLineList();
+  for (size_t i = 0; i < LINE_LIST_SPHERE_SIZE; ++i)
+  {
+    const XMVECTOR unit = XMLoadFloat3(&unitPositions[i]);
+    XMStoreFloat3(&out[i].position, XMVectorMultiplyAdd(unit, radius, center));
+    out[i].color = packedColor;
+  }
+  return out + LINE_LIST_SPHERE_SIZE;
+}
+
+//------------------------------------------------------------------------------
+VertexPositionColor* XM_CALLCONV
+DX::WriteCurve(
+  VertexPositionColor* out,
+  FXMVECTOR startPos,
+  FXMVECTOR endPos,
+  FXMVECTOR control,
+  GXMVECTOR color)
+{
+  XMFLOAT4 packedColor;
+  XMStoreFloat4(&packedColor, color);
+
+  XMFLOAT3 prevPoint;
+  XMStoreFloat3(&prevPoint, startPos);
+  const FLOAT tDelta = 1.0f / float(CURVE_SEGMENTS);
+  for (size_t i = 1; i <= CURVE_SEGMENTS; ++i)
+  {
+    XMFLOAT3 point;
+    XMStoreFloat3(
+      &point,
+      (i == CURVE_SEGMENTS) ? endPos
+                            : bezier(tDelta * i, startPos, endPos, control));
+    out[0].position = prevPoint;
+    out[0].color    = packedColor;
+    out[1].position = point;
+    out[1].color    = packedColor;
+    out += 2;
+    prevPoint = point;
+  }
+  return out;
+}
+
+//------------------------------------------------------------------------------
+size_t
+DX::LineListPathSize(const Path& path)
+{
+  const size_t numWaypoints = path.waypoints.size();
+  if (numWaypoints == 0)
+  {
+    return 0;
+  }
+
+  // A ring on the first point, then per segment: the curve, a ring on the
+  // point, and a line to and a ring on its control point
+  const size_t segmentSize
+    = LINE_LIST_CURVE_SIZE + LINE_LIST_RING_SIZE + 2 + LINE_LIST_RING_SIZE;
+  return LINE_LIST_RING_SIZE + (numWaypoints - 1) * segmentSize;
+}
+
+//------------------------------------------------------------------------------
+VertexPositionColor*
+DX::WritePath(
+  VertexPositionColor* out,
+  const Path& path,
+  size_t selectedPointIdx,
+  size_t selectedControlIdx)
+{
+  static const float radius   = 0.6f;
+  static const XMVECTOR xaxis = g_XMIdentityR0 * radius;
+  static const XMVECTOR yaxis = g_XMIdentityR1 * radius;
+
+  static const XMVECTOR SELECTED_COLOR = Colors::OrangeRed;
+  static const XMVECTOR POINT_COLOR    = Colors::White;
+  static const XMVECTOR CONTROL_COLOR  = Colors::Yellow;
+
+  const auto& waypoints = path.waypoints;
+  ASSERT(!waypoints.empty());
+  auto prevPoint = toVector3(waypoints[0].wayPoint);
+  out            = WriteRing(
+    out,
+    prevPoint,
+    xaxis,
+    yaxis,
+    (selectedPointIdx == 0) ? SELECTED_COLOR : POINT_COLOR);
+
+  for (size_t i = 1; i < waypoints.size(); ++i)
+  {
+    const auto point   = toVector3(waypoints[i].wayPoint);
+    const auto control = toVector3(waypoints[i].controlPoint);
+
+    out = WriteCurve(out, prevPoint, point, control, Colors::White);
+    out = WriteRing(
+      out,
+      point,
+      xaxis,
+      yaxis,
+      (selectedPointIdx == i) ? SELECTED_COLOR : POINT_COLOR);
+
+    *out++ = VertexPositionColor(point, Colors::Yellow);
+    *out++ = VertexPositionColor(control, Colors::Yellow);
+    out    = WriteRing(
+      out,
+      control,
+      xaxis,
+      yaxis,
+      (selectedControlIdx == i) ? SELECTED_COLOR : CONTROL_COLOR);
+
+    prevPoint = point;
+  }
+  return out;
+}
+
+//------------------------------------------------------------------------------
+void
+DX::DrawLineList(
+  DX::DebugBatchType* batch,
+  const VertexPositionColor* vertices,
+  size_t numVertices)
+{
+  // PrimitiveBatch takes fewer than its buffer size per Draw, and merges
+  // consecutive line list draws. Chunks stay a whole number of lines.
+  constexpr size_t MAX_CHUNK_SIZE = DX::DebugBatchType::DefaultBatchSize - 2;
+
+  while (numVertices > 0)
+  {
+    const size_t chunkSize = std::min(numVertices, MAX_CHUNK_SIZE);
+    batch->Draw(D3D11_PRIMITIVE_TOPOLOGY_LINELIST, vertices, chunkSize);
+    vertices += chunkSize;
+    numVertices -= chunkSize;
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+DX::PathDebugCache::draw(
+  DX::DebugBatchType* batch,
+  const Path& path,
+  size_t selectedPointIdx,
+  size_t selectedControlIdx)
+{
+  ++m_drawCount;
+  if (path.version == 0)    // Never baked, nothing to key the geometry on
+  {
+    m_uncached.resize(LineListPathSize(path));
+    WritePath(m_uncached.data(), path, selectedPointIdx, selectedControlIdx);
+    DrawLineList(batch, m_uncached.data(), m_uncached.size());
+    return;
+  }
+
+  auto found       = m_entries.find(path.version);
+  const bool isNew = (found == m_entries.end());
+  if (isNew)
+  {
+    if (m_entries.size() >= MAX_CACHED_PATHS)
+    {
+      evictOldest();
+    }
+    found = m_entries.emplace(path.version, Entry()).first;
+  }
+
+  Entry& entry = found->second;
+  if (
+    isNew || (entry.selectedPointIdx != selectedPointIdx)
+    || (entry.selectedControlIdx != selectedControlIdx))
+  {
+    entry.selectedPointIdx   = selectedPointIdx;
+    entry.selectedControlIdx = selectedControlIdx;
+    entry.vertices.resize(LineListPathSize(path));
+    WritePath(
+      entry.vertices.data(), path, selectedPointIdx, selectedControlIdx);
+  }
+  entry.lastDrawn = m_drawCount;
+
+  DrawLineList(batch, entry.vertices.data(), entry.vertices.size());
+}
+
+//------------------------------------------------------------------------------
+void
+DX::PathDebugCache::evictOldest()
+{
+  // Keep those drawn within the last half cache's worth of draws
+  const uint64_t oldestKept = m_drawCount - (MAX_CACHED_PATHS / 2);
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    it = (it->second.lastDrawn < oldestKept) ? m_entries.erase(it)
+                                             : std::next(it);
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -17,11 +17,16 @@
 
 #include <DirectXCollision.h>
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "PrimitiveBatch.h"
 #include "VertexTypes.h"
 
 struct AppContext;
 struct AppResources;
+struct Path;
 
 namespace DX
 {
@@ -125,4 +130,89 @@ void XM_CALLCONV DrawLine(
   DirectX::FXMVECTOR endPos,
   DirectX::FXMVECTOR color = DirectX::Colors::White);
 
+// Waypoints, control points and the bezier curves between them
+void DrawPath(
+  DebugBatchType* batch,
+  const Path& path,
+  size_t selectedPointIdx   = -1,
+  size_t selectedControlIdx = -1);
+
+//------------------------------------------------------------------------------
+// Line list geometry
+//
+// The strips drawn above can't be merged by PrimitiveBatch, so each ring or
+// curve is a draw call of its own. These write the same shapes as line lists
+// into a caller's buffer instead (of exactly the given vertex count, returning
+// the end), which can be built once, kept, and drawn in a few large batches.
+//------------------------------------------------------------------------------
+constexpr size_t RING_SEGMENTS         = 32;
+constexpr size_t CURVE_SEGMENTS        = 20;
+constexpr size_t LINE_LIST_RING_SIZE   = RING_SEGMENTS * 2;
+constexpr size_t LINE_LIST_CURVE_SIZE  = CURVE_SEGMENTS * 2;
+constexpr size_t LINE_LIST_SPHERE_SIZE = LINE_LIST_RING_SIZE * 3;
+
+DirectX::VertexPositionColor* XM_CALLCONV WriteRing(
+  DirectX::VertexPositionColor* out,
+  DirectX::FXMVECTOR origin,
+  DirectX::FXMVECTOR majorAxis,
+  DirectX::FXMVECTOR minorAxis,
+  DirectX::GXMVECTOR color);
+
+DirectX::VertexPositionColor* XM_CALLCONV WriteSphere(
+  DirectX::VertexPositionColor* out,
+  const DirectX::BoundingSphere& sphere,
+  DirectX::FXMVECTOR color);
+
+DirectX::VertexPositionColor* XM_CALLCONV WriteCurve(
+  DirectX::VertexPositionColor* out,
+  DirectX::FXMVECTOR startPos,
+  DirectX::FXMVECTOR endPos,
+  DirectX::FXMVECTOR control,
+  DirectX::GXMVECTOR color);
+
+size_t LineListPathSize(const Path& path);
+DirectX::VertexPositionColor* WritePath(
+  DirectX::VertexPositionColor* out,
+  const Path& path,
+  size_t selectedPointIdx   = -1,
+  size_t selectedControlIdx = -1);
+
+// Draws in chunks that fit the batch's vertex buffer
+void DrawLineList(
+  DebugBatchType* batch,
+  const DirectX::VertexPositionColor* vertices,
+  size_t numVertices);
+
+//------------------------------------------------------------------------------
+// Path geometry built once per Path::version (and selection), rather than
+// every frame. Paths not drawn recently are dropped once the cache is full.
+//------------------------------------------------------------------------------
+class PathDebugCache
+{
+public:
+  static constexpr size_t MAX_CACHED_PATHS = 512;
+
+  void draw(
+    DebugBatchType* batch,
+    const Path& path,
+    size_t selectedPointIdx   = -1,
+    size_t selectedControlIdx = -1);
+  void clear() { m_entries.clear(); }
+
+private:
+  struct Entry
+  {
+    size_t selectedPointIdx   = 0;
+    size_t selectedControlIdx = 0;
+    uint64_t lastDrawn        = 0;
+    std::vector<DirectX::VertexPositionColor> vertices;
+  };
+
+  void evictOldest();
+
+  std::unordered_map<uint64_t, Entry> m_entries;    // By Path::version
+  std::vector<DirectX::VertexPositionColor> m_uncached;
+  uint64_t m_drawCount = 0;
+};
+
 }    // namespace DX
@@ -3,7 +3,7 @@
 #include "Editor/Modes.h"
 #include "AppContext.h"
 #include "AppResources.h"
-#include "Enemies.h"
+#include "Simulation/Enemies.h"
 
 #include "utils/Log.h"
 
@@ -2,7 +2,7 @@
 #include "Editor/FormationSectionEditorMode.h"
 #include "Editor/Modes.h"
 #include "AppContext.h"
-#include "Enemies.h"
+#include "Simulation/Enemies.h"
 
 #include "utils/Log.h"
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "LevelData.h"
+#include "Simulation/LevelData.h"
 #include "UIDebugDraw.h"
 
 //------------------------------------------------------------------------------
@@ -44,7 +44,9 @@ PathEditorMode::onBack()
 void
 PathEditorMode::onCreate()
 {
-  pathRef(m_context.editorPathIdx).waypoints.emplace_back(Waypoint());
+  auto& path = pathRef(m_context.editorPathIdx);
+  path.waypoints.emplace_back(Waypoint());
+  path.bake();
 }
 
 //------------------------------------------------------------------------------
@@ -53,6 +55,7 @@ PathEditorMode::onDeleteItem(size_t itemIdx)
 {
   auto& path = pathRef(m_context.editorPathIdx);
   path.waypoints.erase(path.waypoints.begin() + itemIdx);
+  path.bake();
 }
 
 //------------------------------------------------------------------------------
@@ -88,8 +91,11 @@ PathEditorMode::render()
   size_t pointIdx   = (isControlSelected) ? -1 : m_selectedIdx;
   size_t controlIdx = (isControlSelected) ? m_selectedIdx : -1;
 
-  pathRef(m_context.editorPathIdx)
-    .debugRender(m_resources.m_batch.get(), pointIdx, controlIdx);
+  m_resources.pathDebugCache.draw(
+    m_resources.m_batch.get(),
+    pathRef(m_context.editorPathIdx),
+    pointIdx,
+    controlIdx);
   m_gameLogic.renderPlayerBoundary();
 }
 
@@ -105,9 +111,7 @@ PathEditorMode::handleInput(const DX::StepTimer& timer)
   auto& path = pathRef(m_context.editorPathIdx);
 
   using DirectX::SimpleMath::Vector3;
-  DirectX::SimpleMath::Matrix worldToScreen = m_context.worldToView
-                                              * m_context.viewToProjection
-                                              * m_context.projectionToPixels;
+  const DirectX::SimpleMath::Matrix& worldToScreen = m_context.worldToPixels;
 
   DirectX::SimpleMath::Matrix screenToView
     = m_context.pixelsToProjection * m_context.viewToProjection.Invert();
@@ -135,12 +139,12 @@ PathEditorMode::handleInput(const DX::StepTimer& timer)
   for (size_t i = 0; i < path.waypoints.size(); ++i)
   {
     auto& waypoint = path.waypoints[i];
-    if (isMouseOverPoint(mouseState, waypoint.wayPoint))
+    if (isMouseOverPoint(mouseState, toVector3(waypoint.wayPoint)))
     {
       m_selectedIdx     = i;
       isControlSelected = false;
     }
-    if (isMouseOverPoint(mouseState, waypoint.controlPoint))
+    if (isMouseOverPoint(mouseState, toVector3(waypoint.controlPoint)))
     {
       m_selectedIdx     = i;
       isControlSelected = true;
@@ -168,7 +172,8 @@ PathEditorMode::handleInput(const DX::StepTimer& timer)
       auto& point = (isControlSelected)
                       ? path.waypoints[m_selectedIdx].controlPoint
                       : path.waypoints[m_selectedIdx].wayPoint;
-      point = cameraPos + (rayDir * dist);
+      point = toVec3(cameraPos + (rayDir * dist));
+      path.bake();
     }
   }
 }
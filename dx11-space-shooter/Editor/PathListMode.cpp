@@ -3,7 +3,7 @@
 #include "Editor/Modes.h"
 #include "AppContext.h"
 #include "AppResources.h"
-#include "Enemies.h"
+#include "Simulation/Enemies.h"
 
 #include "utils/Log.h"
 
@@ -49,7 +49,7 @@ PathListMode::setItemName(size_t itemIdx, const std::wstring& newName)
 void
 PathListMode::onCreate()
 {
-  pathsRef().emplace_back(Path{L"New", {Waypoint()}});
+  pathsRef().emplace_back(Path{L"New", {Waypoint()}}).bake();
 }
 
 //------------------------------------------------------------------------------
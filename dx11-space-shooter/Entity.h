@@ -1,5 +1,7 @@
 #pragma once
 #include "pch.h"
+#include "Render/RenderMath.h"
+#include "Simulation/SimContext.h"    // EntityStore, entity partitions
 
 //------------------------------------------------------------------------------
 struct ModelData
@@ -9,38 +11,39 @@ struct ModelData
 };
 
 //------------------------------------------------------------------------------
-// Entities Partitioned by type
-static const size_t NUM_PLAYERS = 1;
-static const size_t PLAYERS_IDX = 0;
-static const size_t PLAYERS_END = PLAYERS_IDX + NUM_PLAYERS;
-
-static const size_t NUM_PLAYER_SHOTS = 10;
-static const size_t PLAYER_SHOTS_IDX = PLAYERS_END;
-static const size_t PLAYER_SHOTS_END = PLAYER_SHOTS_IDX + NUM_PLAYER_SHOTS;
-
-static const size_t NUM_ENEMY_SHOTS = 10;
-static const size_t ENEMY_SHOTS_IDX = PLAYER_SHOTS_END;
-static const size_t ENEMY_SHOTS_END = ENEMY_SHOTS_IDX + NUM_ENEMY_SHOTS;
+// Conversions between the simulation and DirectXMath types
+//------------------------------------------------------------------------------
+inline DirectX::SimpleMath::Vector3
+toVector3(const sim::Vec3& v)
+{
+  return DirectX::SimpleMath::Vector3(v.x, v.y, v.z);
+}
 
-static const size_t NUM_ENEMIES = 60;
-static const size_t ENEMIES_IDX = ENEMY_SHOTS_END;
-static const size_t ENEMIES_END = ENEMIES_IDX + NUM_ENEMIES;
+inline sim::Vec3
+toVec3(const DirectX::XMFLOAT3& v)
+{
+  return sim::Vec3(v.x, v.y, v.z);
+}
 
-static const size_t NUM_ENTITIES = ENEMIES_END;
+inline sim::BoundingSphere
+toBoundingSphere(const DirectX::BoundingSphere& bound)
+{
+  return sim::BoundingSphere{toVec3(bound.Center), bound.Radius};
+}
 
-static const size_t BALLISTIC_IDX = 0;
-static const size_t BALLISTIC_END = ENEMIES_IDX;
+// Both row-major, row vectors
+inline render::Matrix4
+toMatrix4(const DirectX::SimpleMath::Matrix& m)
+{
+  render::Matrix4 result;
+  std::copy(&m.m[0][0], &m.m[0][0] + 16, &result.m[0][0]);
+  return result;
+}
 
-//------------------------------------------------------------------------------
-struct Entity
+inline DirectX::SimpleMath::Matrix
+toMatrix(const render::Matrix4& m)
 {
-  DirectX::SimpleMath::Vector3 position = {};
-  DirectX::SimpleMath::Vector3 velocity = {};
-  float birthTimeS                      = 0.0f;
-  size_t pathIdx                        = 0;
-  ModelData* model                      = nullptr;
-  bool isColliding                      = false;
-  bool isAlive                          = false;
-};
+  return DirectX::SimpleMath::Matrix(&m.m[0][0]);
+}
 
 //------------------------------------------------------------------------------
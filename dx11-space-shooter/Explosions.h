@@ -1,44 +1,38 @@
 #pragma once
 #include "pch.h"
+#include "Render/CommandList.h"
+#include "Simulation/ExplosionSim.h"
+#include "TextureAtlas.h"
 
 namespace DX
 {
 class StepTimer;
 }
 struct AppContext;
-struct Texture;
 
 //------------------------------------------------------------------------------
 class Explosions
 {
 public:
-  Explosions(AppContext& context, Texture& texture);
+  Explosions(
+    AppContext& context, const TextureAtlas& atlas, sim::Random::Seed seed);
 
   void reset();
   void update(DX::StepTimer const& timer);
-  void render(DirectX::SpriteBatch& batch);
+  sim::JobSystem::Job*
+  scheduleUpdate(DX::StepTimer const& timer, sim::JobSystem& jobs);
+  void record(render::CommandList& commands);
   void emit(
     const DirectX::SimpleMath::Vector3& origin,
     const DirectX::SimpleMath::Vector3& baseVelocity,
     size_t numParticles = 200);
 
+  ExplosionSim& sim() { return m_sim; }
+
 private:
   AppContext& m_context;
-  Texture& m_texture;
-
-  struct ExplosionParticle
-  {
-    DirectX::XMFLOAT3 position;
-    DirectX::XMFLOAT3 velocity;
-    float energy = 0.0f;
-  };
-  static const size_t MAX_NUM_PARTICLES = 2048;
-  std::array<ExplosionParticle, MAX_NUM_PARTICLES> m_particles;
-  size_t m_nextParticleIdx = 0;
-
-  // Random Generators
-  std::random_device m_device;
-  std::default_random_engine m_engine;
+  render::SpriteRef m_sprite;
+  ExplosionSim m_sim;
 };
 
 //------------------------------------------------------------------------------
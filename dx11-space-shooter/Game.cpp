@@ -6,6 +6,9 @@
 #define LOGGER_PROFILER_IMPLEMENTATION
 #include "utils/Log.h"
 
+#define TRACE_EXPORTER_IMPLEMENTATION
+#include "utils/TraceExporter.h"
+
 //------------------------------------------------------------------------------
 extern void ExitGame();
 
@@ -13,12 +16,39 @@ extern void ExitGame();
 static const std::wstring MODEL_PATH = L"assets/";
 static const std::wstring AUDIO_PATH = L"assets/audio/";
 
+static const auto PROFILE_INFO_FORMAT
+  = fmt::compile<uint32_t, double, double, double, double, double, size_t>(
+    FMT_STRING(L"fps: {}, Time: {:.2f}ms, TRACE: {:.0f}ns, "
+               L"p50/99/99.9: {:.2f}/{:.2f}/{:.2f}ms, Spikes: {}"));
+static const auto PROFILER_LINE_FORMAT = fmt::compile<
+  fmt::wstring_view,
+  int32_t,
+  double,
+  double,
+  double,
+  double,
+  double,
+  double>(FMT_STRING(L"{:<35} ({:>2})h    ({:>5.4f} / {:<5.4f})ms    "
+                     L"p50/95/99/99.9 {:>5.4f} {:>5.4f} {:>5.4f} {:>5.4f}ms"));
+static const auto SPIKE_INFO_FORMAT
+  = fmt::compile<uint32_t, double>(FMT_STRING(
+    L"Spike: frame {}, {:.2f}ms (F7 releases it to catch the next)"));
+
+// Frames which take longer than two at 60fps are captured (F7 shows them)
+static const double SPIKE_THRESHOLD_MS = 2000.0 / 60.0;
+
+// 10s of frames per file at 60fps, the last minute kept
+static const logger::TraceExporter::Config TRACE_CAPTURE_CONFIG
+  = {"profile_trace", 600, 6};
+
 //------------------------------------------------------------------------------
 Game::Game()
     : m_gameLogic(m_context, m_resources)
     , m_appStates(m_context, m_resources, m_gameLogic)
 {
   TRACE
+  logger::TimedRaiiBlock::setThreadName("Main");
+  logger::Stats::setSpikeThresholdMs(SPIKE_THRESHOLD_MS);
   m_resources.m_deviceResources = std::make_unique<DX::DeviceResources>();
   m_resources.m_deviceResources->RegisterDeviceNotify(this);
 
@@ -64,12 +94,9 @@ Game::Game()
   setAudioPath(AudioResource::PlayerExplode, L"playerexplode.wav");
   setAudioPath(AudioResource::EnemyExplode, L"enemyexplode.wav");
 
-  const DirectX::SimpleMath::Vector3 PLAYER_START_POS(0.0f, -0.3f, 0.0f);
-  for (size_t i = PLAYERS_IDX; i < PLAYERS_END; ++i)
-  {
-    m_context.entities[i].isAlive  = true;
-    m_context.entities[i].position = PLAYER_START_POS;
-  }
+  const sim::Vec3 PLAYER_START_POS(0.0f, -0.3f, 0.0f);
+  m_context.entities.spawn(Partition::Players);
+  m_context.entities.setPosition(PLAYERS_IDX, PLAYER_START_POS);
 }
 
 //------------------------------------------------------------------------------
@@ -106,13 +133,10 @@ Game::initialize(HWND window, int width, int height)
     return;
   }
 
-  // TODO: Change the timer settings if you want something other than the
-  // default variable timestep mode. e.g. for 60 FPS fixed timestep update
-  // logic, call:
-  /*
-  m_timer.SetFixedTimeStep(true);
-  m_timer.SetTargetElapsedSeconds(1.0 / 60);
-  */
+  // Simulate at a fixed rate, independent of the display rate. Rendering
+  // interpolates between the last two updates.
+  m_resources.m_timer.SetFixedTimeStep(true);
+  m_resources.m_timer.SetTargetElapsedSeconds(sim::FIXED_STEP_SECONDS);
 
   m_appStates.changeState(&m_appStates.menu);
 }
@@ -124,6 +148,7 @@ Game::initialize(HWND window, int width, int height)
 void
 Game::tick()
 {
+  m_resources.frameArena.reset();
   {
     TRACE
     m_resources.m_timer.Tick([&]() { update(); });
@@ -150,6 +175,10 @@ Game::tick()
   m_resources.m_deviceResources->Present();
 
   logger::Stats::signalFrameEnd();
+  if (m_traceExporter)
+  {
+    m_traceExporter->submitLastFrame();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -178,11 +207,102 @@ Game::update()
         break;
     }
   }
+  if (m_resources.kbTracker.IsKeyPressed(DirectX::Keyboard::F5))
+  {
+    toggleInputRecording();
+  }
+  if (m_resources.kbTracker.IsKeyPressed(DirectX::Keyboard::F6))
+  {
+    toggleTraceCapture();
+  }
+  if (m_resources.kbTracker.IsKeyPressed(DirectX::Keyboard::F7))
+  {
+    toggleSpikeView();
+  }
   m_resources.audioEngine->Update();
 
+  const auto& starField        = m_resources.starField->sim();
+  const uint64_t starFieldTick = starField.numUpdates();
+
   const auto& currentState = m_appStates.currentState();
   currentState->handleInput(m_resources.m_timer);
   currentState->update(m_resources.m_timer);
+
+  m_resources.inputRecorder.endTick(starField.numUpdates() != starFieldTick);
+}
+
+//------------------------------------------------------------------------------
+void
+Game::toggleInputRecording()
+{
+  auto& recorder = m_resources.inputRecorder;
+  if (recorder.isRecording())
+  {
+    recorder.stop();
+    recorder.recording().save(sim::DEFAULT_INPUT_RECORDING_FILENAME);
+    LOG_INFO(
+      "Input recording saved to %s (%zu ticks)",
+      sim::DEFAULT_INPUT_RECORDING_FILENAME,
+      recorder.recording().ticks.size());
+  }
+  else if (recorder.isArmed())
+  {
+    recorder.stop();
+    LOG_INFO("Input recording cancelled");
+  }
+  else
+  {
+    recorder.arm();
+    LOG_INFO("Input recording starts with the next game");
+  }
+}
+
+//------------------------------------------------------------------------------
+// Streams profiler frames to trace files until toggled off, keeping the last
+// minute or so on disk
+//------------------------------------------------------------------------------
+void
+Game::toggleTraceCapture()
+{
+  if (m_traceExporter)
+  {
+    LOG_INFO(
+      "Trace capture stopped, %llu frames written (%llu dropped)",
+      static_cast<unsigned long long>(m_traceExporter->numWrittenFrames()),
+      static_cast<unsigned long long>(m_traceExporter->numDroppedFrames()));
+    m_traceExporter.reset();
+  }
+  else
+  {
+    m_traceExporter
+      = std::make_unique<logger::TraceExporter>(TRACE_CAPTURE_CONFIG);
+    LOG_INFO(
+      "Trace capture started, to %s.<n>.json", TRACE_CAPTURE_CONFIG.path);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Shows the captured spike in the flame graph, or releases it so the next
+// one can be captured
+//------------------------------------------------------------------------------
+void
+Game::toggleSpikeView()
+{
+  overriddenFlameHead = nullptr;
+  if (m_isShowingSpike)
+  {
+    m_isShowingSpike = false;
+    logger::Stats::releaseSpike();
+  }
+  else if (logger::Stats::getSpike())
+  {
+    m_isShowingSpike     = true;
+    m_context.profileViz = ProfileViz::FlameGraph;
+  }
+  else
+  {
+    LOG_INFO("No frame over %.2fms captured yet", SPIKE_THRESHOLD_MS);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -214,14 +334,22 @@ Game::render()
 void
 Game::drawBasicProfileInfo()
 {
-  ui::Text uiText;
+  using logger::Timing;
+  const auto frameTimes = logger::Stats::getFrameHistogram().percentiles();
+
+  auto& uiText    = m_uiProfileInfo;
   uiText.font     = m_resources.fontMono8pt.get();
   uiText.position = DirectX::SimpleMath::Vector2(0.0f, 0.0f);
   uiText.color    = DirectX::Colors::MediumVioletRed;
-  uiText.text     = fmt::format(
-    L"fps: {}, Time: {:.2f}ms",
+  uiText.format(
+    PROFILE_INFO_FORMAT,
     m_resources.m_timer.GetFramesPerSecond(),
-    m_resources.m_timer.GetElapsedSecondsSinceTickStarted() * 1000.0f);
+    m_resources.m_timer.GetElapsedSecondsSinceTickStarted() * 1000.0,
+    logger::Stats::getScopeOverheadMs() * 1e6,
+    Timing::ticksToMilliSeconds(frameTimes.p50),
+    Timing::ticksToMilliSeconds(frameTimes.p99),
+    Timing::ticksToMilliSeconds(frameTimes.p999),
+    logger::Stats::getNumSpikes());
 
   uiText.draw(*m_resources.m_spriteBatch);
 }
@@ -235,43 +363,52 @@ Game::drawProfilerList()
   const float yAscent
     = ceil(DirectX::XMVectorGetY(monoFont->MeasureString(L"X")));
   float yPos = yAscent;
-  ui::Text uiText;
-  uiText.font       = monoFont;
-  uiText.position.x = 0.0f;
-  uiText.color      = DirectX::Colors::MediumVioletRed;
 
-  auto drawText =
-    [&yAscent, &yPos, &uiText, &spriteBatch = m_resources.m_spriteBatch](
-      const wchar_t* fmt, auto&&... vars)
-  {
-    uiText.text       = fmt::format(fmt, vars...);
-    uiText.position.y = yPos;
-    yPos += yAscent;
-    uiText.draw(*spriteBatch);
-  };
+  using SortedRecord = logger::CollatedRecord;
+  auto& arena        = m_resources.frameArena;
 
-  auto singleFrame = logger::Stats::getCollatedFrameRecords(0);
-  std::vector<std::pair<size_t, logger::CollatedRecord>> sortedRecords;
-  for (const auto& rec : singleFrame)
-  {
-    sortedRecords.push_back(std::make_pair(rec.first, rec.second));
-  }
+  const auto& singleFrame = logger::Stats::getCollatedFrameRecords(0);
+  memory::ArenaVector<SortedRecord> sortedRecords(
+    singleFrame.begin(),
+    singleFrame.end(),
+    memory::ArenaAllocator<SortedRecord>(arena));
   std::sort(
     sortedRecords.begin(), sortedRecords.end(), [](auto& lhs, auto& rhs) {
-      return lhs.second.ticks > rhs.second.ticks;
+      return lhs.ticks > rhs.ticks;
     });
-  auto accumulatedRecords = logger::Stats::accumulateRecords();
+  auto accumulatedRecords = logger::Stats::accumulateRecords(arena);
 
-  for (auto& entry : sortedRecords)
+  // One retained line per record, so the list only allocates when it grows
+  if (m_uiProfilerList.size() < sortedRecords.size())
   {
-    auto& record      = entry.second;
-    auto& accumRecord = accumulatedRecords[entry.first];
-    drawText(
-      L"{:<35} ({:>2})h    ({:>5.4f} / {:<5.4f})ms",
-      strUtils::utf8ToWstring(record.function),
+    m_uiProfilerList.resize(sortedRecords.size());
+  }
+
+  strUtils::InlineWString<64> functionName;
+  for (size_t i = 0; i < sortedRecords.size(); ++i)
+  {
+    auto& record      = sortedRecords[i];
+    auto& accumRecord = accumulatedRecords[record.siteId];
+    const auto percentiles
+      = logger::Stats::getSiteHistogram(record.siteId).percentiles();
+    functionName.assignUtf8(logger::Stats::getSite(record.siteId).function);
+
+    auto& uiText    = m_uiProfilerList[i];
+    uiText.font     = monoFont;
+    uiText.position = DirectX::SimpleMath::Vector2(0.0f, yPos);
+    uiText.color    = DirectX::Colors::MediumVioletRed;
+    uiText.format(
+      PROFILER_LINE_FORMAT,
+      functionName.view(),
       accumRecord.callsCount.average(),
       logger::Timing::ticksToMilliSeconds(accumRecord.ticks.min),
-      logger::Timing::ticksToMilliSeconds(accumRecord.ticks.max));
+      logger::Timing::ticksToMilliSeconds(accumRecord.ticks.max),
+      logger::Timing::ticksToMilliSeconds(percentiles.p50),
+      logger::Timing::ticksToMilliSeconds(percentiles.p95),
+      logger::Timing::ticksToMilliSeconds(percentiles.p99),
+      logger::Timing::ticksToMilliSeconds(percentiles.p999));
+    uiText.draw(*m_resources.m_spriteBatch);
+    yPos += yAscent;
   }
 }
 
@@ -282,8 +419,9 @@ Game::updateControlsInfo(ui::Text& uiText)
   using DirectX::SimpleMath::Vector2;
   using DirectX::XMVECTOR;
 
-  uiText.text
-    = L"Profiler Mode(F1), Debug Draw(F2), Editor(F3), WASDR(Camera control)";
+  uiText.text = L"Profiler Mode(F1), Debug Draw(F2), Editor(F3), "
+                L"Record Input(F5), Capture Trace(F6), Spike(F7), "
+                L"WASDR(Camera control)";
   uiText.font     = m_resources.fontMono8pt.get();
   uiText.position = Vector2(m_context.screenHalfWidth, m_context.screenHeight);
   XMVECTOR dimensions = uiText.font->MeasureString(uiText.text.c_str());
@@ -299,7 +437,10 @@ Game::updateControlsInfo(ui::Text& uiText)
 //------------------------------------------------------------------------------
 template <typename Func>
 void
-visitFlameGraph(const logger::TimedRecord* head, Func visitFunc)
+visitFlameGraph(
+  const logger::Stats::FrameRecords& frame,
+  const logger::TimedRecord* head,
+  Func visitFunc)
 {
   using RecordQueue = std::queue<const logger::TimedRecord*>;
   ASSERT(head);
@@ -315,7 +456,7 @@ visitFlameGraph(const logger::TimedRecord* head, Func visitFunc)
     queue.pop();
     visitFunc(node, depth);
 
-    for (const auto c : node->childNodes)
+    for (auto c = frame.firstChild(*node); c; c = frame.nextSibling(*c))
     {
       nextDepthQueue.push(c);
     }
@@ -336,6 +477,36 @@ visitFlameGraph(const logger::TimedRecord* head, Func visitFunc)
   }
 }
 
+//------------------------------------------------------------------------------
+// The lane whose root the record is, or nullptr for a TRACE's record
+//------------------------------------------------------------------------------
+static const logger::Stats::Lane*
+findLane(
+  const logger::Stats::FrameRecords& frame, const logger::TimedRecord* record)
+{
+  for (size_t i = 0; i < frame.numLanes; ++i)
+  {
+    if (&frame.lanes[i].root == record)
+    {
+      return &frame.lanes[i];
+    }
+  }
+  return nullptr;
+}
+
+//------------------------------------------------------------------------------
+static const char*
+recordName(
+  const logger::Stats::FrameRecords& frame, const logger::TimedRecord* record)
+{
+  if (record->siteId != logger::TraceSite::NO_SITE)
+  {
+    return logger::Stats::getSite(record->siteId).function;
+  }
+  const logger::Stats::Lane* lane = findLane(frame, record);
+  return lane ? lane->name : "";
+}
+
 //------------------------------------------------------------------------------
 void
 Game::drawFlameGraph()
@@ -343,15 +514,54 @@ Game::drawFlameGraph()
   using DirectX::SimpleMath::Vector2;
   using DirectX::SimpleMath::Vector3;
 
-  auto& currentSnapShot           = logger::Stats::getFrameRecords(0);
-  const logger::TimedRecord* head = (overriddenFlameHead == nullptr)
-                                      ? currentSnapShot.callGraphHead
-                                      : overriddenFlameHead;
-  if (!head)
+  // A lane per thread, side by side on the same time scale, or just the
+  // subtree that was clicked on. Of the captured spike while F7 shows it.
+  using LaneHeads
+    = std::array<const logger::TimedRecord*, logger::Stats::MAX_THREAD_COUNT>;
+  const logger::Stats::Spike* spike = logger::Stats::getSpike();
+  if (m_isShowingSpike && !spike)
+  {
+    m_isShowingSpike    = false;
+    overriddenFlameHead = nullptr;
+  }
+  const auto& currentSnapShot
+    = m_isShowingSpike ? spike->frame : logger::Stats::getFrameRecords(0);
+  LaneHeads heads;
+  size_t numLanes = 0;
+  if (overriddenFlameHead)
+  {
+    heads[numLanes++] = overriddenFlameHead;
+  }
+  else
+  {
+    for (size_t i = 0; i < currentSnapShot.numLanes; ++i)
+    {
+      heads[numLanes++] = &currentSnapShot.lanes[i].root;
+    }
+  }
+  if (numLanes == 0)
   {
     return;
   }
 
+  // Each lane is as wide as its graph is deep
+  std::array<int, logger::Stats::MAX_THREAD_COUNT> laneColumns;
+  int numColumns         = 0;
+  logger::Ticks baseTick = std::numeric_limits<logger::Ticks>::max();
+  logger::Ticks endTick  = 0;
+  for (size_t i = 0; i < numLanes; ++i)
+  {
+    int maxDepth = 0;
+    visitFlameGraph(
+      currentSnapShot, heads[i], [&](const logger::TimedRecord*, int depth) {
+        maxDepth = std::max(maxDepth, depth);
+      });
+    laneColumns[i] = maxDepth + 1;
+    numColumns += laneColumns[i];
+    baseTick = std::min(baseTick, heads[i]->startTime);
+    endTick  = std::max(endTick, heads[i]->startTime + heads[i]->duration);
+  }
+
   auto mouseState                        = m_resources.m_mouse->GetState();
   bool isDrawToolTip                     = false;
   const logger::TimedRecord* toolTipNode = nullptr;
@@ -359,13 +569,14 @@ Game::drawFlameGraph()
   auto monoFont = m_resources.fontMono8pt.get();
   const float yAscent
     = ceil(DirectX::XMVectorGetY(monoFont->MeasureString(L"X")));
-  const float xStartPos = 0.0f;
-  const float xWidth    = ceil(m_context.screenWidth / 7.0f);
+  const float xWidth = std::min(
+    ceil(m_context.screenWidth / 7.0f),
+    floor(m_context.screenWidth / numColumns));
   const float yStartPos = yAscent;
   const float yRange    = m_context.screenHeight - (2 * yAscent);
-
-  const logger::Ticks baseTick = head->startTime;
-  const float ticksToYPos      = yRange / head->duration;
+  const float ticksToYPos
+    = yRange / std::max<logger::Ticks>(endTick - baseTick, 1);
+  float xStartPos = 0.0f;
 
   ui::Text uiText;
   uiText.font   = monoFont;
@@ -406,13 +617,35 @@ Game::drawFlameGraph()
       toolTipNode   = node;
     }
 
-    uiText.text = strUtils::utf8ToWstring(node->function);
+    uiText.text = strUtils::utf8ToWstring(recordName(currentSnapShot, node));
+    if (const logger::Stats::Lane* lane = findLane(currentSnapShot, node))
+    {
+      uiText.text += fmt::format(L" {}", lane->threadIdx);
+    }
     uiText.position = Vector2(ceil(xPos + 5.0f), ceil(yPos + yHalfHeight));
     uiText.draw(*m_resources.m_spriteBatch);
   };
 
   // Draw the Graph
-  visitFlameGraph(head, drawFunc);
+  for (size_t i = 0; i < numLanes; ++i)
+  {
+    visitFlameGraph(currentSnapShot, heads[i], drawFunc);
+    xStartPos += laneColumns[i] * xWidth;
+  }
+
+  if (m_isShowingSpike)
+  {
+    auto& spikeText = m_uiSpikeInfo;
+    spikeText.font  = monoFont;
+    spikeText.color = DirectX::Colors::OrangeRed;
+    spikeText.format(
+      SPIKE_INFO_FORMAT,
+      spike->frameNumber,
+      logger::Timing::ticksToMilliSeconds(currentSnapShot.duration));
+    spikeText.position = Vector2(m_context.screenWidth, 0.0f);
+    spikeText.origin   = Vector2(spikeText.size().x, 0.0f);
+    spikeText.draw(*m_resources.m_spriteBatch);
+  }
 
   // Draw Tooltip
   if (isDrawToolTip)
@@ -430,7 +663,7 @@ Game::drawFlameGraph()
 
     uiText.text = fmt::format(
       L"{}({:<5.4f}ms)",
-      strUtils::utf8ToWstring(toolTipNode->function),
+      strUtils::utf8ToWstring(recordName(currentSnapShot, toolTipNode)),
       logger::Timing::ticksToMilliSeconds(toolTipNode->duration));
     uiText.position = Vector2(
       mouseState.x + (TOOLTIP_HEIGHT / 2.0f),
@@ -580,34 +813,27 @@ Game::createDeviceDependentResources()
 
     m_resources.m_spriteBatch = std::make_unique<DirectX::SpriteBatch>(context);
 
-    m_resources.starTexture.CreateFromFile(device, L"assets/star.dds");
-    m_resources.explosionTexture.CreateFromFile(
-      device, L"assets/explosion.dds");
-    m_resources.shotTexture.CreateFromFile(device, L"assets/explosion.dds");
+    // Sprites and fonts all draw from the atlas, so batches only break when
+    // the render states change
+    m_resources.atlas.load(device, L"assets/atlas.dds", "assets/atlas.json");
 
-    m_resources.starField
-      = std::make_unique<StarField>(m_context, m_resources.starTexture);
-    m_resources.explosions
-      = std::make_unique<Explosions>(m_context, m_resources.explosionTexture);
+    m_resources.starField = std::make_unique<StarField>(
+      m_context, m_resources.atlas, m_resources.randDevice());
+    m_resources.explosions = std::make_unique<Explosions>(
+      m_context, m_resources.atlas, m_resources.randDevice());
 
     m_resources.menuManager = std::make_unique<MenuManager>(m_context);
     m_resources.scoreBoard
       = std::make_unique<ScoreBoard>(m_context, m_resources);
     m_resources.scoreBoard->loadFromFile();
 
-    m_resources.font8pt = std::make_unique<DirectX::SpriteFont>(
-      device, L"assets/verdana8.spritefont");
-    m_resources.font16pt = std::make_unique<DirectX::SpriteFont>(
-      device, L"assets/verdana16.spritefont");
-    m_resources.font32pt = std::make_unique<DirectX::SpriteFont>(
-      device, L"assets/verdana32.spritefont");
+    m_resources.font8pt  = m_resources.atlas.createFont("verdana8");
+    m_resources.font16pt = m_resources.atlas.createFont("verdana16");
+    m_resources.font32pt = m_resources.atlas.createFont("verdana32");
 
-    m_resources.fontMono8pt = std::make_unique<DirectX::SpriteFont>(
-      device, L"assets/mono8.spritefont");
-    m_resources.fontMono16pt = std::make_unique<DirectX::SpriteFont>(
-      device, L"assets/mono16.spritefont");
-    m_resources.fontMono32pt = std::make_unique<DirectX::SpriteFont>(
-      device, L"assets/mono32.spritefont");
+    m_resources.fontMono8pt  = m_resources.atlas.createFont("mono8");
+    m_resources.fontMono16pt = m_resources.atlas.createFont("mono16");
+    m_resources.fontMono32pt = m_resources.atlas.createFont("mono32");
 
     m_resources.m_batch = std::make_unique<DX::DebugBatchType>(context);
     {
@@ -644,6 +870,7 @@ Game::createDeviceDependentResources()
         DirectX::BoundingSphere::CreateMerged(
           data.bound, mesh->boundingSphere, data.bound);
       }
+      m_context.modelBound(res.first) = toBoundingSphere(data.bound);
     }
 
     // Load the audio effects
@@ -660,24 +887,6 @@ Game::createDeviceDependentResources()
     return E_FAIL;
   }
 
-  // TODO(James): Critical these are not null for any entity. <NOT_NULLABLE>?
-  for (size_t i = PLAYERS_IDX; i < PLAYERS_END; ++i)
-  {
-    m_context.entities[i].model = &m_resources.modelData[ModelResource::Player];
-  }
-  for (size_t i = PLAYER_SHOTS_IDX; i < PLAYER_SHOTS_END; ++i)
-  {
-    m_context.entities[i].model = &m_resources.modelData[ModelResource::Shot];
-  }
-  for (size_t i = ENEMY_SHOTS_IDX; i < ENEMY_SHOTS_END; ++i)
-  {
-    m_context.entities[i].model = &m_resources.modelData[ModelResource::Shot];
-  }
-  for (size_t i = ENEMIES_IDX; i < ENEMIES_END; ++i)
-  {
-    m_context.entities[i].model = &m_resources.modelData[ModelResource::Enemy1];
-  }
-
   return S_OK;
 }
 
@@ -757,9 +966,7 @@ Game::OnDeviceLost()
 
   m_resources.m_batch.reset();
   m_resources.m_spriteBatch.reset();
-  m_resources.shotTexture.texture.Reset();
-  m_resources.explosionTexture.texture.Reset();
-  m_resources.starTexture.texture.Reset();
+  m_resources.atlas.reset();
   m_resources.m_states.reset();
 }
 
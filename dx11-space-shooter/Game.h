@@ -8,6 +8,7 @@
 namespace logger
 {
 struct TimedRecord;
+class TraceExporter;
 }
 
 //------------------------------------------------------------------------------
@@ -42,6 +43,9 @@ public:
 
 private:
   void update();
+  void toggleInputRecording();
+  void toggleTraceCapture();
+  void toggleSpikeView();
   void render();
   void drawBasicProfileInfo();
   void drawProfilerList();
@@ -58,6 +62,12 @@ private:
   AppStates m_appStates;
 
   const logger::TimedRecord* overriddenFlameHead = nullptr;
+  std::unique_ptr<logger::TraceExporter> m_traceExporter;    // F6
+  bool m_isShowingSpike = false;                             // F7
+
+  ui::FormattedText<128> m_uiProfileInfo;
+  std::vector<ui::FormattedText<160>> m_uiProfilerList;
+  ui::FormattedText<96> m_uiSpikeInfo;
 };
 
 //------------------------------------------------------------------------------
@@ -4,26 +4,35 @@
 #include "AppResources.h"
 #include "StepTimer.h"
 #include "Entity.h"
+#include "Render/SceneRecording.h"
 
 #include "utils/Log.h"
 
+#include <algorithm>
+
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
 
 //------------------------------------------------------------------------------
-constexpr float PLAYER_DEATH_TIME_S      = 1.0f;
-constexpr float PLAYER_REVIVE_TIME_S     = 2.0f;
-static const Vector3 PLAYER_MAX_POSITION = {36.0f, 18.0f, 0.0f};
-static const Vector3 PLAYER_START_POS(0.0f, -PLAYER_MAX_POSITION.y, 0.0f);
-static const Vector3 SHOT_MAX_POSITION = {60.0f, 40.0f, 0.0f};
-
-constexpr int POINTS_PER_KILL = 1000;
+static const auto SCORE_FORMAT = fmt::compile<int>(FMT_STRING(L"Score: {}"));
+static const auto LIVES_FORMAT = fmt::compile<int>(FMT_STRING(L"Lives: {}"));
+static const auto CAMERA_DIST_FORMAT
+  = fmt::compile<float>(FMT_STRING(L"Camera Dist: {}"));
+static const auto PLAYER_SPEED_FORMAT
+  = fmt::compile<float>(FMT_STRING(L"Player Speed: {}"));
+static const auto PLAYER_FRICTION_FORMAT
+  = fmt::compile<float>(FMT_STRING(L"Player Friction: {}"));
+static const auto PLAYER_MAX_VELOCITY_FORMAT
+  = fmt::compile<float>(FMT_STRING(L"Player Max Velocity: {}"));
+static const auto PLAYER_MIN_VELOCITY_FORMAT
+  = fmt::compile<float>(FMT_STRING(L"Player Min Velocity: {}"));
 
 //------------------------------------------------------------------------------
 GameLogic::GameLogic(AppContext& context, AppResources& resources)
     : m_context(context)
     , m_resources(resources)
-    , m_enemies(context, resources)
+    , m_sim(context, m_simClock, resources.randEngine, *this, resources.jobs)
+    , m_enemies(m_sim.m_enemies)
 {
   TRACE
 }
@@ -33,21 +42,8 @@ void
 GameLogic::reset()
 {
   TRACE
+  m_sim.reset();
 
-  for (size_t i = PLAYER_SHOTS_IDX; i < ENEMIES_IDX; ++i)
-  {
-    m_context.entities[i].isAlive     = false;
-    m_context.entities[i].isColliding = false;
-  }
-  m_enemies.reset();
-
-  auto& player       = m_context.entities[PLAYERS_IDX];
-  player.isAlive     = true;
-  player.isColliding = false;
-  player.position    = PLAYER_START_POS;
-  player.velocity    = Vector3();
-
-  m_context.resetPlayer();
   m_context.resetCamera();
   m_resources.explosions->reset();
 
@@ -58,50 +54,52 @@ GameLogic::reset()
 
 //------------------------------------------------------------------------------
 GameLogic::GameStatus
-GameLogic::update(const DX::StepTimer& timer)
+GameLogic::update(
+  const DX::StepTimer& timer, sim::JobSystem::Dependencies eventDependencies)
 {
-  UNREFERENCED_PARAMETER(timer);
-
   TRACE
-  float elapsedTimeS = float(timer.GetElapsedSeconds());
+  m_lastUpdateFrame = timer.GetFrameCount();
+  return m_sim.update(advanceSimClock(timer), eventDependencies);
+}
 
-  m_enemies.update(timer);
-  performPhysicsUpdate(timer);
+//------------------------------------------------------------------------------
+const sim::FixedStepClock&
+GameLogic::advanceSimClock(const DX::StepTimer& timer)
+{
+  m_simClock.setStepSeconds(timer.GetElapsedSeconds());
+  m_simClock.tick();
+  return m_simClock;
+}
 
-  switch (m_context.playerState)
+//------------------------------------------------------------------------------
+void
+GameLogic::onSimEvent(SimEvent event, const sim::Vec3& position)
+{
+  switch (event)
   {
-    case PlayerState::Normal:
-      performCollisionTests();
+    case SimEvent::PlayerShot:
+      m_resources.soundEffects[AudioResource::PlayerShot]->Play();
       break;
 
-    case PlayerState::Dying:
-      if ((m_context.playerDeathTimerS -= elapsedTimeS) <= 0.0f)
-      {
-        if (--m_context.playerLives > -1)
-        {
-          LOG_VERBOSE("playerState: Dying->Reviving");
-          m_context.playerState        = PlayerState::Reviving;
-          m_context.playerReviveTimerS = PLAYER_REVIVE_TIME_S;
-          m_hudDirty                   = true;
-        }
-        else
-        {
-          return GameStatus::GameOver;
-        }
-      }
+    case SimEvent::EnemyShot:
+      m_resources.soundEffects[AudioResource::EnemyShot]->Play();
       break;
 
-    case PlayerState::Reviving:
-      if ((m_context.playerReviveTimerS -= elapsedTimeS) <= 0.0f)
-      {
-        LOG_VERBOSE("playerState: Reviving->Normal");
-        m_context.playerState = PlayerState::Normal;
-      }
-      performCollisionTests();
+    case SimEvent::PlayerExploded:
+      m_resources.explosions->emit(toVector3(position), Vector3());
+      m_resources.soundEffects[AudioResource::PlayerExplode]->Play();
       break;
-  }
 
-  return GameStatus::Playing;
+    case SimEvent::EnemyExploded:
+      m_resources.explosions->emit(toVector3(position), Vector3());
+      m_resources.soundEffects[AudioResource::EnemyExplode]->Play();
+      break;
+
+    case SimEvent::ScoreChanged:
+    case SimEvent::LivesChanged:
+      m_hudDirty = true;
+      break;
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -109,15 +107,22 @@ void
 GameLogic::render()
 {
   TRACE
-  renderEntityModels();
-
-  auto& states      = *m_resources.m_states;
-  auto& spriteBatch = m_resources.m_spriteBatch;
-
-  spriteBatch->Begin(SpriteSortMode_Deferred, states.Additive());
-  renderShotParticles();
-  m_resources.explosions->render(*spriteBatch);
-  spriteBatch->End();
+  // Only interpolate while the sim is running. When paused (or another state
+  // owns the update) the entities are drawn where they are.
+  const auto& timer = m_resources.m_timer;
+  m_renderAlpha     = (timer.GetFrameCount() == m_lastUpdateFrame)
+                    ? static_cast<float>(timer.GetInterpolationAlpha())
+                    : 1.0f;
+
+  auto& commands = beginCommands();
+  recordEntityModels(commands);
+  recordShotParticles(commands);
+  m_resources.explosions->record(commands);
+  if (m_context.debugDraw)
+  {
+    recordEntityBounds(commands);
+  }
+  m_resources.renderBackend.execute(commands);
 
   DX::DrawContext drawContext(m_context, m_resources);
   drawContext.begin(DX::DrawContext::Projection::Screen);
@@ -137,417 +142,117 @@ GameLogic::render()
 }
 
 //------------------------------------------------------------------------------
-void
-GameLogic::renderEntityModels()
-{
-  TRACE
-  size_t idx = 0;
-  for (auto& entity : m_context.entities)
-  {
-    if (PLAYERS_IDX == idx)
-    {
-      renderPlayerEntity(entity);
-    }
-    else if (entity.isAlive)
-    {
-      renderEntityModel(entity);
-    }
-    ++idx;
-  }
-}
-
-//------------------------------------------------------------------------------
-void
-GameLogic::renderShotParticles()
-{
-  TRACE
-  auto& spriteBatch = *m_resources.m_spriteBatch;
-  auto& texture     = m_resources.shotTexture;
-
-  // Hack to allow using SpriteBatch with world space objects.
-  // SpriteBatch requires everything in x-right y-down screen PIXEL coordinates
-  // and does it's own orthographic projection internally.
-  // See SpriteBatch::Impl::GetViewportTransform()
-  Matrix worldToScreen = m_context.worldToView * m_context.viewToProjection
-                         * m_context.projectionToPixels;
-
-  static const XMVECTOR outerScale = {1.0f, 1.0f, 1.0f, 1.0f};
-  static const XMVECTOR coreScale  = {0.5f, 0.5f, 0.5f, 0.5f};
-  for (size_t idx = PLAYER_SHOTS_IDX; idx < ENEMY_SHOTS_END; ++idx)
-  {
-    auto& shot = m_context.entities[idx];
-    if (!shot.isAlive)
-    {
-      continue;
-    }
-
-    const float aliveS = static_cast<float>(
-      m_resources.m_timer.GetTotalSeconds() - shot.birthTimeS);
-    static const float SATURATION_DECAY = 1.2f;
-    float saturation
-      = 1.0f - std::clamp((aliveS * SATURATION_DECAY), 0.0f, 1.0f);
-    Vector4 color(Colors::OrangeRed);
-    color.x += saturation;
-    color.y += saturation;
-    color.z += saturation;
-
-    Vector4 coreColor(Colors::Yellow);
-    coreColor.x += saturation;
-    coreColor.y += saturation;
-    coreColor.z += saturation;
-
-    auto pos = Vector3::Transform(shot.position, worldToScreen);
-    spriteBatch.Draw(
-      texture.texture.Get(),
-      XMLoadFloat3(&pos),
-      nullptr,
-      color,
-      0.f,
-      texture.origin,
-      outerScale * (1.0f + 2.0f * saturation),
-      SpriteEffects_None,
-      0.f);
-
-    spriteBatch.Draw(
-      texture.texture.Get(),
-      XMLoadFloat3(&pos),
-      nullptr,
-      coreColor,
-      0.f,
-      texture.origin,
-      coreScale * (1.0f + 2.0f * saturation),
-      SpriteEffects_None,
-      0.f);
-  }
-}
-
-//------------------------------------------------------------------------------
-void
-GameLogic::renderEntitiesDebug()
+render::CommandList&
+GameLogic::beginCommands()
 {
-  TRACE
-  for (auto& entity : m_context.entities)
-  {
-    if (entity.isAlive)
-    {
-      renderEntityBound(entity);
-    }
-  }
-  m_enemies.debugRender(m_resources.m_batch.get());
-  renderPlayerBoundary();
+  auto& commands = m_resources.renderCommands;
+  commands.clear();
+  commands.setCamera(
+    toMatrix4(m_context.worldToView), toMatrix4(m_context.viewToProjection));
+  return commands;
 }
 
 //------------------------------------------------------------------------------
 void
-GameLogic::performPhysicsUpdate(const DX::StepTimer& timer)
+GameLogic::recordEntityModels(render::CommandList& commands)
 {
-  TRACE
-  float elapsedTimeS = float(timer.GetElapsedSeconds());
-
-  // Player input forces
-  auto& player = m_context.entities[PLAYERS_IDX];
-  m_context.playerAccel *= m_context.playerSpeed;
-
-  Vector3 frictionNormal = -player.velocity;
-  frictionNormal.Normalize();
-  m_context.playerAccel += m_context.playerFriction * frictionNormal;
-
-  // Ballistic entities
-  for (size_t i = BALLISTIC_IDX; i < BALLISTIC_END; ++i)
-  {
-    const bool isPlayer = (i < PLAYERS_END);
-    auto& e             = m_context.entities[i];
-
-    // Integrate Position
-    const Vector3& accel = (isPlayer) ? m_context.playerAccel : Vector3();
-
-    e.position = 0.5f * accel * (elapsedTimeS * elapsedTimeS)
-                 + e.velocity * elapsedTimeS + e.position;
-    e.velocity = accel * elapsedTimeS + e.velocity;
-
-    if (isPlayer)
-    {
-      constrainPlayer(e);
-    }
-    else
-    {
-      constrainShot(e);
-    }
-  }
+  render::recordEntityModels(commands, m_context, m_renderAlpha);
 }
 
 //------------------------------------------------------------------------------
 void
-GameLogic::constrainPlayer(Entity& e)
+GameLogic::recordShotParticles(render::CommandList& commands)
 {
-  TRACE
-  auto slide = [& incident = e.velocity](Vector3 normal)
-  {
-    return incident - 1.0f * incident.Dot(normal) * normal;
-  };
-
-  // Limit position
-  if (e.position.x < -PLAYER_MAX_POSITION.x)
-  {
-    e.position.x = -PLAYER_MAX_POSITION.x;
-    e.velocity   = slide(Vector3(1.0f, 0.0f, 0.0f));
-  }
-  else if (e.position.x > PLAYER_MAX_POSITION.x)
-  {
-    e.position.x = PLAYER_MAX_POSITION.x;
-    e.velocity   = slide(Vector3(-1.0f, 0.0f, 0.0f));
-  }
-  if (e.position.y < -PLAYER_MAX_POSITION.y)
-  {
-    e.position.y = -PLAYER_MAX_POSITION.y;
-    e.velocity   = slide(Vector3(0.0f, 1.0f, 0.0f));
-  }
-  else if (e.position.y > PLAYER_MAX_POSITION.y)
-  {
-    e.position.y = PLAYER_MAX_POSITION.y;
-    e.velocity   = slide(Vector3(0.0f, -1.0f, 0.0f));
-  }
-
-  // Clamp velocity
-  float velocityMagnitude = e.velocity.Length();
-  if (velocityMagnitude > m_context.playerMaxVelocity)
-  {
-    e.velocity.Normalize();
-    e.velocity *= m_context.playerMaxVelocity;
-  }
-  else if (velocityMagnitude < m_context.playerMinVelocity)
-  {
-    e.velocity = Vector3();
-  }
+  render::recordShotParticles(
+    commands,
+    m_context,
+    m_renderAlpha,
+    m_simClock.GetTotalSeconds(),
+    toMatrix4(m_context.worldToPixels),
+    m_resources.atlas.spriteRef("explosion"),
+    m_resources.frameArena);
 }
 
 //------------------------------------------------------------------------------
 void
-GameLogic::constrainShot(Entity& e)
+GameLogic::recordEntityBounds(render::CommandList& commands)
 {
   TRACE
+  const auto& entities = m_context.entities;
 
-  if (!e.isAlive)
+  // Every bound in one pre-transformed line list
+  size_t numBounds = 0;
+  for (size_t p = 0; p < EntityStore::NUM_PARTITIONS; ++p)
   {
-    return;
+    numBounds += entities.numAlive(static_cast<Partition>(p));
   }
+  const size_t numVertices = numBounds * DX::LINE_LIST_SPHERE_SIZE;
+  auto* vertices           = reinterpret_cast<VertexPositionColor*>(
+    commands.drawLines(numVertices));
 
-  if (
-    (e.position.y < -SHOT_MAX_POSITION.y)
-    || (e.position.y > SHOT_MAX_POSITION.y)
-    || (e.position.x < -SHOT_MAX_POSITION.x)
-    || (e.position.x > SHOT_MAX_POSITION.x))
+  VertexPositionColor* out = vertices;
+  for (size_t p = 0; p < EntityStore::NUM_PARTITIONS; ++p)
   {
-    e.isAlive = false;
+    for (size_t idx : entities.alive(static_cast<Partition>(p)))
+    {
+      out = writeEntityBound(out, idx);
+    }
   }
+  ASSERT(out == vertices + numVertices);
 }
 
 //------------------------------------------------------------------------------
 void
-GameLogic::performCollisionTests()
+GameLogic::renderEntitiesDebug()
 {
   TRACE
-  for (size_t i = 0; i < NUM_ENTITIES; ++i)
-  {
-    m_context.entities[i].isColliding = false;
-  }
-
-  auto& player = m_context.entities[PLAYERS_IDX];
-
-  auto onPlayerShotHitsEnemy =
-    [	&score				= m_context.playerScore,
-      &explosions		= m_resources.explosions,
-      &soundEffects	= m_resources.soundEffects,
-      &m_hudDirty		= this->m_hudDirty
-    ](Entity& shot, Entity& testEntity)
-  {
-    auto pos = shot.position + shot.model->bound.Center;
-    explosions->emit(pos, Vector3());
-    soundEffects[AudioResource::EnemyExplode]->Play();
-
-    shot.isColliding       = true;
-    testEntity.isColliding = true;
-    shot.isAlive           = false;
-    testEntity.isAlive     = false;
-    score += POINTS_PER_KILL;
-    m_hudDirty = true;
-  };
-
-  auto onPlayerHit =
-    [	&context			= m_context,
-      &explosions		= m_resources.explosions,
-      &soundEffects	= m_resources.soundEffects
-    ](Entity & player, Entity & enemy)
-  {
-    auto pos = player.position + player.model->bound.Center;
-    explosions->emit(pos, Vector3());
-    soundEffects[AudioResource::PlayerExplode]->Play();
-
-    pos = enemy.position + enemy.model->bound.Center;
-    explosions->emit(pos, Vector3());
-    soundEffects[AudioResource::EnemyExplode]->Play();
-
-    player.isColliding = true;
-    enemy.isColliding  = true;
-
-    enemy.isAlive = false;
-    LOG_VERBOSE("playerState: Normal->Dying");
-    context.playerState       = PlayerState::Dying;
-    context.playerDeathTimerS = PLAYER_DEATH_TIME_S;
-  };
-
-  // Pass 1 - PlayerShots		-> Enemies
-  for (size_t srcIdx = PLAYER_SHOTS_IDX; srcIdx < PLAYER_SHOTS_END; ++srcIdx)
-  {
-    auto& srcEntity = m_context.entities[srcIdx];
-    collisionTestEntity(
-      srcEntity, ENEMIES_IDX, ENEMIES_END, onPlayerShotHitsEnemy);
-  }
-
-  // Player is invulnerable, no more collision tests
-  if (m_context.playerState == PlayerState::Reviving)
-  {
-    return;
-  }
-
-  // Pass 2 - Player				-> Enemies
-  collisionTestEntity(player, ENEMIES_IDX, ENEMIES_END, onPlayerHit);
-
-  // Pass 3 - Player				-> EnemyShots
-  collisionTestEntity(player, ENEMY_SHOTS_IDX, ENEMY_SHOTS_END, onPlayerHit);
+  renderEnemyPaths();
+  renderPlayerBoundary();
 }
 
 //------------------------------------------------------------------------------
-template <typename Func>
 void
-GameLogic::collisionTestEntity(
-  Entity& entity,
-  const size_t rangeStartIdx,
-  const size_t rangeOnePastEndIdx,
-  Func& onCollision)
+GameLogic::renderEnemyPaths()
 {
-  if (!entity.isAlive)
-  {
-    return;
-  }
   TRACE
-
-  // TODO(James): Use the GCL <notnullable> to compile time enforce assertion
-  ASSERT(entity.model);
-  auto& srcBound = entity.model->bound;
-  auto srcCenter = entity.position + srcBound.Center;
-
-  for (size_t testIdx = rangeStartIdx; testIdx < rangeOnePastEndIdx; ++testIdx)
+  const auto& pathPool = m_enemies.m_pathPool;
+  const auto& entities = m_context.entities;
+
+  // Each path once, in index order
+  memory::ArenaVector<size_t> pathsToRender{
+    memory::ArenaAllocator<size_t>(m_resources.frameArena)};
+  pathsToRender.reserve(entities.numAlive(Partition::Enemies));
+  for (size_t i : entities.alive(Partition::Enemies))
   {
-    ASSERT(m_context.entities[testIdx].model);
-    auto& testEntity = m_context.entities[testIdx];
-    if (!testEntity.isAlive)
-    {
-      continue;
-    }
-
-    auto& testBound = testEntity.model->bound;
-    auto testCenter = testEntity.position + testBound.Center;
-
-    auto distance = (srcCenter - testCenter).Length();
-    if (distance <= (srcBound.Radius + testBound.Radius))
+    if (entities.pathIdx[i] < pathPool.size())
     {
-      onCollision(entity, testEntity);
+      pathsToRender.push_back(entities.pathIdx[i]);
     }
   }
-}
+  std::sort(pathsToRender.begin(), pathsToRender.end());
+  pathsToRender.erase(
+    std::unique(pathsToRender.begin(), pathsToRender.end()),
+    pathsToRender.end());
 
-//------------------------------------------------------------------------------
-
-//------------------------------------------------------------------------------
-void
-GameLogic::renderPlayerEntity(Entity& entity)
-{
-  TRACE
-  switch (m_context.playerState)
+  for (const auto& pathIdx : pathsToRender)
   {
-    case PlayerState::Normal:
-      renderEntityModel(entity, XM_PI);
-      break;
-
-    case PlayerState::Dying:
-      // TODO(James): Render Player Death
-      break;
-
-    case PlayerState::Reviving:
-      // Flash the player every half second
-      if (
-        static_cast<int>(m_context.playerReviveTimerS * PLAYER_REVIVE_TIME_S)
-          % 2
-        != 0)
-      {
-        renderEntityModel(entity, XM_PI);
-      }
-      break;
+    ASSERT(pathIdx < pathPool.size());
+    m_resources.pathDebugCache.draw(
+      m_resources.m_batch.get(), pathPool[pathIdx]);
   }
 }
 
 //------------------------------------------------------------------------------
-void
-GameLogic::renderEntityModel(Entity& entity, float orientation)
+VertexPositionColor*
+GameLogic::writeEntityBound(VertexPositionColor* out, size_t entityIdx) const
 {
-  TRACE
-  // TODO(James): Use <notnullable> to enforce assertion
-  ASSERT(entity.model);
-  const auto& modelData   = entity.model;
-  const auto& boundCenter = entity.model->bound.Center;
-
-  Matrix world = Matrix::CreateTranslation(boundCenter).Invert()
-                 * Matrix::CreateFromYawPitchRoll(0.0f, 0.0f, orientation)
-                 * Matrix::CreateTranslation(entity.position + boundCenter);
-
-  modelData->model->Draw(
-    m_resources.m_deviceResources->GetD3DDeviceContext(),
-    *m_resources.m_states,
-    world,
-    m_context.worldToView,
-    m_context.viewToProjection);
-
-#if 0
-  // DEBUG BOUND
-  Matrix boundWorld = Matrix::CreateTranslation(entity.position + boundCenter);
-  boundWorld.m[0][0] *= modelData->bound.Radius;
-  boundWorld.m[1][1] *= modelData->bound.Radius;
-  boundWorld.m[2][2] *= modelData->bound.Radius;
-
-  Vector4 color = entity.isColliding ? Vector4(1.0f, 0.0f, 0.0f, 0.4f)
-    : Vector4(0.0f, 1.0f, 0.0f, 0.4f);
-  m_debugBoundEffect->SetColorAndAlpha(color);
-
-  m_debugBoundEffect->SetView(worldToView);
-  m_debugBoundEffect->SetProjection(viewToProjection);
-  m_debugBoundEffect->SetWorld(boundWorld);
-  m_debugBoundEffect->Apply(context);
-
-  context->OMSetBlendState(m_states->AlphaBlend(), Colors::White, 0xFFFFFFFF);
-  context->OMSetDepthStencilState(m_states->DepthDefault(), 0);
-  context->RSSetState(m_states->CullNone());
-
-  m_debugBound->Draw(
-    m_debugBoundEffect.get(), m_debugBoundInputLayout.Get(), true, true);
-#endif
-}
-
-//------------------------------------------------------------------------------
-void
-GameLogic::renderEntityBound(Entity& entity)
-{
-  TRACE
-  // TODO(James): Use <notnullable> to enforce assertion
-  ASSERT(entity.model);
-  // const auto& modelData = entity.model;
-
-  auto bound   = entity.model->bound;
-  bound.Center = bound.Center + entity.position;
-  DX::Draw(
-    m_resources.m_batch.get(),
+  const auto& entities = m_context.entities;
+  auto bound           = m_resources.modelData[entities.model[entityIdx]].bound;
+  bound.Center = bound.Center + toVector3(renderPosition(entityIdx));
+  return DX::WriteSphere(
+    out,
     bound,
-    (entity.isColliding) ? Colors::Red : Colors::Lime);
+    (entities.isColliding(entityIdx)) ? Colors::Red : Colors::Lime);
 
   // Matrix world = Matrix::CreateTranslation(entity.position + boundCenter);
   // world.m[0][0] *= modelData->bound.Radius;
@@ -570,10 +275,11 @@ GameLogic::renderPlayerBoundary()
 {
   TRACE
 
-  auto& player       = m_context.entities[PLAYERS_IDX];
-  const float xLimit = PLAYER_MAX_POSITION.x + player.model->bound.Radius;
-  const float yLimit = PLAYER_MAX_POSITION.y + player.model->bound.Radius;
-  const float zPlane = PLAYER_MAX_POSITION.z;
+  const auto& maxPosition = GameSim::PLAYER_MAX_POSITION;
+  const float radius      = m_context.bound(PLAYERS_IDX).Radius;
+  const float xLimit      = maxPosition.x + radius;
+  const float yLimit      = maxPosition.y + radius;
+  const float zPlane      = maxPosition.z;
 
   DX::DrawLine(
     m_resources.m_batch.get(),
@@ -596,19 +302,25 @@ GameLogic::renderPlayerBoundary()
     Vector3(xLimit, yLimit, zPlane));
 }
 
+//------------------------------------------------------------------------------
+sim::Vec3
+GameLogic::renderPosition(size_t entityIdx) const
+{
+  return m_context.entities.interpolatedPosition(entityIdx, m_renderAlpha);
+}
+
 //------------------------------------------------------------------------------
 void
 GameLogic::updateUIScore()
 {
   TRACE
-  auto& score         = m_context.uiScore;
-  score.font          = m_resources.font32pt.get();
-  score.text          = fmt::format(L"Score: {}", m_context.playerScore);
-  XMVECTOR dimensions = score.font->MeasureString(score.text.c_str());
-  score.origin        = Vector2((XMVectorGetX(dimensions) / 2.f), 0.0f);
-  score.position.x    = m_context.screenHalfWidth;
-  score.position.y    = 0.0f;
-  score.color         = Colors::Yellow;
+  auto& score = m_context.uiScore;
+  score.font  = m_resources.font32pt.get();
+  score.format(SCORE_FORMAT, m_context.playerScore);
+  score.origin     = Vector2(score.size().x / 2.f, 0.0f);
+  score.position.x = m_context.screenHalfWidth;
+  score.position.y = 0.0f;
+  score.color      = Colors::Yellow;
 }
 
 //------------------------------------------------------------------------------
@@ -616,14 +328,13 @@ void
 GameLogic::updateUILives()
 {
   TRACE
-  auto& lives         = m_context.uiLives;
-  lives.font          = m_resources.font32pt.get();
-  lives.text          = fmt::format(L"Lives: {}", m_context.playerLives);
-  XMVECTOR dimensions = lives.font->MeasureString(lives.text.c_str());
-  lives.origin        = Vector2(0.0f, XMVectorGetY(dimensions));
-  lives.position.x    = 0.0f;
-  lives.position.y    = m_context.screenHeight;
-  lives.color         = Colors::Yellow;
+  auto& lives = m_context.uiLives;
+  lives.font  = m_resources.font32pt.get();
+  lives.format(LIVES_FORMAT, m_context.playerLives);
+  lives.origin     = Vector2(0.0f, lives.size().y);
+  lives.position.x = 0.0f;
+  lives.position.y = m_context.screenHeight;
+  lives.color      = Colors::Yellow;
 }
 
 //------------------------------------------------------------------------------
@@ -647,45 +358,50 @@ void
 GameLogic::updateUIDebugVariables()
 {
   TRACE
+  auto font  = m_resources.fontMono8pt.get();
   float yPos = 0.0f;
 
-  auto formatUI = [
-    &yPos,
-    font        = m_resources.fontMono8pt.get(),
-    screenWidth = m_context.screenWidth
-  ](ui::Text & uiText, const wchar_t* fmt, float fVar)
-  {
-    uiText.font         = font;
-    uiText.text         = fmt::format(fmt, fVar);
-    XMVECTOR dimensions = uiText.font->MeasureString(uiText.text.c_str());
-    float width         = XMVectorGetX(dimensions);
-    float height        = ceil(XMVectorGetY(dimensions));
-    uiText.origin       = Vector2(width, 0.0f);
-    uiText.position.x   = screenWidth;
-    uiText.position.y   = yPos;
-    uiText.color        = Colors::MediumVioletRed;
-    yPos += height;
+  // Right aligned, one under another
+  auto placeUI = [&yPos, screenWidth = m_context.screenWidth](
+                   ui::FormattedText<>& uiText) {
+    uiText.origin     = Vector2(uiText.size().x, 0.0f);
+    uiText.position.x = screenWidth;
+    uiText.position.y = yPos;
+    uiText.color      = Colors::MediumVioletRed;
+    yPos += ceil(uiText.size().y);
+  };
+
+  auto formatUI = [&](
+                    ui::FormattedText<>& uiText,
+                    const auto& compiledFormat,
+                    float fVar) {
+    uiText.font = font;
+    uiText.format(compiledFormat, fVar);
+    placeUI(uiText);
   };
 
   const wchar_t* title = (m_context.isMidiConnected)
                            ? L"MIDI CONTROLLER FOUND"
                            : L"NO MIDI CONTROLLER FOUND";
-  formatUI(m_context.uiDebugVarsTitle, title, 0.0f);
+  m_context.uiDebugVarsTitle.font = font;
+  m_context.uiDebugVarsTitle.setText(title);
+  placeUI(m_context.uiDebugVarsTitle);
 
   formatUI(
-    m_context.uiCameraDist, L"Camera Dist: {}", m_context.cameraDistance);
-  formatUI(m_context.uiPlayerSpeed, L"Player Speed: {}", m_context.playerSpeed);
+    m_context.uiCameraDist, CAMERA_DIST_FORMAT, m_context.cameraDistance);
+  formatUI(
+    m_context.uiPlayerSpeed, PLAYER_SPEED_FORMAT, m_context.playerSpeed);
   formatUI(
     m_context.uiPlayerFriction,
-    L"Player Friction: {}",
+    PLAYER_FRICTION_FORMAT,
     m_context.playerFriction);
   formatUI(
     m_context.uiPlayerMaxVelocity,
-    L"Player Max Velocity: {}",
+    PLAYER_MAX_VELOCITY_FORMAT,
     m_context.playerMaxVelocity);
   formatUI(
     m_context.uiPlayerMinVelocity,
-    L"Player Min Velocity: {}",
+    PLAYER_MIN_VELOCITY_FORMAT,
     m_context.playerMinVelocity);
 }
 
@@ -694,7 +410,8 @@ void
 GameLogic::drawDebugVariables()
 {
   TRACE
-  auto drawUI = [& spriteBatch = m_resources.m_spriteBatch](ui::Text & uiText)
+  auto drawUI = [& spriteBatch = m_resources.m_spriteBatch](
+                  const ui::FormattedText<>& uiText)
   {
     uiText.draw(*spriteBatch);
   };
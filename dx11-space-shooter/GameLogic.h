@@ -1,49 +1,53 @@
 #pragma once
-#include "Enemies.h"
+#include "Simulation/GameSim.h"
+#include "Simulation/SimClock.h"
 
 namespace DX
 {
 class StepTimer;
 }
+namespace render
+{
+class CommandList;
+}
 struct AppContext;
 struct AppResources;
-struct Entity;
 
 //------------------------------------------------------------------------------
-class GameLogic
+class GameLogic : public ISimEventListener
 {
 public:
-  enum class GameStatus
-  {
-    Playing,
-    GameOver,
-  };
+  using GameStatus = GameSim::Status;
 
   GameLogic(AppContext& context, AppResources& resources);
 
   void reset();
-  GameStatus update(const DX::StepTimer& timer);
+  GameStatus update(
+    const DX::StepTimer& timer,
+    sim::JobSystem::Dependencies eventDependencies = {});
+
+  // The simulation's own clock only runs while the simulation does, so it
+  // ticks identically when a session is replayed
+  const sim::FixedStepClock& advanceSimClock(const DX::StepTimer& timer);
+  void resetSimClock() { m_simClock.reset(); }
   void render();
-  void renderEntityModels();
-  void renderShotParticles();
-  void renderEntitiesDebug();
 
-  void performPhysicsUpdate(const DX::StepTimer& timer);
-  void constrainPlayer(Entity& e);
-  void constrainShot(Entity& e);
-  void performCollisionTests();
+  // The frame's render::CommandList, cleared and set to the current camera.
+  // Submitted with AppResources::renderBackend.
+  render::CommandList& beginCommands();
+  void recordEntityModels(render::CommandList& commands);
+  void recordShotParticles(render::CommandList& commands);
+  void recordEntityBounds(render::CommandList& commands);
 
-  template <typename Func>
-  void collisionTestEntity(
-    Entity& entity,
-    const size_t rangeStartIdx,
-    const size_t rangeOnePastEndIdx,
-    Func& onCollision);
+  void renderEntitiesDebug();
+  void renderEnemyPaths();
+
+  void onSimEvent(SimEvent event, const sim::Vec3& position) override;
 
-  void renderPlayerEntity(Entity& entity);
-  void renderEntityModel(Entity& entity, float orientation = 0.0f);
-  void renderEntityBound(Entity& entity);
+  DirectX::VertexPositionColor*
+  writeEntityBound(DirectX::VertexPositionColor* out, size_t entityIdx) const;
   void renderPlayerBoundary();
+  sim::Vec3 renderPosition(size_t entityIdx) const;
 
   void updateUIScore();
   void updateUILives();
@@ -56,9 +60,15 @@ private:
   AppContext& m_context;
   AppResources& m_resources;
   bool m_hudDirty = true;
+  sim::FixedStepClock m_simClock;
+
+  // Blend between the last two sim updates, see StepTimer
+  uint32_t m_lastUpdateFrame = 0;
+  float m_renderAlpha        = 1.0f;
 
 public:
-  Enemies m_enemies;
+  GameSim m_sim;
+  Enemies& m_enemies;
 };
 
 //------------------------------------------------------------------------------
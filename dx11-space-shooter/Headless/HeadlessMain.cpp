@@ -0,0 +1,913 @@
+//------------------------------------------------------------------------------
+// Headless simulation runner
+//
+// Drives the gameplay simulation with a fixed step clock and a scripted
+// autopilot, with no window, renderer or audio. Ticks as fast as the CPU
+// allows and reports throughput plus a checksum of the final state, so runs
+// with the same seed can be compared across builds and platforms.
+//
+// Once warmed up, a frame must not allocate from the heap. Allocations are
+// counted and any after the first WARM_UP_FRAMES fail the run.
+//
+// With --replay, plays back a session recorded in the game (F5) instead of
+// the autopilot, and reports the distribution of tick times too.
+//
+// The updates run on a job system with one worker per spare core, or as many
+// as --workers asks for (0 runs everything on the main thread).
+//
+// With --render, each frame is also recorded into a render command list the
+// way the game records it, and submitted to the null backend. The time that
+// takes, what was submitted and a checksum of it are reported, so changes to
+// the render path can be measured and compared without a GPU.
+//
+// With --trace, every frame's TRACE records are also streamed to Chrome trace
+// files, <path>.<n>.json, keeping the last TRACE_FILE_COUNT files (see
+// utils/TraceExporter.h). Waits for the writer rather than drop frames.
+//
+// The profiler's frame time percentiles are reported for the last window of
+// PERCENTILE_WINDOW frames. With --spike, frames slower than that many ms are
+// counted, and the first one's call graph is summarised.
+//
+// usage: headless [--workers N] [--render] [--trace path] [--spike ms]
+//                 [numFrames] [seed] [assetsParentDir]
+//        headless [--workers N] [--render] [--trace path] [--spike ms]
+//                 --replay recordingFile [assetsParentDir]
+//------------------------------------------------------------------------------
+#include "Render/NullBackend.h"
+#include "Render/SceneRecording.h"
+#include "Simulation/GameSim.h"
+#include "Simulation/ExplosionSim.h"
+#include "Simulation/InputRecording.h"
+#include "Simulation/JobSystem.h"
+#include "Simulation/StarFieldSim.h"
+#include "Simulation/SimClock.h"
+#include "Simulation/SimRandom.h"
+#include "json11/json11.hpp"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#define TRACE_EXPORTER_IMPLEMENTATION
+#include "utils/TraceExporter.h"
+
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include "utils/AllocationCounter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+constexpr uint64_t DEFAULT_NUM_FRAMES     = 60 * 60 * 10;
+constexpr sim::Random::Seed DEFAULT_SEED  = 1;
+constexpr float SCREEN_WIDTH              = 1280.0f;
+constexpr float SCREEN_HEIGHT             = 720.0f;
+constexpr float STAR_SIZE                 = 32.0f;
+constexpr float AUTOPILOT_FIRE_INTERVAL_S = 0.2f;
+constexpr uint64_t WARM_UP_FRAMES         = 60 * 10;
+constexpr uint32_t TRACE_FILE_COUNT       = 10;
+constexpr int PERCENTILE_WINDOW           = 6000;
+
+// As the game's camera starts out (see AppContext and
+// Game::createWindowSizeDependentResources)
+constexpr float CAMERA_DISTANCE    = 80.0f;
+constexpr float CAMERA_FOV_Y       = 30.0f * 3.14159265358979f / 180.0f;
+constexpr float CAMERA_NEAR_PLANE  = 0.01f;
+constexpr float CAMERA_FAR_PLANE   = 300.0f;
+constexpr size_t RENDER_ARENA_SIZE = 256 * 1024;
+static const char* const ATLAS_FILENAME = "assets/atlas.json";
+
+//------------------------------------------------------------------------------
+// Bounding spheres of the shipped .sdkmesh models, as computed by the game at
+// load time. The headless build doesn't load meshes.
+//------------------------------------------------------------------------------
+static void
+setModelBounds(SimContext& context)
+{
+  using sim::Vec3;
+  auto set = [&context](ModelResource model, Vec3 center, float radius) {
+    context.modelBound(model) = sim::BoundingSphere{center, radius};
+  };
+  set(ModelResource::Player, Vec3(0.0f, -0.4344f, 0.0337f), 2.2408f);
+  set(ModelResource::Enemy1, Vec3(0.0f, -0.0288f, -0.0658f), 2.0784f);
+  set(ModelResource::Enemy2, Vec3(0.0f, -0.0959f, 0.0520f), 1.5153f);
+  set(ModelResource::Enemy3, Vec3(0.0f, -0.0524f, 0.0004f), 1.7701f);
+  set(ModelResource::Enemy4, Vec3(0.0f, 0.0f, 0.0f), 1.6507f);
+  set(ModelResource::Enemy5, Vec3(0.0625f, -0.1177f, 0.0f), 1.6023f);
+  set(ModelResource::Enemy6, Vec3(-0.0027f, 0.0184f, 0.0f), 1.5735f);
+  set(ModelResource::Enemy7, Vec3(0.0f, 0.0f, 0.0f), 1.6453f);
+  set(ModelResource::Enemy8, Vec3(0.0f, 0.2865f, 0.0f), 1.2706f);
+  set(ModelResource::Enemy9, Vec3(0.0f, 0.0f, 0.0f), 1.8616f);
+  set(ModelResource::Shot, Vec3(0.0f, 0.0f, 0.0f), 0.2598f);
+}
+
+//------------------------------------------------------------------------------
+// Stands in for the game's audio/particle/HUD reactions
+//------------------------------------------------------------------------------
+class HeadlessListener : public ISimEventListener
+{
+public:
+  explicit HeadlessListener(ExplosionSim& explosions)
+      : m_explosions(explosions)
+  {
+  }
+
+  void onSimEvent(SimEvent event, const sim::Vec3& position) override
+  {
+    eventCounts[static_cast<size_t>(event)]++;
+    if (event == SimEvent::PlayerExploded || event == SimEvent::EnemyExploded)
+    {
+      m_explosions.emit(position, sim::Vec3());
+    }
+  }
+
+  static constexpr size_t NUM_EVENTS
+    = static_cast<size_t>(SimEvent::LivesChanged) + 1;
+  uint64_t eventCounts[NUM_EVENTS] = {};
+
+private:
+  ExplosionSim& m_explosions;
+};
+
+//------------------------------------------------------------------------------
+// Follows the lowest live enemy and fires at a steady rate
+//------------------------------------------------------------------------------
+static void
+autopilot(SimContext& context, GameSim& game, const sim::IClock& clock)
+{
+  static double nextShotTimeS = 0.0;
+
+  context.playerAccel = sim::Vec3();
+  if (context.playerState == PlayerState::Dying)
+  {
+    return;
+  }
+
+  const auto& entities = context.entities;
+  size_t targetIdx     = EntityStore::INVALID_IDX;
+  for (size_t i : entities.alive(Partition::Enemies))
+  {
+    if (
+      (targetIdx == EntityStore::INVALID_IDX)
+      || (entities.posY[i] < entities.posY[targetIdx]))
+    {
+      targetIdx = i;
+    }
+  }
+
+  if (targetIdx != EntityStore::INVALID_IDX)
+  {
+    const float dx = entities.posX[targetIdx] - entities.posX[PLAYERS_IDX];
+    if (dx < -0.5f)
+    {
+      context.playerAccel.x = -1.0f;
+    }
+    else if (dx > 0.5f)
+    {
+      context.playerAccel.x = 1.0f;
+    }
+  }
+
+  if (clock.GetTotalSeconds() >= nextShotTimeS)
+  {
+    nextShotTimeS = clock.GetTotalSeconds() + AUTOPILOT_FIRE_INTERVAL_S;
+    game.m_enemies.emitPlayerShot();
+  }
+}
+
+//------------------------------------------------------------------------------
+static uint64_t
+hashState(uint64_t hash, const SimContext& context)
+{
+  // FNV-1a
+  auto mix = [&hash](const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+  };
+
+  const auto& entities = context.entities;
+  for (size_t p = 0; p < EntityStore::NUM_PARTITIONS; ++p)
+  {
+    for (size_t i : entities.alive(static_cast<Partition>(p)))
+    {
+      const sim::Vec3 position = entities.position(i);
+      mix(&position, sizeof(position));
+    }
+  }
+  mix(&context.playerScore, sizeof(context.playerScore));
+  mix(&context.playerLives, sizeof(context.playerLives));
+  return hash;
+}
+
+//------------------------------------------------------------------------------
+// Heap allocations made by the frames after the warm-up
+//------------------------------------------------------------------------------
+struct AllocationCheck
+{
+  uint64_t numFrames      = 0;
+  uint64_t numAllocations = 0;
+  uint64_t maxPerFrame    = 0;
+
+  void beginFrame() { m_start = memory::AllocationCounter::numAllocations(); }
+  void endFrame(uint64_t frameIdx)
+  {
+    if (frameIdx < WARM_UP_FRAMES)
+    {
+      return;
+    }
+    const uint64_t count
+      = memory::AllocationCounter::numAllocations() - m_start;
+    numFrames++;
+    numAllocations += count;
+    maxPerFrame = std::max(maxPerFrame, count);
+  }
+
+private:
+  uint64_t m_start = 0;
+};
+
+//------------------------------------------------------------------------------
+// Records and submits what GameLogic draws each frame
+//------------------------------------------------------------------------------
+class HeadlessRenderer
+{
+public:
+  HeadlessRenderer(const SimContext& context, const ExplosionSim& explosions)
+      : m_frameArena(RENDER_ARENA_SIZE)
+  {
+    using namespace render;
+    const Matrix4 worldToView      = translation(0.0f, 0.0f, -CAMERA_DISTANCE);
+    const Matrix4 viewToProjection = perspectiveFieldOfView(
+      CAMERA_FOV_Y,
+      SCREEN_WIDTH / SCREEN_HEIGHT,
+      CAMERA_NEAR_PLANE,
+      CAMERA_FAR_PLANE);
+    m_list.setCamera(worldToView, viewToProjection);
+    m_worldToPixels = worldToView * viewToProjection
+                      * projectionToPixels(SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    // The largest frame the pools allow
+    const auto& capacity  = context.entities.capacity();
+    const size_t numShots = capacity[Partition::PlayerShots]
+                            + capacity[Partition::EnemyShots];
+    size_t numModels = 0;
+    for (size_t p = 0; p < EntityStore::NUM_PARTITIONS; ++p)
+    {
+      numModels += capacity[static_cast<Partition>(p)];
+    }
+    m_list.reserve(numModels, explosions.capacity() + numShots * 2, 0);
+  }
+
+  bool loadAtlas(const char* fileName)
+  {
+    std::ifstream fileIn(fileName);
+    if (!fileIn.is_open())
+    {
+      LOG_ERROR("Couldn't load atlas from file: %s", fileName);
+      return false;
+    }
+    std::stringstream ss;
+    ss << fileIn.rdbuf();
+
+    std::string err;
+    const json11::Json json  = json11::Json::parse(ss.str(), err);
+    const json11::Json& rect = json["sprites"]["explosion"];
+    if (json.is_null() || !rect.is_array())
+    {
+      LOG_ERROR("Couldn't find the explosion sprite in atlas: %s", fileName);
+      return false;
+    }
+    m_backend.setTextureSize(
+      render::TextureId::Atlas,
+      static_cast<float>(json["width"].int_value()),
+      static_cast<float>(json["height"].int_value()));
+
+    // As TextureAtlas::load
+    auto& sprite   = m_explosionSprite;
+    sprite.left    = rect[0].int_value();
+    sprite.top     = rect[1].int_value();
+    sprite.right   = sprite.left + rect[2].int_value();
+    sprite.bottom  = sprite.top + rect[3].int_value();
+    sprite.originX = rect[2].int_value() / 2.0f;
+    sprite.originY = rect[3].int_value() / 2.0f;
+    return true;
+  }
+
+  void renderFrame(
+    const SimContext& context, const ExplosionSim& explosions, double simTimeS)
+  {
+    m_frameArena.reset();
+    const auto startTime = std::chrono::steady_clock::now();
+
+    m_list.clear();
+    render::recordEntityModels(m_list, context, 1.0f);
+    render::recordShotParticles(
+      m_list,
+      context,
+      1.0f,
+      simTimeS,
+      m_worldToPixels,
+      m_explosionSprite,
+      m_frameArena);
+    render::recordExplosions(
+      m_list, explosions, m_worldToPixels, m_explosionSprite);
+    const auto recordedTime = std::chrono::steady_clock::now();
+
+    m_backend.execute(m_list);
+    const auto endTime = std::chrono::steady_clock::now();
+
+    m_recordS
+      += std::chrono::duration<double>(recordedTime - startTime).count();
+    m_submitS += std::chrono::duration<double>(endTime - recordedTime).count();
+    m_numFrames++;
+  }
+
+  void print() const
+  {
+    const double numFrames
+      = static_cast<double>(std::max<uint64_t>(m_numFrames, 1));
+    const auto& stats = m_backend.totalStats();
+    std::printf(
+      "render: %llu frames, %.2f us record + %.2f us submit per frame\n",
+      static_cast<unsigned long long>(m_numFrames),
+      1e6 * m_recordS / numFrames,
+      1e6 * m_submitS / numFrames);
+    std::printf(
+      "render per frame: %.1f commands, %.1f models, %.1f sprite batches, "
+      "%.1f quads, %.1f state changes\n",
+      stats.numCommands / numFrames,
+      stats.numModelDraws / numFrames,
+      stats.numSpriteBatches / numFrames,
+      stats.numQuads / numFrames,
+      stats.numStateChanges / numFrames);
+    std::printf(
+      "render checksum: %016llx\n",
+      static_cast<unsigned long long>(m_backend.checksum()));
+  }
+
+private:
+  render::CommandList m_list;
+  render::NullBackend m_backend;
+  render::Matrix4 m_worldToPixels;
+  render::SpriteRef m_explosionSprite;
+  memory::LinearArena m_frameArena;
+
+  uint64_t m_numFrames = 0;
+  double m_recordS     = 0.0;
+  double m_submitS     = 0.0;
+};
+
+//------------------------------------------------------------------------------
+// Everything a run simulates
+//------------------------------------------------------------------------------
+struct Session
+{
+  Session(const sim::InputRecording::Setup& setup, size_t numWorkers)
+      : jobs(numWorkers)
+      , clock(setup.stepSeconds)
+      , random(setup.gameSeed)
+      , explosions(setup.explosionSeed)
+      , starField(setup.starFieldSeed)
+      , listener(explosions)
+      , game(context, clock, random, listener, jobs)
+  {
+    starField.setBounds(setup.starFieldBounds);
+    setModelBounds(context);
+  }
+
+  sim::JobSystem jobs;
+  sim::FixedStepClock clock;
+  sim::Random random;
+  ExplosionSim explosions;
+  StarFieldSim starField;
+  SimContext context;
+  HeadlessListener listener;
+  GameSim game;
+
+  uint64_t numGames = 0;
+  int bestScore     = 0;
+  uint64_t checksum = 14695981039346656037ull;
+
+  // Tick times of the replayed gameplay updates
+  std::vector<float> tickTimesUs;
+
+  AllocationCheck allocations;
+
+  // Only with --render
+  std::unique_ptr<HeadlessRenderer> renderer;
+
+  // Only with --trace
+  std::unique_ptr<logger::TraceExporter> traceExporter;
+
+  void render()
+  {
+    if (renderer)
+    {
+      renderer->renderFrame(context, explosions, clock.GetTotalSeconds());
+    }
+  }
+
+  void signalFrameEnd()
+  {
+    logger::Stats::signalFrameEnd();
+    if (traceExporter)
+    {
+      traceExporter->submitLastFrame();
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+static void
+runAutopilot(Session& session, uint64_t numFrames)
+{
+  auto& clock = session.clock;
+  auto& game  = session.game;
+
+  game.reset();
+  session.numGames = 1;
+  for (uint64_t frame = 0; frame < numFrames; ++frame)
+  {
+    session.allocations.beginFrame();
+    clock.tick();
+    const float elapsedTimeS = static_cast<float>(clock.GetElapsedSeconds());
+
+    autopilot(session.context, game, clock);
+    session.starField.scheduleUpdate(session.jobs, elapsedTimeS);
+    auto* explosions
+      = session.explosions.scheduleUpdate(session.jobs, elapsedTimeS);
+    const auto status = game.update(clock, {explosions});
+    session.jobs.waitAll();
+    if (GameSim::Status::GameOver == status)
+    {
+      session.bestScore
+        = std::max(session.bestScore, session.context.playerScore);
+      game.reset();
+      session.numGames++;
+    }
+    session.render();
+    session.checksum = hashState(session.checksum, session.context);
+
+    session.signalFrameEnd();
+    session.allocations.endFrame(frame);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Mirrors what the game did on each recorded tick (see GamePlayState)
+//------------------------------------------------------------------------------
+static void
+runReplay(Session& session, const sim::InputRecording& recording)
+{
+  using sim::InputTick;
+  auto& clock   = session.clock;
+  auto& game    = session.game;
+  auto& context = session.context;
+
+  const float elapsedTimeS = static_cast<float>(clock.stepSeconds());
+  session.tickTimesUs.reserve(recording.ticks.size());
+
+  for (sim::InputPlayer player(recording); !player.isFinished(); player.next())
+  {
+    const InputTick& tick = player.tick();
+    const auto startTime  = std::chrono::steady_clock::now();
+    session.allocations.beginFrame();
+
+    if (tick.flags & InputTick::NewGame)
+    {
+      session.bestScore = std::max(session.bestScore, context.playerScore);
+      game.reset();
+      session.explosions.reset();
+      session.numGames++;
+    }
+
+    if (tick.flags & InputTick::Gameplay)
+    {
+      if (tick.input.isPressed(sim::Input_Explode))
+      {
+        session.explosions.emit(
+          context.entities.position(PLAYERS_IDX)
+            + context.bound(PLAYERS_IDX).Center,
+          sim::Vec3());
+      }
+      for (size_t i = 0; i < tick.numMidiChanges; ++i)
+      {
+        const auto& change = player.midiChanges()[i];
+        game.applyMidiControl(change.controllerId, change.value);
+      }
+      game.applyInput(tick.input);
+    }
+
+    if (tick.flags & InputTick::StarField)
+    {
+      session.starField.scheduleUpdate(session.jobs, elapsedTimeS);
+    }
+
+    if (tick.flags & InputTick::Gameplay)
+    {
+      auto* explosions
+        = session.explosions.scheduleUpdate(session.jobs, elapsedTimeS);
+      clock.tick();
+      game.update(clock, {explosions});
+      session.jobs.waitAll();
+      session.checksum = hashState(session.checksum, context);
+
+      const auto endTime = std::chrono::steady_clock::now();
+      session.tickTimesUs.push_back(
+        std::chrono::duration<float, std::micro>(endTime - startTime).count());
+      session.render();
+    }
+
+    session.jobs.waitAll();
+    session.signalFrameEnd();
+    session.allocations.endFrame(player.tickIdx());
+  }
+  session.bestScore = std::max(session.bestScore, context.playerScore);
+}
+
+//------------------------------------------------------------------------------
+static void
+printTickTimes(std::vector<float> tickTimesUs)
+{
+  if (tickTimesUs.empty())
+  {
+    return;
+  }
+  std::sort(tickTimesUs.begin(), tickTimesUs.end());
+  auto percentile = [&tickTimesUs](double p) {
+    const size_t idx = static_cast<size_t>(p * (tickTimesUs.size() - 1));
+    return tickTimesUs[idx];
+  };
+  std::printf(
+    "tick time (us): p50 %.2f, p95 %.2f, p99 %.2f, max %.2f\n",
+    percentile(0.50),
+    percentile(0.95),
+    percentile(0.99),
+    tickTimesUs.back());
+
+  // Power of two buckets, for comparing the shape between builds
+  std::vector<size_t> buckets;
+  for (float us : tickTimesUs)
+  {
+    size_t bucket = 0;
+    while ((float(1u << bucket) <= us) && (bucket < 31))
+    {
+      ++bucket;
+    }
+    buckets.resize(std::max(buckets.size(), bucket + 1));
+    buckets[bucket]++;
+  }
+  for (size_t i = 0; i < buckets.size(); ++i)
+  {
+    if (buckets[i] != 0)
+    {
+      std::printf(
+        "  < %8u us: %zu\n", static_cast<unsigned>(1u << i), buckets[i]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool
+changeDirectory(const char* path)
+{
+  // Level data is loaded relative to the working directory
+  std::error_code ec;
+  std::filesystem::current_path(path, ec);
+  if (ec)
+  {
+    LOG_ERROR("Unable to change directory to %s", path);
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void
+printProfilerPercentiles(double spikeThresholdMs)
+{
+  auto toUs = [](logger::Ticks ticks) {
+    return logger::Timing::ticksToMilliSeconds(ticks) * 1000.0;
+  };
+  const logger::Histogram& frames = logger::Stats::getFrameHistogram();
+  const auto percentiles          = frames.percentiles();
+  std::printf(
+    "frame time (us): p50 %.2f, p95 %.2f, p99 %.2f, p99.9 %.2f, max %.2f "
+    "(last %u frames)\n",
+    toUs(percentiles.p50),
+    toUs(percentiles.p95),
+    toUs(percentiles.p99),
+    toUs(percentiles.p999),
+    toUs(frames.max),
+    frames.count);
+
+  if (spikeThresholdMs <= 0.0)
+  {
+    return;
+  }
+  const logger::Stats::Spike* spike = logger::Stats::getSpike();
+  std::printf(
+    "spikes: %zu frames over %.3fms\n",
+    logger::Stats::getNumSpikes(),
+    spikeThresholdMs);
+  if (!spike)
+  {
+    return;
+  }
+
+  // The slowest outermost block of each lane
+  const auto& frame = spike->frame;
+  std::printf(
+    "  first: frame %u, %.2fus, %zu records\n",
+    spike->frameNumber,
+    toUs(frame.duration),
+    frame.numRecords);
+  for (size_t i = 0; i < frame.numLanes; ++i)
+  {
+    const logger::TimedRecord* slowest = nullptr;
+    for (auto r = frame.firstChild(frame.lanes[i].root); r;
+         r = frame.nextSibling(*r))
+    {
+      if (!slowest || r->duration > slowest->duration)
+      {
+        slowest = r;
+      }
+    }
+    const auto& site = logger::Stats::getSite(slowest->siteId);
+    std::printf(
+      "  %s %d: %s (%s:%d) %.2fus\n",
+      frame.lanes[i].name,
+      frame.lanes[i].threadIdx,
+      site.function,
+      site.file,
+      site.lineNumber,
+      toUs(slowest->duration));
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+printUsage()
+{
+  std::fprintf(
+    stderr,
+    "usage: headless [--workers N] [--render] [--trace path] [--spike ms]\n"
+    "                [numFrames] [seed] [assetsParentDir]\n"
+    "       headless [--workers N] [--render] [--trace path] [--spike ms]\n"
+    "                --replay recordingFile [assetsParentDir]\n");
+}
+
+//------------------------------------------------------------------------------
+// A whole decimal number, so a typo isn't run as 0
+static bool
+parseNumber(const char* str, uint64_t& value)
+{
+  char* end = nullptr;
+  value     = std::strtoull(str, &end, 10);
+  return (*str >= '0') && (*str <= '9') && (*end == '\0');
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  logger::TimedRaiiBlock::setThreadName("Main");
+  logger::Stats::init();
+  logger::Stats::setPercentileWindow(PERCENTILE_WINDOW);
+  size_t numWorkers       = sim::JobSystem::defaultNumWorkers();
+  bool isRendering        = false;
+  double spikeThresholdMs = 0.0;
+  std::string tracePath;
+  for (;;)
+  {
+    if ((argc > 2) && (std::strcmp(argv[1], "--workers") == 0))
+    {
+      uint64_t workersArg = 0;
+      if (!parseNumber(argv[2], workersArg))
+      {
+        LOG_ERROR("--workers must be a whole number");
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      numWorkers = static_cast<size_t>(workersArg);
+      argc -= 2;
+      argv += 2;
+    }
+    else if ((argc > 1) && (std::strcmp(argv[1], "--render") == 0))
+    {
+      isRendering = true;
+      argc -= 1;
+      argv += 1;
+    }
+    else if ((argc > 2) && (std::strcmp(argv[1], "--trace") == 0))
+    {
+      // Absolute, as the working directory changes to the assets
+      tracePath = std::filesystem::absolute(argv[2]).string();
+      argc -= 2;
+      argv += 2;
+    }
+    else if ((argc > 2) && (std::strcmp(argv[1], "--spike") == 0))
+    {
+      char* end        = nullptr;
+      spikeThresholdMs = std::strtod(argv[2], &end);
+      if (
+        (end == argv[2]) || (*end != '\0')
+        || !std::isfinite(spikeThresholdMs) || (spikeThresholdMs <= 0.0))
+      {
+        LOG_ERROR("--spike must be a number of ms above 0");
+        printUsage();
+        return EXIT_FAILURE;
+      }
+      logger::Stats::setSpikeThresholdMs(spikeThresholdMs);
+      argc -= 2;
+      argv += 2;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  const bool isReplay = (argc > 1) && (std::strcmp(argv[1], "--replay") == 0);
+  if (!isReplay && (argc > 1) && (std::strncmp(argv[1], "--", 2) == 0))
+  {
+    LOG_ERROR("Unknown option %s", argv[1]);
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  sim::InputRecording recording;
+  uint64_t numFrames     = DEFAULT_NUM_FRAMES;
+  sim::Random::Seed seed = DEFAULT_SEED;
+  const char* assetsDir  = nullptr;
+  if (isReplay)
+  {
+    if (argc < 3)
+    {
+      printUsage();
+      return EXIT_FAILURE;
+    }
+    // Load before changing directory, so relative paths work as expected
+    if (!recording.load(argv[2]))
+    {
+      return EXIT_FAILURE;
+    }
+    seed      = recording.setup.gameSeed;
+    assetsDir = (argc > 3) ? argv[3] : nullptr;
+  }
+  else
+  {
+    uint64_t seedArg = seed;
+    if (
+      ((argc > 1) && !parseNumber(argv[1], numFrames))
+      || ((argc > 2) && !parseNumber(argv[2], seedArg)))
+    {
+      LOG_ERROR("numFrames and seed must be whole numbers");
+      printUsage();
+      return EXIT_FAILURE;
+    }
+    seed = static_cast<sim::Random::Seed>(seedArg);
+    assetsDir = (argc > 3) ? argv[3] : nullptr;
+
+    recording.setup.gameSeed        = seed;
+    recording.setup.explosionSeed   = seed + 1;
+    recording.setup.starFieldSeed   = seed + 2;
+    recording.setup.stepSeconds     = sim::FIXED_STEP_SECONDS;
+    recording.setup.starFieldBounds = StarFieldSim::Bounds{
+      SCREEN_WIDTH, SCREEN_HEIGHT, STAR_SIZE, STAR_SIZE};
+  }
+  if (assetsDir && !changeDirectory(assetsDir))
+  {
+    return EXIT_FAILURE;
+  }
+
+  Session session(recording.setup, numWorkers);
+  if (isRendering)
+  {
+    session.renderer = std::make_unique<HeadlessRenderer>(
+      session.context, session.explosions);
+    if (!session.renderer->loadAtlas(ATLAS_FILENAME))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  if (!tracePath.empty())
+  {
+    logger::TraceExporter::Config traceConfig;
+    traceConfig.path       = tracePath.c_str();
+    traceConfig.numFiles   = TRACE_FILE_COUNT;
+    traceConfig.isLossless = true;
+    session.traceExporter
+      = std::make_unique<logger::TraceExporter>(traceConfig);
+  }
+
+  const auto startTime = std::chrono::steady_clock::now();
+  if (isReplay)
+  {
+    runReplay(session, recording);
+    numFrames = recording.ticks.size();
+  }
+  else
+  {
+    runAutopilot(session, numFrames);
+  }
+  const auto endTime = std::chrono::steady_clock::now();
+  session.bestScore
+    = std::max(session.bestScore, session.context.playerScore);
+
+  const double seconds
+    = std::chrono::duration<double>(endTime - startTime).count();
+  const auto& counts = session.listener.eventCounts;
+  std::printf(
+    "frames: %llu (%.1f sim seconds) in %.3fs, %.0f ticks/s\n",
+    static_cast<unsigned long long>(numFrames),
+    session.clock.GetTotalSeconds(),
+    seconds,
+    (seconds > 0.0) ? numFrames / seconds : 0.0);
+  std::printf(
+    "seed: %u workers: %zu games: %llu best score: %d\n",
+    seed,
+    numWorkers,
+    static_cast<unsigned long long>(session.numGames),
+    session.bestScore);
+  std::printf(
+    "shots: %llu player / %llu enemy, explosions: %llu player / %llu enemy\n",
+    static_cast<unsigned long long>(
+      counts[static_cast<size_t>(SimEvent::PlayerShot)]),
+    static_cast<unsigned long long>(
+      counts[static_cast<size_t>(SimEvent::EnemyShot)]),
+    static_cast<unsigned long long>(
+      counts[static_cast<size_t>(SimEvent::PlayerExploded)]),
+    static_cast<unsigned long long>(
+      counts[static_cast<size_t>(SimEvent::EnemyExploded)]));
+
+  const auto& entities = session.context.entities;
+  auto printPool       = [&entities](const char* name, Partition p) {
+    std::printf(
+      "%s pool: high-water %zu / %zu, failed spawns %zu\n",
+      name,
+      entities.highWaterMark(p),
+      entities.capacity()[p],
+      entities.numFailedSpawns(p));
+  };
+  printPool("player shot", Partition::PlayerShots);
+  printPool("enemy shot", Partition::EnemyShots);
+  printPool("enemy", Partition::Enemies);
+  printTickTimes(session.tickTimesUs);
+  const auto& profilerConfig = logger::Stats::getConfig();
+  std::printf(
+    "profiler: %.0fns per TRACE scope, %zu records dropped (capacity %d per "
+    "thread, %d per frame)\n",
+    logger::Stats::getScopeOverheadMs() * 1e6,
+    logger::Stats::getNumDroppedRecords(),
+    profilerConfig.recordsPerThread,
+    profilerConfig.recordsPerFrame);
+  printProfilerPercentiles(spikeThresholdMs);
+  if (session.renderer)
+  {
+    session.renderer->print();
+  }
+  if (session.traceExporter)
+  {
+    session.traceExporter.reset();    // Finishes writing
+    std::printf(
+      "trace: %llu frames to %s.<n>.json, the last %u files of %u frames "
+      "kept\n",
+      static_cast<unsigned long long>(numFrames),
+      tracePath.c_str(),
+      TRACE_FILE_COUNT,
+      logger::TraceExporter::Config().framesPerFile);
+  }
+
+  const auto& allocations = session.allocations;
+  std::printf(
+    "allocations after warm-up: %llu in %llu frames (max %llu per frame)\n",
+    static_cast<unsigned long long>(allocations.numAllocations),
+    static_cast<unsigned long long>(allocations.numFrames),
+    static_cast<unsigned long long>(allocations.maxPerFrame));
+  std::printf(
+    "checksum: %016llx\n", static_cast<unsigned long long>(session.checksum));
+
+  if (allocations.numAllocations != 0)
+  {
+    LOG_ERROR("Frames allocated from the heap after warming up");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #include "pch.h"
 #include "resource.h"
 #include "Game.h"
+#include "utils/Log.h"
 
 using namespace DirectX;
 
@@ -39,6 +40,8 @@ wWinMain(
   if (FAILED(hr))
     return 1;
 
+  // Before the first TRACE, which is in Game()
+  logger::Stats::init();
   g_game = std::make_unique<Game>();
 
   // Register class and create window
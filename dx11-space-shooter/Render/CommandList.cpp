@@ -0,0 +1,157 @@
+#include "Render/CommandList.h"
+
+#include "utils/Log.h"
+
+namespace render
+{
+//------------------------------------------------------------------------------
+bool
+operator==(const SpriteRef& a, const SpriteRef& b)
+{
+  return a.texture == b.texture && a.left == b.left && a.top == b.top
+         && a.right == b.right && a.bottom == b.bottom
+         && a.originX == b.originX && a.originY == b.originY;
+}
+
+//------------------------------------------------------------------------------
+void
+CommandList::clear()
+{
+  m_commands.clear();
+  m_models.clear();
+  m_sprites.clear();
+  m_lines.clear();
+  m_numQuads        = 0;
+  m_numLineVertices = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+CommandList::reserve(size_t numModels, size_t numQuads, size_t numLineVertices)
+{
+  // Every model could be a command of its own, plus a few sprite and line runs
+  static const size_t NUM_OTHER_COMMANDS = 16;
+  m_commands.reserve(numModels + NUM_OTHER_COMMANDS);
+  m_models.reserve(numModels);
+  m_sprites.reserve(NUM_OTHER_COMMANDS);
+  m_lines.reserve(NUM_OTHER_COMMANDS);
+  growQuads(numQuads);
+  if (m_lineVertices.size() < numLineVertices)
+  {
+    m_lineVertices.resize(numLineVertices);
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+CommandList::setCamera(
+  const Matrix4& worldToView, const Matrix4& viewToProjection)
+{
+  m_worldToView      = worldToView;
+  m_viewToProjection = viewToProjection;
+}
+
+//------------------------------------------------------------------------------
+void
+CommandList::drawModel(ModelResource model, const Matrix4& world)
+{
+  m_commands.push_back(
+    {Command::Type::Model, static_cast<uint32_t>(m_models.size())});
+  m_models.push_back({model, world});
+}
+
+//------------------------------------------------------------------------------
+QuadArrays<float>
+CommandList::drawSprites(
+  const SpriteRef& sprite, BlendMode blend, size_t numQuads)
+{
+  const size_t firstQuad = m_numQuads;
+  m_numQuads += numQuads;
+  growQuads(m_numQuads);
+
+  if (
+    isLast(Command::Type::Sprites) && m_sprites.back().sprite == sprite
+    && m_sprites.back().blend == blend)
+  {
+    m_sprites.back().numQuads += numQuads;
+  }
+  else
+  {
+    m_commands.push_back(
+      {Command::Type::Sprites, static_cast<uint32_t>(m_sprites.size())});
+    m_sprites.push_back({sprite, blend, firstQuad, numQuads});
+  }
+
+  QuadArrays<float> quads;
+  quads.x     = m_quadX.data() + firstQuad;
+  quads.y     = m_quadY.data() + firstQuad;
+  quads.scale = m_quadScale.data() + firstQuad;
+  quads.r     = m_quadR.data() + firstQuad;
+  quads.g     = m_quadG.data() + firstQuad;
+  quads.b     = m_quadB.data() + firstQuad;
+  quads.a     = m_quadA.data() + firstQuad;
+  quads.count = numQuads;
+  return quads;
+}
+
+//------------------------------------------------------------------------------
+LineVertex*
+CommandList::drawLines(size_t numVertices)
+{
+  ASSERT(numVertices % 2 == 0);
+  const size_t firstVertex = m_numLineVertices;
+  m_numLineVertices += numVertices;
+  if (m_lineVertices.size() < m_numLineVertices)
+  {
+    m_lineVertices.resize(m_numLineVertices);
+  }
+
+  if (isLast(Command::Type::Lines))
+  {
+    m_lines.back().numVertices += numVertices;
+  }
+  else
+  {
+    m_commands.push_back(
+      {Command::Type::Lines, static_cast<uint32_t>(m_lines.size())});
+    m_lines.push_back({firstVertex, numVertices});
+  }
+  return m_lineVertices.data() + firstVertex;
+}
+
+//------------------------------------------------------------------------------
+void
+CommandList::growQuads(size_t numQuads)
+{
+  // The arrays only grow, so their size is the high-water mark
+  if (m_quadX.size() < numQuads)
+  {
+    m_quadX.resize(numQuads);
+    m_quadY.resize(numQuads);
+    m_quadScale.resize(numQuads);
+    m_quadR.resize(numQuads);
+    m_quadG.resize(numQuads);
+    m_quadB.resize(numQuads);
+    m_quadA.resize(numQuads);
+  }
+}
+
+//------------------------------------------------------------------------------
+QuadArrays<const float>
+CommandList::quads(const SpriteDraw& draw) const
+{
+  QuadArrays<const float> quads;
+  quads.x     = m_quadX.data() + draw.firstQuad;
+  quads.y     = m_quadY.data() + draw.firstQuad;
+  quads.scale = m_quadScale.data() + draw.firstQuad;
+  quads.r     = m_quadR.data() + draw.firstQuad;
+  quads.g     = m_quadG.data() + draw.firstQuad;
+  quads.b     = m_quadB.data() + draw.firstQuad;
+  quads.a     = m_quadA.data() + draw.firstQuad;
+  quads.count = draw.numQuads;
+  return quads;
+}
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
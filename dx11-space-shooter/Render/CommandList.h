@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+// Recorded render commands
+//
+// Game code records a frame's world drawing (models, sprite quads and debug
+// lines) into a CommandList, and a backend submits it afterwards: the D3D11
+// backend in the game, or NullBackend which runs anywhere, so the cost of
+// recording and submitting a frame can be measured and diffed without a GPU.
+//
+// Commands are kept in the order they were recorded. Consecutive sprite draws
+// of the same sprite and blend, and consecutive line draws, are merged as
+// they are recorded. The payloads live in flat arrays owned by the list, which
+// keep their capacity across clear(), so recording doesn't allocate once the
+// list has grown to fit a frame.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "ResourceIDs.h"    // ModelResource
+#include "Render/RenderMath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace render
+{
+//------------------------------------------------------------------------------
+enum class BlendMode : uint8_t
+{
+  AlphaBlend,
+  Additive,
+};
+
+//------------------------------------------------------------------------------
+enum class TextureId : uint8_t
+{
+  Atlas,
+
+  COUNT
+};
+
+//------------------------------------------------------------------------------
+// A rectangle of a texture, in texels, and the point of it which is placed at
+// each quad's position
+//------------------------------------------------------------------------------
+struct SpriteRef
+{
+  TextureId texture = TextureId::Atlas;
+  int32_t left      = 0;
+  int32_t top       = 0;
+  int32_t right     = 0;
+  int32_t bottom    = 0;
+  float originX     = 0.0f;
+  float originY     = 0.0f;
+};
+
+bool operator==(const SpriteRef& a, const SpriteRef& b);
+
+//------------------------------------------------------------------------------
+// The layout of DirectX::VertexPositionColor
+//------------------------------------------------------------------------------
+struct LineVertex
+{
+  float x, y, z;
+  float r, g, b, a;
+};
+
+//------------------------------------------------------------------------------
+// Parallel arrays of sprite quads, as SpriteBatch::DrawQuads takes them:
+// position in screen pixels, scale of the sprite and color
+//------------------------------------------------------------------------------
+template <typename Float>
+struct QuadArrays
+{
+  Float* x     = nullptr;
+  Float* y     = nullptr;
+  Float* scale = nullptr;
+  Float* r     = nullptr;
+  Float* g     = nullptr;
+  Float* b     = nullptr;
+  Float* a     = nullptr;
+  size_t count = 0;
+};
+
+//------------------------------------------------------------------------------
+struct ModelDraw
+{
+  ModelResource model;
+  Matrix4 world;
+};
+
+struct SpriteDraw
+{
+  SpriteRef sprite;
+  BlendMode blend;
+  size_t firstQuad;
+  size_t numQuads;
+};
+
+struct LineDraw
+{
+  size_t firstVertex;
+  size_t numVertices;
+};
+
+//------------------------------------------------------------------------------
+struct Command
+{
+  enum class Type : uint8_t
+  {
+    Model,
+    Sprites,
+    Lines,
+  };
+
+  Type type;
+  uint32_t idx;    // Into CommandList::models(), sprites() or lines()
+};
+
+//------------------------------------------------------------------------------
+class CommandList
+{
+public:
+  void clear();
+
+  // Room for a frame of this size, so it doesn't allocate while recording
+  void reserve(size_t numModels, size_t numQuads, size_t numLineVertices);
+
+  // The view and projection every model and line draw uses
+  void setCamera(const Matrix4& worldToView, const Matrix4& viewToProjection);
+
+  void drawModel(ModelResource model, const Matrix4& world);
+
+  // Returns numQuads quads for the caller to fill in. They are valid until the
+  // next drawSprites() or clear().
+  QuadArrays<float>
+  drawSprites(const SpriteRef& sprite, BlendMode blend, size_t numQuads);
+
+  // Returns numVertices vertices of a line list (two per line) for the caller
+  // to fill in. They are valid until the next drawLines() or clear().
+  LineVertex* drawLines(size_t numVertices);
+
+  //----------------------------------------------------------------------------
+  const Matrix4& worldToView() const { return m_worldToView; }
+  const Matrix4& viewToProjection() const { return m_viewToProjection; }
+
+  const std::vector<Command>& commands() const { return m_commands; }
+  const std::vector<ModelDraw>& models() const { return m_models; }
+  const std::vector<SpriteDraw>& sprites() const { return m_sprites; }
+  const std::vector<LineDraw>& lines() const { return m_lines; }
+
+  QuadArrays<const float> quads(const SpriteDraw& draw) const;
+  const LineVertex* lineVertices(const LineDraw& draw) const
+  {
+    return m_lineVertices.data() + draw.firstVertex;
+  }
+
+private:
+  Matrix4 m_worldToView;
+  Matrix4 m_viewToProjection;
+
+  std::vector<Command> m_commands;
+  std::vector<ModelDraw> m_models;
+  std::vector<SpriteDraw> m_sprites;
+  std::vector<LineDraw> m_lines;
+
+  // Quads of every sprite draw, indexed by SpriteDraw::firstQuad
+  size_t m_numQuads = 0;
+  std::vector<float> m_quadX;
+  std::vector<float> m_quadY;
+  std::vector<float> m_quadScale;
+  std::vector<float> m_quadR;
+  std::vector<float> m_quadG;
+  std::vector<float> m_quadB;
+  std::vector<float> m_quadA;
+
+  size_t m_numLineVertices = 0;
+  std::vector<LineVertex> m_lineVertices;
+
+  void growQuads(size_t numQuads);
+  bool isLast(Command::Type type) const
+  {
+    return !m_commands.empty() && m_commands.back().type == type;
+  }
+};
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
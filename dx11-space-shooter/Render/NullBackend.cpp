@@ -0,0 +1,171 @@
+#include "Render/NullBackend.h"
+
+#include "SpriteQuads.h"
+
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace render
+{
+//------------------------------------------------------------------------------
+// Vertices per PrimitiveBatch draw, as DX::DrawLineList splits a line list
+constexpr size_t LINE_BATCH_VERTICES = 2048 - 2;
+
+// Quads SpriteBatch writes to its vertex buffer at a time (MaxBatchSize)
+constexpr size_t SPRITE_BATCH_QUADS = 2048;
+
+//------------------------------------------------------------------------------
+NullBackend::NullBackend()
+    : m_spriteVertices(SPRITE_BATCH_QUADS * DirectX::SpriteQuadFloats)
+{
+}
+
+//------------------------------------------------------------------------------
+NullBackend::Stats&
+NullBackend::Stats::operator+=(const Stats& other)
+{
+  numCommands += other.numCommands;
+  numModelDraws += other.numModelDraws;
+  numSpriteBatches += other.numSpriteBatches;
+  numQuads += other.numQuads;
+  numLineBatches += other.numLineBatches;
+  numLineVertices += other.numLineVertices;
+  numStateChanges += other.numStateChanges;
+  return *this;
+}
+
+//------------------------------------------------------------------------------
+void
+NullBackend::setTextureSize(TextureId texture, float width, float height)
+{
+  m_textures[static_cast<size_t>(texture)] = TextureSize{width, height};
+}
+
+//------------------------------------------------------------------------------
+void
+NullBackend::execute(const CommandList& list)
+{
+  TRACE
+  m_frameStats             = Stats();
+  m_frameStats.numCommands = list.commands().size();
+  m_worldToProjection      = list.worldToView() * list.viewToProjection();
+
+  // As the D3D11 backend: a run of sprite draws with the same blend is one
+  // SpriteBatch, and states are set when switching between kinds of draw
+  const Command* previous = nullptr;
+  BlendMode blend         = BlendMode::AlphaBlend;
+  for (const Command& command : list.commands())
+  {
+    const bool isNewType = !previous || previous->type != command.type;
+    m_frameStats.numStateChanges += isNewType;
+    switch (command.type)
+    {
+      case Command::Type::Model:
+        drawModel(list.models()[command.idx]);
+        break;
+
+      case Command::Type::Sprites:
+      {
+        const SpriteDraw& draw = list.sprites()[command.idx];
+        if (isNewType || draw.blend != blend)
+        {
+          m_frameStats.numSpriteBatches++;
+          blend = draw.blend;
+        }
+        drawSprites(list, draw);
+        break;
+      }
+
+      case Command::Type::Lines:
+        drawLines(list, list.lines()[command.idx]);
+        break;
+    }
+    previous = &command;
+  }
+
+  m_totalStats += m_frameStats;
+}
+
+//------------------------------------------------------------------------------
+void
+NullBackend::drawModel(const ModelDraw& draw)
+{
+  // What the model's effects are given
+  const Matrix4 worldViewProjection = draw.world * m_worldToProjection;
+  mix(&draw.model, sizeof(draw.model));
+  mix(&worldViewProjection, sizeof(worldViewProjection));
+  m_frameStats.numModelDraws++;
+}
+
+//------------------------------------------------------------------------------
+void
+NullBackend::drawSprites(const CommandList& list, const SpriteDraw& draw)
+{
+  const auto& texture = m_textures[static_cast<size_t>(draw.sprite.texture)];
+  const auto& sprite  = draw.sprite;
+
+  // As SpriteBatch::DrawQuads does with a source rectangle
+  DirectX::SpriteQuadParams params;
+  params.textureWidth  = float(sprite.right - sprite.left);
+  params.textureHeight = float(sprite.bottom - sprite.top);
+  params.uvLeft        = sprite.left / texture.width;
+  params.uvTop         = sprite.top / texture.height;
+  params.uvRight       = sprite.right / texture.width;
+  params.uvBottom      = sprite.bottom / texture.height;
+  params.originX       = sprite.originX;
+  params.originY       = sprite.originY;
+
+  const auto arrays = list.quads(draw);
+  DirectX::SpriteQuads quads;
+  quads.x     = arrays.x;
+  quads.y     = arrays.y;
+  quads.scale = arrays.scale;
+  quads.r     = arrays.r;
+  quads.g     = arrays.g;
+  quads.b     = arrays.b;
+  quads.a     = arrays.a;
+  quads.count = arrays.count;
+
+  for (size_t begin = 0; begin < quads.count; begin += SPRITE_BATCH_QUADS)
+  {
+    const size_t count = std::min(quads.count - begin, SPRITE_BATCH_QUADS);
+    DirectX::WriteSpriteQuadVertices(
+      quads, params, begin, count, m_spriteVertices.data());
+    mix(
+      m_spriteVertices.data(),
+      count * DirectX::SpriteQuadFloats * sizeof(float));
+  }
+  m_frameStats.numQuads += quads.count;
+}
+
+//------------------------------------------------------------------------------
+void
+NullBackend::drawLines(const CommandList& list, const LineDraw& draw)
+{
+  mix(list.lineVertices(draw), draw.numVertices * sizeof(LineVertex));
+  m_frameStats.numLineBatches
+    += (draw.numVertices + LINE_BATCH_VERTICES - 1) / LINE_BATCH_VERTICES;
+  m_frameStats.numLineVertices += draw.numVertices;
+}
+
+//------------------------------------------------------------------------------
+void
+NullBackend::mix(const void* data, size_t size)
+{
+  // FNV-1a, a word at a time: everything submitted is 32-bit values
+  ASSERT(size % sizeof(uint32_t) == 0);
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; i += sizeof(uint32_t))
+  {
+    uint32_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    m_checksum ^= word;
+    m_checksum *= 1099511628211ull;
+  }
+}
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
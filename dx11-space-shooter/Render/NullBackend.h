@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+// A render backend without a GPU
+//
+// Submits a CommandList the way D3D11RenderBackend does, short of talking to
+// the device: it groups the commands into the same sprite batches and line
+// batches, works out each model's transform and writes the sprite vertices
+// SpriteBatch would. It counts what it would have submitted and keeps a
+// checksum of it, so the CPU cost and output of the render path can be
+// benchmarked and compared between builds, headless.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "Render/CommandList.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace render
+{
+//------------------------------------------------------------------------------
+class NullBackend
+{
+public:
+  struct Stats
+  {
+    uint64_t numCommands      = 0;
+    uint64_t numModelDraws    = 0;
+    uint64_t numSpriteBatches = 0;    // SpriteBatch Begin/End pairs
+    uint64_t numQuads         = 0;
+    uint64_t numLineBatches   = 0;    // PrimitiveBatch draws
+    uint64_t numLineVertices  = 0;
+    uint64_t numStateChanges  = 0;    // Between models, sprites and lines
+
+    Stats& operator+=(const Stats& other);
+  };
+
+  NullBackend();
+
+  // Sprite texture coordinates are relative to the texture's size
+  void setTextureSize(TextureId texture, float width, float height);
+
+  void execute(const CommandList& list);
+
+  // Of the last list executed, and of every list since construction
+  const Stats& frameStats() const { return m_frameStats; }
+  const Stats& totalStats() const { return m_totalStats; }
+  uint64_t checksum() const { return m_checksum; }
+
+private:
+  struct TextureSize
+  {
+    float width  = 1.0f;
+    float height = 1.0f;
+  };
+
+  std::array<TextureSize, static_cast<size_t>(TextureId::COUNT)> m_textures;
+  std::vector<float> m_spriteVertices;    // SpriteBatch's vertex buffer
+
+  Matrix4 m_worldToProjection;
+
+  Stats m_frameStats;
+  Stats m_totalStats;
+  uint64_t m_checksum = 14695981039346656037ull;
+
+  void drawModel(const ModelDraw& draw);
+  void drawSprites(const CommandList& list, const SpriteDraw& draw);
+  void drawLines(const CommandList& list, const LineDraw& draw);
+  void mix(const void* data, size_t size);
+};
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+// Matrices for the render command list.
+//
+// Row-major with row vectors, laid out exactly as DirectX::SimpleMath::Matrix
+// (and XMFLOAT4X4) so the game converts with a copy. Only what recording a
+// frame needs, so it builds without DirectXMath.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cmath>
+
+namespace render
+{
+//------------------------------------------------------------------------------
+struct Matrix4
+{
+  float m[4][4] = {{1.0f, 0.0f, 0.0f, 0.0f},
+                   {0.0f, 1.0f, 0.0f, 0.0f},
+                   {0.0f, 0.0f, 1.0f, 0.0f},
+                   {0.0f, 0.0f, 0.0f, 1.0f}};
+};
+
+//------------------------------------------------------------------------------
+inline Matrix4
+operator*(const Matrix4& a, const Matrix4& b)
+{
+  Matrix4 result;
+  for (int row = 0; row < 4; ++row)
+  {
+    for (int col = 0; col < 4; ++col)
+    {
+      result.m[row][col] = a.m[row][0] * b.m[0][col]
+                           + a.m[row][1] * b.m[1][col]
+                           + a.m[row][2] * b.m[2][col]
+                           + a.m[row][3] * b.m[3][col];
+    }
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+inline Matrix4
+translation(float x, float y, float z)
+{
+  Matrix4 result;
+  result.m[3][0] = x;
+  result.m[3][1] = y;
+  result.m[3][2] = z;
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// As Matrix::CreateFromYawPitchRoll(0, 0, angle)
+inline Matrix4
+rotationZ(float angle)
+{
+  const float s = std::sin(angle);
+  const float c = std::cos(angle);
+  Matrix4 result;
+  result.m[0][0] = c;
+  result.m[0][1] = s;
+  result.m[1][0] = -s;
+  result.m[1][1] = c;
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// As Matrix::CreatePerspectiveFieldOfView (right-handed)
+inline Matrix4
+perspectiveFieldOfView(
+  float fovAngleY, float aspectRatio, float nearPlane, float farPlane)
+{
+  const float yScale = 1.0f / std::tan(fovAngleY * 0.5f);
+  const float range  = farPlane / (nearPlane - farPlane);
+  Matrix4 result;
+  result.m[0][0] = yScale / aspectRatio;
+  result.m[1][1] = yScale;
+  result.m[2][2] = range;
+  result.m[2][3] = -1.0f;
+  result.m[3][2] = range * nearPlane;
+  result.m[3][3] = 0.0f;
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Projection space to x-right y-down screen pixels (AppContext's
+// projectionToPixels)
+inline Matrix4
+projectionToPixels(float screenWidth, float screenHeight)
+{
+  Matrix4 result;
+  result.m[0][0] = screenWidth * 0.5f;
+  result.m[1][1] = -screenHeight * 0.5f;
+  result.m[3][0] = screenWidth * 0.5f;
+  result.m[3][1] = screenHeight * 0.5f;
+  return result;
+}
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,193 @@
+#include "Render/SceneRecording.h"
+#include "Render/ScreenProjection.h"
+#include "Simulation/ExplosionSim.h"
+#include "Simulation/GameSim.h"
+
+#include "utils/Log.h"
+
+#include <algorithm>
+
+namespace render
+{
+//------------------------------------------------------------------------------
+constexpr float PI = 3.14159265358979f;
+
+// DirectX::Colors
+constexpr float ORANGE_RED[4] = {1.0f, 0.270588249f, 0.0f, 1.0f};
+constexpr float YELLOW[4]     = {1.0f, 1.0f, 0.0f, 1.0f};
+constexpr float ORANGE[4]     = {1.0f, 0.647058845f, 0.0f, 1.0f};
+
+// Explosion particles
+constexpr float SCALE_MIN  = 0.5f;
+constexpr float SCALE_MAX  = 3.0f;
+constexpr float SATURATION = 0.4f;
+
+//------------------------------------------------------------------------------
+static void
+recordEntityModel(
+  CommandList& list,
+  const SimContext& context,
+  size_t entityIdx,
+  float renderAlpha,
+  float orientation = 0.0f)
+{
+  const auto& entities        = context.entities;
+  const sim::Vec3 boundCenter = context.bound(entityIdx).Center;
+  const sim::Vec3 position
+    = entities.interpolatedPosition(entityIdx, renderAlpha) + boundCenter;
+
+  // Rotated about the centre of its bound
+  const Matrix4 world
+    = translation(-boundCenter.x, -boundCenter.y, -boundCenter.z)
+      * rotationZ(orientation)
+      * translation(position.x, position.y, position.z);
+  list.drawModel(entities.model[entityIdx], world);
+}
+
+//------------------------------------------------------------------------------
+void
+recordEntityModels(
+  CommandList& list, const SimContext& context, float renderAlpha)
+{
+  TRACE
+  switch (context.playerState)
+  {
+    case PlayerState::Normal:
+      recordEntityModel(list, context, PLAYERS_IDX, renderAlpha, PI);
+      break;
+
+    case PlayerState::Dying:
+      // TODO(James): Render Player Death
+      break;
+
+    case PlayerState::Reviving:
+      // Flash the player every half second
+      if (
+        static_cast<int>(
+          context.playerReviveTimerS * GameSim::PLAYER_REVIVE_TIME_S)
+          % 2
+        != 0)
+      {
+        recordEntityModel(list, context, PLAYERS_IDX, renderAlpha, PI);
+      }
+      break;
+  }
+
+  const auto& entities = context.entities;
+  for (auto partition :
+       {Partition::PlayerShots, Partition::EnemyShots, Partition::Enemies})
+  {
+    for (size_t idx : entities.alive(partition))
+    {
+      recordEntityModel(list, context, idx, renderAlpha);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+recordShotParticles(
+  CommandList& list,
+  const SimContext& context,
+  float renderAlpha,
+  double simTimeS,
+  const Matrix4& worldToPixels,
+  const SpriteRef& sprite,
+  memory::LinearArena& arena)
+{
+  TRACE
+  const auto& entities = context.entities;
+
+  // Gather every shot, then project them all in one pass
+  const size_t numShots = entities.numAlive(Partition::PlayerShots)
+                          + entities.numAlive(Partition::EnemyShots);
+  float* x          = arena.allocate<float>(numShots);
+  float* y          = arena.allocate<float>(numShots);
+  float* z          = arena.allocate<float>(numShots);
+  float* pixelX     = arena.allocate<float>(numShots);
+  float* pixelY     = arena.allocate<float>(numShots);
+  float* saturation = arena.allocate<float>(numShots);
+
+  static const float SATURATION_DECAY = 1.2f;
+  size_t shotIdx                      = 0;
+  for (auto partition : {Partition::PlayerShots, Partition::EnemyShots})
+  {
+    for (size_t idx : entities.alive(partition))
+    {
+      const sim::Vec3 position
+        = entities.interpolatedPosition(idx, renderAlpha);
+      x[shotIdx] = position.x;
+      y[shotIdx] = position.y;
+      z[shotIdx] = position.z;
+
+      const float aliveS
+        = static_cast<float>(simTimeS - entities.birthTimeS[idx]);
+      saturation[shotIdx]
+        = 1.0f - std::clamp((aliveS * SATURATION_DECAY), 0.0f, 1.0f);
+      shotIdx++;
+    }
+  }
+  projectToPixels(worldToPixels, x, y, z, numShots, pixelX, pixelY);
+
+  // Each shot is an outer glow with a core drawn over it, interleaved so
+  // overlapping shots still layer the same way
+  auto quads = list.drawSprites(sprite, BlendMode::Additive, numShots * 2);
+
+  static const float OUTER_SCALE = 1.0f;
+  static const float CORE_SCALE  = 0.5f;
+  for (size_t i = 0; i < numShots; ++i)
+  {
+    const float growth = 1.0f + 2.0f * saturation[i];
+    for (size_t layer = 0; layer < 2; ++layer)
+    {
+      const float* color = layer ? YELLOW : ORANGE_RED;
+      const size_t q     = i * 2 + layer;
+      quads.x[q]         = pixelX[i];
+      quads.y[q]         = pixelY[i];
+      quads.scale[q]     = (layer ? CORE_SCALE : OUTER_SCALE) * growth;
+      quads.r[q]         = color[0] + saturation[i];
+      quads.g[q]         = color[1] + saturation[i];
+      quads.b[q]         = color[2] + saturation[i];
+      quads.a[q]         = color[3];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+recordExplosions(
+  CommandList& list,
+  const ExplosionSim& explosions,
+  const Matrix4& worldToPixels,
+  const SpriteRef& sprite)
+{
+  TRACE
+  // Particles live in world space, so they follow the camera
+  const auto& particles     = explosions.particles();
+  const size_t numParticles = explosions.numParticles();
+  auto quads = list.drawSprites(sprite, BlendMode::Additive, numParticles);
+  projectToPixels(
+    worldToPixels,
+    particles.x.data(),
+    particles.y.data(),
+    particles.z.data(),
+    numParticles,
+    quads.x,
+    quads.y);
+
+  for (size_t i = 0; i < numParticles; ++i)
+  {
+    float energyRatio
+      = particles.energy[i] / (ExplosionSim::ENERGY_MAX - SATURATION);
+    float saturation = (energyRatio > 1.0f) ? energyRatio - 1.0f : 0.0f;
+    quads.r[i]       = ORANGE[0] + saturation;
+    quads.g[i]       = ORANGE[1] + saturation;
+    quads.b[i]       = ORANGE[2] + saturation;
+    quads.a[i]       = energyRatio;
+    quads.scale[i]   = (energyRatio * (SCALE_MAX - SCALE_MIN)) + SCALE_MIN;
+  }
+}
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
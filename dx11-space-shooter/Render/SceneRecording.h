@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------
+// Records the gameplay world into a render::CommandList
+//
+// What GameLogic and Explosions draw each frame, written against the
+// simulation state only, so the headless runner records exactly the same
+// commands as the game does.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "Render/CommandList.h"
+#include "Simulation/SimContext.h"
+
+class ExplosionSim;
+
+namespace render
+{
+//------------------------------------------------------------------------------
+// Entities are drawn at their positions interpolated by renderAlpha (see
+// EntityStore::interpolatedPosition)
+//------------------------------------------------------------------------------
+void
+recordEntityModels(
+  CommandList& list, const SimContext& context, float renderAlpha);
+
+// Shots glow brighter the younger they are. Scratch arrays come from arena.
+void
+recordShotParticles(
+  CommandList& list,
+  const SimContext& context,
+  float renderAlpha,
+  double simTimeS,
+  const Matrix4& worldToPixels,
+  const SpriteRef& sprite,
+  memory::LinearArena& arena);
+
+void
+recordExplosions(
+  CommandList& list,
+  const ExplosionSim& explosions,
+  const Matrix4& worldToPixels,
+  const SpriteRef& sprite);
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
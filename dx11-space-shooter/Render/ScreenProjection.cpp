@@ -0,0 +1,72 @@
+#include "Render/ScreenProjection.h"
+
+#if defined(__SSE2__) || defined(_M_X64)                                       \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RENDER_PROJECTION_SSE2
+#include <xmmintrin.h>
+#endif
+
+namespace render
+{
+//------------------------------------------------------------------------------
+void
+projectToPixels(
+  const Matrix4& worldToPixels,
+  const float* x,
+  const float* y,
+  const float* z,
+  size_t count,
+  float* pixelX,
+  float* pixelY)
+{
+  // Row vectors: pixel = (x, y, z, 1) * worldToPixels, then divide by w
+  const auto& m = worldToPixels.m;
+  size_t i      = 0;
+
+#if defined(RENDER_PROJECTION_SSE2)
+  const __m128 m11 = _mm_set1_ps(m[0][0]);
+  const __m128 m21 = _mm_set1_ps(m[1][0]);
+  const __m128 m31 = _mm_set1_ps(m[2][0]);
+  const __m128 m41 = _mm_set1_ps(m[3][0]);
+  const __m128 m12 = _mm_set1_ps(m[0][1]);
+  const __m128 m22 = _mm_set1_ps(m[1][1]);
+  const __m128 m32 = _mm_set1_ps(m[2][1]);
+  const __m128 m42 = _mm_set1_ps(m[3][1]);
+  const __m128 m14 = _mm_set1_ps(m[0][3]);
+  const __m128 m24 = _mm_set1_ps(m[1][3]);
+  const __m128 m34 = _mm_set1_ps(m[2][3]);
+  const __m128 m44 = _mm_set1_ps(m[3][3]);
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128 vx = _mm_loadu_ps(x + i);
+    const __m128 vy = _mm_loadu_ps(y + i);
+    const __m128 vz = _mm_loadu_ps(z + i);
+
+    __m128 sx = _mm_add_ps(_mm_mul_ps(vx, m11), m41);
+    sx        = _mm_add_ps(_mm_mul_ps(vy, m21), sx);
+    sx        = _mm_add_ps(_mm_mul_ps(vz, m31), sx);
+    __m128 sy = _mm_add_ps(_mm_mul_ps(vx, m12), m42);
+    sy        = _mm_add_ps(_mm_mul_ps(vy, m22), sy);
+    sy        = _mm_add_ps(_mm_mul_ps(vz, m32), sy);
+    __m128 sw = _mm_add_ps(_mm_mul_ps(vx, m14), m44);
+    sw        = _mm_add_ps(_mm_mul_ps(vy, m24), sw);
+    sw        = _mm_add_ps(_mm_mul_ps(vz, m34), sw);
+
+    _mm_storeu_ps(pixelX + i, _mm_div_ps(sx, sw));
+    _mm_storeu_ps(pixelY + i, _mm_div_ps(sy, sw));
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    const float sx = x[i] * m[0][0] + y[i] * m[1][0] + z[i] * m[2][0] + m[3][0];
+    const float sy = x[i] * m[0][1] + y[i] * m[1][1] + z[i] * m[2][1] + m[3][1];
+    const float sw = x[i] * m[0][3] + y[i] * m[1][3] + z[i] * m[2][3] + m[3][3];
+    pixelX[i]      = sx / sw;
+    pixelY[i]      = sy / sw;
+  }
+}
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Render/RenderMath.h"
+
+#include <cstddef>
+
+namespace render
+{
+//------------------------------------------------------------------------------
+// Batched projection of world space points to screen pixels.
+//
+// SpriteBatch requires everything in x-right y-down screen PIXEL coordinates
+// and does it's own orthographic projection internally (see
+// SpriteBatch::Impl::GetViewportTransform()), so world space sprites are
+// projected on the CPU before drawing. The points are flat arrays and go
+// through the transform four at a time on SSE2, with a scalar loop for the
+// remainder and for other platforms.
+//
+// worldToPixels is AppContext::worldToPixels.
+//------------------------------------------------------------------------------
+void
+projectToPixels(
+  const Matrix4& worldToPixels,
+  const float* x,
+  const float* y,
+  const float* z,
+  size_t count,
+  float* pixelX,
+  float* pixelY);
+
+}    // namespace render
+
+//------------------------------------------------------------------------------
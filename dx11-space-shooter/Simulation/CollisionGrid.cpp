@@ -0,0 +1,136 @@
+#include "Simulation/CollisionGrid.h"
+
+#include "utils/Log.h"
+
+#include <cmath>
+
+//------------------------------------------------------------------------------
+CollisionGrid::CollisionGrid(
+  float minX,
+  float minY,
+  float maxX,
+  float maxY,
+  float cellSize,
+  size_t baseIdx,
+  size_t capacity)
+    : m_minX(minX)
+    , m_minY(minY)
+    , m_invCellSize(1.0f / cellSize)
+    , m_numCellsX(std::max(1, int32_t(std::ceil((maxX - minX) / cellSize))))
+    , m_numCellsY(std::max(1, int32_t(std::ceil((maxY - minY) / cellSize))))
+    , m_head(m_numCellsX * m_numCellsY, NONE)
+{
+  ASSERT(cellSize > 0.0f);
+  resize(baseIdx, capacity);
+}
+
+//------------------------------------------------------------------------------
+void
+CollisionGrid::resize(size_t baseIdx, size_t capacity)
+{
+  m_baseIdx = baseIdx;
+  m_cell.assign(capacity, NONE);
+  m_next.assign(capacity, NONE);
+  m_prev.assign(capacity, NONE);
+  m_memberPos.assign(capacity, NONE);
+  m_members.clear();
+  m_members.reserve(capacity);
+  std::fill(m_head.begin(), m_head.end(), NONE);
+  m_maxRadius = 0.0f;
+}
+
+//------------------------------------------------------------------------------
+void
+CollisionGrid::update(size_t idx, float x, float y, float radius)
+{
+  ASSERT(idx >= m_baseIdx && idx - m_baseIdx < m_cell.size());
+  const int32_t slot = static_cast<int32_t>(idx - m_baseIdx);
+  const int32_t cell = cellOf(x, y);
+  m_maxRadius        = std::max(m_maxRadius, radius);
+
+  if (m_cell[slot] == cell)
+  {
+    return;
+  }
+
+  if (m_cell[slot] == NONE)
+  {
+    m_memberPos[slot] = static_cast<int32_t>(m_members.size());
+    m_members.push_back(slot);
+  }
+  else
+  {
+    unlink(slot);
+  }
+  link(slot, cell);
+}
+
+//------------------------------------------------------------------------------
+void
+CollisionGrid::remove(size_t idx)
+{
+  ASSERT(idx >= m_baseIdx && idx - m_baseIdx < m_cell.size());
+  const int32_t slot = static_cast<int32_t>(idx - m_baseIdx);
+  if (m_cell[slot] == NONE)
+  {
+    return;
+  }
+  unlink(slot);
+  m_cell[slot] = NONE;
+
+  // Swap remove from the dense member list
+  const int32_t pos  = m_memberPos[slot];
+  const int32_t last = m_members.back();
+  m_members[pos]     = last;
+  m_memberPos[last]  = pos;
+  m_members.pop_back();
+  m_memberPos[slot] = NONE;
+}
+
+//------------------------------------------------------------------------------
+void
+CollisionGrid::clear()
+{
+  std::fill(m_head.begin(), m_head.end(), NONE);
+  std::fill(m_cell.begin(), m_cell.end(), NONE);
+  std::fill(m_memberPos.begin(), m_memberPos.end(), NONE);
+  m_members.clear();
+  m_maxRadius = 0.0f;
+}
+
+//------------------------------------------------------------------------------
+void
+CollisionGrid::link(int32_t slot, int32_t cell)
+{
+  const int32_t head = m_head[cell];
+  m_next[slot]       = head;
+  m_prev[slot]       = NONE;
+  if (head != NONE)
+  {
+    m_prev[head] = slot;
+  }
+  m_head[cell] = slot;
+  m_cell[slot] = cell;
+}
+
+//------------------------------------------------------------------------------
+void
+CollisionGrid::unlink(int32_t slot)
+{
+  const int32_t next = m_next[slot];
+  const int32_t prev = m_prev[slot];
+  if (prev != NONE)
+  {
+    m_next[prev] = next;
+  }
+  else
+  {
+    m_head[m_cell[slot]] = next;
+  }
+  if (next != NONE)
+  {
+    m_prev[next] = prev;
+  }
+}
+
+//------------------------------------------------------------------------------
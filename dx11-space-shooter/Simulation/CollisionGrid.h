@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+// Uniform grid broadphase for sphere collision tests.
+//
+// Covers a fixed 2D area (x/y) split into square cells. Each tracked entity
+// lives in the cell containing its bound centre, linked into a per-cell list,
+// so moving between cells is O(1) and entities that stay in their cell cost
+// nothing. Positions outside the area are clamped to the edge cells, which
+// keeps queries conservative.
+//
+// Entities are identified by index in [baseIdx, baseIdx + capacity).
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------
+class CollisionGrid
+{
+public:
+  CollisionGrid(
+    float minX,
+    float minY,
+    float maxX,
+    float maxY,
+    float cellSize,
+    size_t baseIdx,
+    size_t capacity);
+
+  // Changes the tracked index range. Clears the grid.
+  void resize(size_t baseIdx, size_t capacity);
+  size_t baseIdx() const { return m_baseIdx; }
+  size_t capacity() const { return m_cell.size(); }
+
+  // Inserts the entity, or relinks it if it has moved to another cell
+  void update(size_t idx, float x, float y, float radius);
+  void remove(size_t idx);
+  void clear();
+
+  // Removes every tracked entity for which pred(idx) returns true
+  template <typename Pred>
+  void removeIf(Pred pred);
+
+  // Calls visit(idx) for every tracked entity whose cell overlaps the square
+  // around (x, y) that contains a sphere of the given radius plus the largest
+  // radius tracked. Candidates still need an exact test.
+  template <typename Func>
+  void query(float x, float y, float radius, Func visit) const;
+
+  size_t size() const { return m_members.size(); }
+  size_t numCells() const { return m_head.size(); }
+
+private:
+  static constexpr int32_t NONE = -1;
+
+  int32_t cellCoord(float v, float min, int32_t numCells) const
+  {
+    // Clamp before converting, far away positions would overflow the int
+    const float c = std::min(
+      std::max((v - min) * m_invCellSize, 0.0f), float(numCells - 1));
+    return static_cast<int32_t>(c);
+  }
+  int32_t cellOf(float x, float y) const
+  {
+    return cellCoord(y, m_minY, m_numCellsY) * m_numCellsX
+           + cellCoord(x, m_minX, m_numCellsX);
+  }
+
+  void link(int32_t slot, int32_t cell);
+  void unlink(int32_t slot);
+
+  float m_minX;
+  float m_minY;
+  float m_invCellSize;
+  int32_t m_numCellsX;
+  int32_t m_numCellsY;
+  size_t m_baseIdx  = 0;
+  float m_maxRadius = 0.0f;
+
+  // Per cell: first slot in the cell's list
+  std::vector<int32_t> m_head;
+
+  // Per slot (idx - baseIdx)
+  std::vector<int32_t> m_cell;
+  std::vector<int32_t> m_next;
+  std::vector<int32_t> m_prev;
+  std::vector<int32_t> m_memberPos;
+
+  // Dense list of tracked slots
+  std::vector<int32_t> m_members;
+};
+
+//------------------------------------------------------------------------------
+template <typename Pred>
+void
+CollisionGrid::removeIf(Pred pred)
+{
+  for (size_t i = 0; i < m_members.size();)
+  {
+    const int32_t slot = m_members[i];
+    if (pred(m_baseIdx + slot))
+    {
+      remove(m_baseIdx + slot);    // Swaps the last member into i
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename Func>
+void
+CollisionGrid::query(float x, float y, float radius, Func visit) const
+{
+  const float extent   = radius + m_maxRadius;
+  const int32_t startX = cellCoord(x - extent, m_minX, m_numCellsX);
+  const int32_t endX   = cellCoord(x + extent, m_minX, m_numCellsX);
+  const int32_t startY = cellCoord(y - extent, m_minY, m_numCellsY);
+  const int32_t endY   = cellCoord(y + extent, m_minY, m_numCellsY);
+
+  for (int32_t cy = startY; cy <= endY; ++cy)
+  {
+    for (int32_t cx = startX; cx <= endX; ++cx)
+    {
+      for (int32_t slot = m_head[cy * m_numCellsX + cx]; slot != NONE;
+           slot         = m_next[slot])
+      {
+        visit(m_baseIdx + slot);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -1,27 +1,34 @@
-#include "pch.h"
-#include "Enemies.h"
-#include "AppContext.h"
-#include "AppResources.h"
-#include "StepTimer.h"
+#include "Simulation/Enemies.h"
+#include "Simulation/SimContext.h"
+#include "Simulation/SimClock.h"
+#include "Simulation/SimRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "utils/Log.h"
 
-using namespace DirectX;
-using namespace DirectX::SimpleMath;
+using sim::Vec3;
 
 constexpr float SHOT_SPEED                  = 40.0f;
 constexpr float ENEMY_SHOT_SPEED            = 25.0f;
 constexpr float SHOOT_DELAY                 = 0.3f;
 constexpr float ENEMY_SPAWN_OFFSET_TIME_SEC = 0.5f;
 
-using UniRandFloat = std::uniform_real_distribution<float>;
-using UniRandIdx   = std::uniform_int_distribution<size_t>;
-static UniRandFloat shotTimeRand(0.5f, 1.0f);
+constexpr float SHOT_TIME_MIN_S = 0.5f;
+constexpr float SHOT_TIME_MAX_S = 1.0f;
 
 //------------------------------------------------------------------------------
-Enemies::Enemies(AppContext& context, AppResources& resources)
+Enemies::Enemies(
+  SimContext& context,
+  const sim::IClock& clock,
+  sim::Random& random,
+  ISimEventListener& listener)
     : m_context(context)
-    , m_resources(resources)
+    , m_clock(clock)
+    , m_random(random)
+    , m_listener(listener)
     , m_currentLevelIdx(0)
     , m_nextEventWaveIdx(0)
 {
@@ -60,10 +67,10 @@ Enemies::addDummyData()
   static const Path nullPath = {
     L"nullPath",
     {
-      {Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 0.0f)},
+      {Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f)},
     },
   };
-  m_pathPool.emplace_back(nullPath);
+  m_pathPool.emplace_back(nullPath).bake();
 
   const int shipCount = 0;
   auto& formation     = m_formationPool.emplace_back(Formation());
@@ -83,15 +90,11 @@ Enemies::reset()
   m_currentLevelIdx  = 0;
   m_nextEventWaveIdx = 0;
 
-  float currentTimeS
-    = static_cast<float>(m_resources.m_timer.GetTotalSeconds());
-  m_nextShotTimeS = currentTimeS + shotTimeRand(m_resources.randEngine);
+  float currentTimeS = static_cast<float>(m_clock.GetTotalSeconds());
+  m_nextShotTimeS
+    = currentTimeS + m_random.uniformFloat(SHOT_TIME_MIN_S, SHOT_TIME_MAX_S);
 
-  for (size_t i = ENEMIES_IDX; i < ENEMIES_END; ++i)
-  {
-    m_context.entities[i].isAlive     = false;
-    m_context.entities[i].isColliding = false;
-  }
+  m_context.entities.clear(Partition::Enemies);
 
   m_isLevelActive = false;
   if (
@@ -100,11 +103,12 @@ Enemies::reset()
   {
     m_isLevelActive = true;
   }
+  applyLevelPools();
 }
 
 //------------------------------------------------------------------------------
 void
-Enemies::update(const DX::StepTimer& timer)
+Enemies::update(const sim::IClock& timer)
 {
   TRACE
   float currentTimeS = static_cast<float>(timer.GetTotalSeconds());
@@ -115,44 +119,37 @@ Enemies::update(const DX::StepTimer& timer)
   // Spawn enemy shots
   if (currentTimeS >= m_nextShotTimeS)
   {
-    m_nextShotTimeS = currentTimeS + shotTimeRand(m_resources.randEngine);
-
-    auto canShoot = [currentTimeS](Entity& enemy) {
-      return enemy.isAlive && (currentTimeS > enemy.birthTimeS + SHOOT_DELAY);
-    };
-
-    std::vector<size_t> shooterCandidateIdxs;
-    for (size_t i = ENEMIES_IDX; i < ENEMIES_END; ++i)
+    m_nextShotTimeS
+      = currentTimeS + m_random.uniformFloat(SHOT_TIME_MIN_S, SHOT_TIME_MAX_S);
+
+    const auto& entities = m_context.entities;
+    memory::ArenaVector<size_t> shooterCandidateIdxs{
+      memory::ArenaAllocator<size_t>(m_context.frameArena)};
+    shooterCandidateIdxs.reserve(entities.numAlive(Partition::Enemies));
+    for (size_t i : entities.alive(Partition::Enemies))
     {
-      if (canShoot(m_context.entities[i]))
+      if (currentTimeS > entities.birthTimeS[i] + SHOOT_DELAY)
       {
         shooterCandidateIdxs.push_back(i);
       }
     }
     if (!shooterCandidateIdxs.empty())
     {
-      UniRandIdx enemyIdxRand(0, shooterCandidateIdxs.size() - 1);
-      size_t candidateIdx = enemyIdxRand(m_resources.randEngine);
+      size_t candidateIdx = m_random.uniformIndex(shooterCandidateIdxs.size());
       size_t enemyIdx     = shooterCandidateIdxs[candidateIdx];
-      ASSERT(enemyIdx < ENEMIES_END);
-
-      emitShot(
-        m_context.entities[enemyIdx],
-        -1.0f,
-        -ENEMY_SHOT_SPEED,
-        m_context.nextEnemyShotIdx,
-        ENEMY_SHOTS_IDX,
-        ENEMY_SHOTS_END);
-      m_resources.soundEffects[AudioResource::EnemyShot]->Play();
+
+      if (emitShot(enemyIdx, -1.0f, -ENEMY_SHOT_SPEED, Partition::EnemyShots))
+      {
+        m_listener.onSimEvent(
+          SimEvent::EnemyShot, entities.position(enemyIdx));
+      }
     }
   }
-
-  performPhysicsUpdate();
 }
 
 //------------------------------------------------------------------------------
 void
-Enemies::incrementCurrentTime(const DX::StepTimer& timer)
+Enemies::incrementCurrentTime(const sim::IClock& timer)
 {
   m_currentLevelTimeS += static_cast<float>(timer.GetElapsedSeconds());
 }
@@ -175,6 +172,7 @@ Enemies::updateLevel()
     {
       m_isLevelActive = true;
       resetCurrentTime();
+      applyLevelPools();
     }
     return;
   }
@@ -184,6 +182,18 @@ Enemies::updateLevel()
   // End of level
   if (m_nextEventWaveIdx >= level.waves.size())
   {
+    const auto& entities = m_context.entities;
+    LOG_DEBUG(
+      "Pool high-water marks after level %zu - player shots: %zu/%zu, enemy "
+      "shots: %zu/%zu, enemies: %zu/%zu",
+      m_currentLevelIdx,
+      entities.highWaterMark(Partition::PlayerShots),
+      entities.capacity().playerShots,
+      entities.highWaterMark(Partition::EnemyShots),
+      entities.capacity().enemyShots,
+      entities.highWaterMark(Partition::Enemies),
+      entities.capacity().enemies);
+
     m_isLevelActive    = false;
     m_nextEventWaveIdx = 0;
     m_currentLevelIdx++;
@@ -200,8 +210,7 @@ Enemies::updateLevel()
   auto& nextWave = level.waves[m_nextEventWaveIdx];
   if (m_currentLevelTimeS >= nextWave.spawnTimeS)
   {
-    float currentTimeS
-      = static_cast<float>(m_resources.m_timer.GetTotalSeconds());
+    float currentTimeS = static_cast<float>(m_clock.GetTotalSeconds());
     spawnFormation(nextWave.formationIdx, currentTimeS);
     m_nextEventWaveIdx++;
   }
@@ -211,14 +220,7 @@ Enemies::updateLevel()
 bool
 Enemies::isAnyEnemyAlive() const
 {
-  for (size_t i = ENEMIES_IDX; i < ENEMIES_END; ++i)
-  {
-    if (m_context.entities[i].isAlive)
-    {
-      return true;
-    }
-  }
-  return false;
+  return m_context.entities.anyAlive(Partition::Enemies);
 }
 
 //------------------------------------------------------------------------------
@@ -243,6 +245,7 @@ Enemies::jumpToWave(const size_t waveIdx)
     m_nextEventWaveIdx  = waveIdx;
     m_isLevelActive     = true;
     m_currentLevelTimeS = level.waves[waveIdx].spawnTimeS;
+    applyLevelPools();
   }
 }
 
@@ -272,16 +275,16 @@ Enemies::spawnFormationSection(
   for (int ship = 0; ship < numShips; ++ship)
   {
     // Spawn enemy
-    auto& newEnemy      = m_context.entities[m_context.nextEnemyIdx];
-    newEnemy.pathIdx    = pathIdx;
-    newEnemy.isAlive    = true;
-    newEnemy.birthTimeS = birthTimeS + delayS;
-    newEnemy.model      = &m_resources.modelData[model];
-    m_context.nextEnemyIdx++;
-    if (m_context.nextEnemyIdx >= ENEMIES_END)
+    auto& entities   = m_context.entities;
+    const size_t idx = entities.spawn(Partition::Enemies);
+    if (idx == EntityStore::INVALID_IDX)
     {
-      m_context.nextEnemyIdx = ENEMIES_IDX;
+      LOG_WARNING("Enemy pool is full, %d ships not spawned", numShips - ship);
+      break;
     }
+    entities.pathIdx[idx]    = pathIdx;
+    entities.birthTimeS[idx] = birthTimeS + delayS;
+    entities.model[idx]      = model;
     delayS += ENEMY_SPAWN_OFFSET_TIME_SEC;
   }
 }
@@ -290,7 +293,7 @@ Enemies::spawnFormationSection(
 void
 Enemies::spawnFormation(const size_t formationIdx)
 {
-  float now = static_cast<float>(m_resources.m_timer.GetTotalSeconds());
+  float now = static_cast<float>(m_clock.GetTotalSeconds());
   spawnFormation(formationIdx, now);
 }
 
@@ -299,93 +302,87 @@ void
 Enemies::spawnFormationSection(
   const int numShips, const size_t pathIdx, const ModelResource model)
 {
-  float now = static_cast<float>(m_resources.m_timer.GetTotalSeconds());
+  float now = static_cast<float>(m_clock.GetTotalSeconds());
   spawnFormationSection(numShips, pathIdx, model, now);
 }
 
-//------------------------------------------------------------------------------
-static FXMVECTOR
-bezier(FLOAT t, FXMVECTOR startPos, FXMVECTOR endPos, FXMVECTOR control)
-{
-  // https://pomax.github.io/bezierinfo/
-  float t2  = t * t;
-  float mt  = 1 - t;
-  float mt2 = mt * mt;
-  return (startPos * mt2) + (control * (2 * mt * t)) + (endPos * t2);
-}
-
 //------------------------------------------------------------------------------
 void
 Enemies::performPhysicsUpdate()
 {
   TRACE
+  auto& entities = m_context.entities;
+  integrateEnemies(
+    entities.beginWord(Partition::Enemies),
+    entities.endWord(Partition::Enemies));
+  entities.applyDespawnRequests();
+}
 
-  // TODO(James): make the ships move at constant speed.
-  // At the moment it looks bad that the speed changes suddenly
-  // when moving between curves
-  static const float SEGMENT_DURATION_S = 1.2f;
+//------------------------------------------------------------------------------
+sim::JobSystem::Job*
+Enemies::schedulePhysicsUpdate(sim::JobSystem& jobs)
+{
+  constexpr size_t GRAIN_WORDS = 1;
+
+  const auto& entities   = m_context.entities;
+  const size_t beginWord = entities.beginWord(Partition::Enemies);
+  return jobs.parallelFor(
+    "EnemyPhysics",
+    entities.endWord(Partition::Enemies) - beginWord,
+    GRAIN_WORDS,
+    [this, beginWord](size_t begin, size_t end) {
+      integrateEnemies(beginWord + begin, beginWord + end);
+    });
+}
 
-  for (size_t i = ENEMIES_IDX; i < ENEMIES_END; ++i)
+//------------------------------------------------------------------------------
+void
+Enemies::integrateEnemies(size_t beginWord, size_t endWord)
+{
+  auto& entities    = m_context.entities;
+  const double nowS = m_clock.GetTotalSeconds();
+  for (size_t i : entities.aliveInWords(beginWord, endWord))
   {
-    auto& e = m_context.entities[i];
-    if (!e.isAlive)
-    {
-      continue;
-    }
-    ASSERT(e.pathIdx < m_pathPool.size());
-    const auto& path   = m_pathPool[e.pathIdx];
-    const float aliveS = static_cast<float>(
-      m_resources.m_timer.GetTotalSeconds() - e.birthTimeS);
-    if (aliveS < 0.0f)
-    {
-      ASSERT(!path.waypoints.empty());
-      e.position = path.waypoints[0].wayPoint;
-      continue;
-    }
+    ASSERT(entities.pathIdx[i] < m_pathPool.size());
+    const auto& path   = m_pathPool[entities.pathIdx[i]];
+    const float aliveS = static_cast<float>(nowS - entities.birthTimeS[i]);
 
-    // Enemy finished it's route
-    const size_t currentSegment
-      = static_cast<size_t>(floor(aliveS / SEGMENT_DURATION_S));
-    if (currentSegment >= path.waypoints.size() - 1)
+    // Enemy finished it's route. Ships waiting to start sit at the beginning.
+    if (aliveS >= path.durationS)
     {
-      e.isAlive = false;
+      entities.requestDespawn(i);
       continue;
     }
 
-    const float t = fmod(aliveS, SEGMENT_DURATION_S) / SEGMENT_DURATION_S;
-    e.position    = bezier(
-      t,
-      path.waypoints[currentSegment].wayPoint,
-      path.waypoints[currentSegment + 1].wayPoint,
-      path.waypoints[currentSegment + 1].controlPoint);
+    entities.setPosition(i, path.positionAtTime(aliveS));
   }
 }
 
 //------------------------------------------------------------------------------
-void
+bool
 Enemies::emitShot(
-  const Entity& emitter,
+  const size_t emitterIdx,
   const float yPosScale,
   const float speed,
-  size_t& shotEntityIdx,
-  const size_t minEntityIdx,
-  const size_t maxEntityIdxPlusOne)
+  const Partition shots)
 {
   TRACE
-  auto& newShot   = m_context.entities[shotEntityIdx];
-  newShot.isAlive = true;
-  newShot.position
-    = emitter.position + emitter.model->bound.Center
-      + Vector3(0.0f, (yPosScale * emitter.model->bound.Radius), 0.0f);
-  newShot.velocity = Vector3(0.0f, speed, 0.0f);
-  newShot.birthTimeS
-    = static_cast<float>(m_resources.m_timer.GetTotalSeconds());
-
-  shotEntityIdx++;
-  if (shotEntityIdx >= maxEntityIdxPlusOne)
+  auto& entities             = m_context.entities;
+  const size_t shotEntityIdx = entities.spawn(shots);
+  if (shotEntityIdx == EntityStore::INVALID_IDX)
   {
-    shotEntityIdx = minEntityIdx;
+    return false;
   }
+
+  const auto& emitterBound = m_context.bound(emitterIdx);
+  entities.setPosition(
+    shotEntityIdx,
+    entities.position(emitterIdx) + emitterBound.Center
+      + Vec3(0.0f, (yPosScale * emitterBound.Radius), 0.0f));
+  entities.setVelocity(shotEntityIdx, Vec3(0.0f, speed, 0.0f));
+  entities.birthTimeS[shotEntityIdx]
+    = static_cast<float>(m_clock.GetTotalSeconds());
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -393,15 +390,11 @@ void
 Enemies::emitPlayerShot()
 {
   TRACE
-  emitShot(
-    m_context.entities[PLAYERS_IDX],
-    1.0f,
-    SHOT_SPEED,
-    m_context.nextPlayerShotIdx,
-    PLAYER_SHOTS_IDX,
-    PLAYER_SHOTS_END);
-
-  m_resources.soundEffects[AudioResource::PlayerShot]->Play();
+  if (emitShot(PLAYERS_IDX, 1.0f, SHOT_SPEED, Partition::PlayerShots))
+  {
+    m_listener.onSimEvent(
+      SimEvent::PlayerShot, m_context.entities.position(PLAYERS_IDX));
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -411,6 +404,7 @@ Enemies::load()
   TRACE
   resetLevelData();
   LevelData::load(m_pathPool, m_formationPool, m_levels);
+  configurePools();
 }
 
 //------------------------------------------------------------------------------
@@ -433,24 +427,47 @@ Enemies::save()
 
 //------------------------------------------------------------------------------
 void
-Enemies::debugRender(DX::DebugBatchType* batch)
+Enemies::configurePools()
 {
   TRACE
-  std::set<size_t> pathsToRender;
-  for (size_t i = ENEMIES_IDX; i < ENEMIES_END; ++i)
+  // NB: The dummy level isn't real content, it just uses the defaults
+  PoolSizes capacity = {0, 0, 0};
+  for (size_t i = DUMMY_LEVEL_IDX + 1; i < m_levels.size(); ++i)
   {
-    const auto& e = m_context.entities[i];
-    if (e.isAlive && e.pathIdx < m_pathPool.size())
-    {
-      pathsToRender.insert(e.pathIdx);
-    }
+    const auto& pools    = m_levels[i].pools;
+    capacity.playerShots = std::max(capacity.playerShots, pools.playerShots);
+    capacity.enemyShots  = std::max(capacity.enemyShots, pools.enemyShots);
+    capacity.enemies     = std::max(capacity.enemies, pools.enemies);
+  }
+  if (m_levels.size() <= DUMMY_LEVEL_IDX + 1)
+  {
+    capacity = PoolSizes();
+  }
+
+  auto& entities = m_context.entities;
+  if (capacity != entities.capacity())
+  {
+    entities.configure(capacity);
   }
+  applyLevelPools();
+}
 
-  for (const auto& pathIdx : pathsToRender)
+//------------------------------------------------------------------------------
+void
+Enemies::applyLevelPools()
+{
+  if (m_currentLevelIdx >= m_levels.size())
   {
-    ASSERT(pathIdx < m_pathPool.size());
-    m_pathPool[pathIdx].debugRender(batch);
+    return;
   }
+
+  auto& entities    = m_context.entities;
+  const auto& pools = (m_currentLevelIdx == DUMMY_LEVEL_IDX)
+                        ? entities.capacity()
+                        : m_levels[m_currentLevelIdx].pools;
+  entities.setLimit(Partition::PlayerShots, pools.playerShots);
+  entities.setLimit(Partition::EnemyShots, pools.enemyShots);
+  entities.setLimit(Partition::Enemies, pools.enemies);
 }
 
 //------------------------------------------------------------------------------
@@ -1,31 +1,43 @@
 #pragma once
 
-#include "LevelData.h"
+#include "Simulation/JobSystem.h"
+#include "Simulation/LevelData.h"
 
-namespace DX
+namespace sim
 {
-class StepTimer;
-};
-struct AppContext;
-struct AppResources;
-struct Entity;
+class IClock;
+class Random;
+}
+struct SimContext;
+class ISimEventListener;
 
 //------------------------------------------------------------------------------
 class Enemies
 {
 public:
-  Enemies(AppContext& context, AppResources& resources);
+  Enemies(
+    SimContext& context,
+    const sim::IClock& clock,
+    sim::Random& random,
+    ISimEventListener& listener);
   void resetLevelData();
   void reset();
-  void update(const DX::StepTimer& timer);
+  // Level events, spawning and enemy fire. Movement is a separate pass, see
+  // performPhysicsUpdate().
+  void update(const sim::IClock& timer);
 
-  void incrementCurrentTime(const DX::StepTimer& timer);
+  void incrementCurrentTime(const sim::IClock& timer);
   void resetCurrentTime();
   float currentLevelTimeS() const { return m_currentLevelTimeS; }
 
   void updateLevel();
   void performPhysicsUpdate();
 
+  // Moves the enemies in ranges of bitset words, on the job system's threads.
+  // Finished enemies are left for EntityStore::applyDespawnRequests().
+  sim::JobSystem::Job* schedulePhysicsUpdate(sim::JobSystem& jobs);
+  void integrateEnemies(size_t beginWord, size_t endWord);
+
   bool isAnyEnemyAlive() const;
   void jumpToLevel(const size_t levelIdx);
   void jumpToWave(const size_t waveIdx);
@@ -41,19 +53,21 @@ public:
   void spawnFormationSection(
     const int numShips, const size_t pathIdx, const ModelResource model);
 
-  void emitShot(
-    const Entity& emitter,
+  // Returns false if the shot pool is full
+  bool emitShot(
+    const size_t emitterIdx,
     const float yPosScale,
     const float speed,
-    size_t& shotEntityIdx,
-    const size_t minEntityIdx,
-    const size_t maxEntityIdxPlusOne);
+    const Partition shots);
 
   void emitPlayerShot();
 
   void load();
   void save();
-  void debugRender(DX::DebugBatchType* batch);
+
+  // Sizes the entity pools for the most demanding level
+  void configurePools();
+  void applyLevelPools();
 
 public:
   static constexpr size_t MAX_NUM_PATHS = 256;
@@ -74,8 +88,10 @@ public:
   void addDummyData();
 
 private:
-  AppContext& m_context;
-  AppResources& m_resources;
+  SimContext& m_context;
+  const sim::IClock& m_clock;
+  sim::Random& m_random;
+  ISimEventListener& m_listener;
 
   float m_currentLevelTimeS = 0.0f;
   size_t m_currentLevelIdx  = 0;
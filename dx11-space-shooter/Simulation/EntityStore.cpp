@@ -0,0 +1,193 @@
+#include "Simulation/EntityStore.h"
+
+#include "utils/Log.h"
+
+//------------------------------------------------------------------------------
+static ModelResource
+defaultModel(Partition p)
+{
+  switch (p)
+  {
+    case Partition::Players: return ModelResource::Player;
+    case Partition::PlayerShots: return ModelResource::Shot;
+    case Partition::EnemyShots: return ModelResource::Shot;
+    default: return ModelResource::Enemy1;
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::configure(const PoolSizes& sizes)
+{
+  TRACE
+
+  // The player survives reconfiguration
+  const bool wasPlayerAlive = (size() > 0) && isAlive(PLAYERS_IDX);
+  sim::Vec3 playerPos, playerVel;
+  if (wasPlayerAlive)
+  {
+    playerPos = position(PLAYERS_IDX);
+    playerVel = velocity(PLAYERS_IDX);
+  }
+
+  m_capacity  = sizes;
+  size_t next = 0;
+  for (size_t i = 0; i < NUM_PARTITIONS; ++i)
+  {
+    m_begin[i] = next;
+    next += ((m_capacity[static_cast<Partition>(i)] + 63) / 64) * 64;
+  }
+  m_begin[NUM_PARTITIONS] = next;
+  ASSERT(m_begin[static_cast<size_t>(Partition::Players)] == PLAYERS_IDX);
+
+  const size_t numEntities = size();
+  for (auto* field :
+       {&posX, &posY, &posZ, &velX, &velY, &velZ, &birthTimeS, &prevPosX,
+        &prevPosY, &prevPosZ})
+  {
+    field->assign(numEntities, 0.0f);
+  }
+  pathIdx.assign(numEntities, 0);
+  model.assign(numEntities, ModelResource::Enemy1);
+  m_alive.assign(numEntities / 64, 0);
+  m_colliding.assign(numEntities / 64, 0);
+  m_spawnedThisStep.assign(numEntities / 64, 0);
+  m_despawnRequests.assign(numEntities / 64, 0);
+
+  for (size_t i = 0; i < NUM_PARTITIONS; ++i)
+  {
+    const auto p = static_cast<Partition>(i);
+    std::fill(
+      model.begin() + partitionBegin(p),
+      model.begin() + partitionEnd(p),
+      defaultModel(p));
+
+    m_limit[i]    = m_capacity[p];
+    m_numAlive[i] = 0;
+    m_free[i].reserve(m_capacity[p]);
+    resetFreeList(p);
+  }
+  resetStats();
+
+  if (wasPlayerAlive)
+  {
+    spawn(Partition::Players);
+    setPosition(PLAYERS_IDX, playerPos);
+    setVelocity(PLAYERS_IDX, playerVel);
+  }
+}
+
+//------------------------------------------------------------------------------
+Partition
+EntityStore::partitionOf(size_t idx) const
+{
+  ASSERT(idx < size());
+  size_t i = 0;
+  while (idx >= m_begin[i + 1])
+  {
+    ++i;
+  }
+  return static_cast<Partition>(i);
+}
+
+//------------------------------------------------------------------------------
+size_t
+EntityStore::spawn(Partition p)
+{
+  const size_t i = static_cast<size_t>(p);
+  if (m_free[i].empty() || (m_numAlive[i] >= m_limit[i]))
+  {
+    m_numFailedSpawns[i]++;
+    return INVALID_IDX;
+  }
+
+  const size_t idx = m_free[i].back();
+  m_free[i].pop_back();
+  assign(m_alive, idx, true);
+  assign(m_spawnedThisStep, idx, true);
+
+  m_numAlive[i]++;
+  m_highWaterMark[i] = std::max(m_highWaterMark[i], m_numAlive[i]);
+  return idx;
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::despawn(size_t idx)
+{
+  if (!isAlive(idx))
+  {
+    return;
+  }
+  assign(m_alive, idx, false);
+
+  const size_t i = static_cast<size_t>(partitionOf(idx));
+  m_free[i].push_back(static_cast<uint32_t>(idx));
+  m_numAlive[i]--;
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::applyDespawnRequests()
+{
+  for (size_t w = 0; w < m_despawnRequests.size(); ++w)
+  {
+    for (uint64_t bits = m_despawnRequests[w]; bits != 0; bits &= bits - 1)
+    {
+      despawn(w * 64 + countTrailingZeros(bits));
+    }
+    m_despawnRequests[w] = 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::beginStep()
+{
+  std::copy(posX.begin(), posX.end(), prevPosX.begin());
+  std::copy(posY.begin(), posY.end(), prevPosY.begin());
+  std::copy(posZ.begin(), posZ.end(), prevPosZ.begin());
+  std::fill(m_spawnedThisStep.begin(), m_spawnedThisStep.end(), 0);
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::setLimit(Partition p, size_t limit)
+{
+  m_limit[static_cast<size_t>(p)] = std::min(limit, m_capacity[p]);
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::clear(Partition p)
+{
+  const size_t firstWord = partitionBegin(p) / 64;
+  std::fill_n(m_alive.begin() + firstWord, numWords(p), 0);
+  std::fill_n(m_colliding.begin() + firstWord, numWords(p), 0);
+
+  m_numAlive[static_cast<size_t>(p)] = 0;
+  resetFreeList(p);
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::resetStats()
+{
+  m_highWaterMark   = m_numAlive;
+  m_numFailedSpawns = {};
+}
+
+//------------------------------------------------------------------------------
+void
+EntityStore::resetFreeList(Partition p)
+{
+  // Pushed in reverse so the lowest indices are handed out first
+  auto& freeList = m_free[static_cast<size_t>(p)];
+  freeList.clear();
+  for (size_t idx = partitionEnd(p); idx > partitionBegin(p); --idx)
+  {
+    freeList.push_back(static_cast<uint32_t>(idx - 1));
+  }
+}
+
+//------------------------------------------------------------------------------
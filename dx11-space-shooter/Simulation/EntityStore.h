@@ -0,0 +1,358 @@
+//------------------------------------------------------------------------------
+// Structure-of-arrays entity storage.
+//
+// Each entity field is held in its own array so the physics and collision
+// loops stream over contiguous floats instead of whole structs. Liveness is a
+// packed bitset, and alive() iterates only the set bits, so loops no longer
+// branch over dead entries.
+//
+// Entities are partitioned by type into pools, sized at runtime (see
+// PoolSizes). Each pool hands out indices from a free list, so spawning and
+// despawning are O(1) and a full pool refuses to spawn rather than
+// overwriting live entities. Indices are stable for the lifetime of the
+// entity; the player is always PLAYERS_IDX.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "ResourceIDs.h"    // ModelResource
+#include "Simulation/SimMath.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+enum class Partition
+{
+  Players,
+  PlayerShots,
+  EnemyShots,
+  Enemies,
+
+  COUNT
+};
+
+static const size_t NUM_PLAYERS = 1;
+static const size_t PLAYERS_IDX = 0;
+
+//------------------------------------------------------------------------------
+// Number of entities in each pool
+//------------------------------------------------------------------------------
+struct PoolSizes
+{
+  size_t playerShots = 10;
+  size_t enemyShots  = 10;
+  size_t enemies     = 60;
+
+  size_t operator[](Partition p) const
+  {
+    switch (p)
+    {
+      case Partition::Players: return NUM_PLAYERS;
+      case Partition::PlayerShots: return playerShots;
+      case Partition::EnemyShots: return enemyShots;
+      case Partition::Enemies: return enemies;
+      default: return 0;
+    }
+  }
+
+  bool operator==(const PoolSizes& rhs) const
+  {
+    return (playerShots == rhs.playerShots) && (enemyShots == rhs.enemyShots)
+           && (enemies == rhs.enemies);
+  }
+  bool operator!=(const PoolSizes& rhs) const { return !(*this == rhs); }
+};
+
+//------------------------------------------------------------------------------
+// Index of the lowest set bit. bits must be non-zero.
+inline size_t
+countTrailingZeros(uint64_t bits)
+{
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanForward64(&idx, bits);
+  return static_cast<size_t>(idx);
+#else
+  return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Visits the set bits of a partition's bitset, yielding entity indices.
+//
+// The bitset is re-read on every step, so entities killed by the loop body
+// (including ones ahead of the cursor) are skipped correctly.
+//------------------------------------------------------------------------------
+class LiveIterator
+{
+public:
+  LiveIterator(
+    const uint64_t* words, size_t numWords, size_t baseIdx, size_t bit)
+      : m_words(words)
+      , m_numWords(numWords)
+      , m_baseIdx(baseIdx)
+      , m_bit(findNext(bit))
+  {
+  }
+
+  size_t operator*() const { return m_baseIdx + m_bit; }
+  LiveIterator& operator++()
+  {
+    m_bit = findNext(m_bit + 1);
+    return *this;
+  }
+  bool operator!=(const LiveIterator& rhs) const { return m_bit != rhs.m_bit; }
+  bool operator==(const LiveIterator& rhs) const { return m_bit == rhs.m_bit; }
+
+private:
+  size_t findNext(size_t bit) const
+  {
+    const size_t endBit = m_numWords * 64;
+    size_t wordIdx      = bit / 64;
+    if (wordIdx >= m_numWords)
+    {
+      return endBit;
+    }
+
+    uint64_t bits = m_words[wordIdx] & (~uint64_t(0) << (bit % 64));
+    while (bits == 0)
+    {
+      if (++wordIdx >= m_numWords)
+      {
+        return endBit;
+      }
+      bits = m_words[wordIdx];
+    }
+    return (wordIdx * 64) + countTrailingZeros(bits);
+  }
+
+  const uint64_t* m_words;
+  size_t m_numWords;
+  size_t m_baseIdx;
+  size_t m_bit;
+};
+
+//------------------------------------------------------------------------------
+struct LiveRange
+{
+  const uint64_t* words;
+  size_t numWords;
+  size_t baseIdx;
+
+  LiveIterator begin() const
+  {
+    return LiveIterator(words, numWords, baseIdx, 0);
+  }
+  LiveIterator end() const
+  {
+    return LiveIterator(words, numWords, baseIdx, numWords * 64);
+  }
+};
+
+//------------------------------------------------------------------------------
+class EntityStore
+{
+public:
+  static constexpr size_t NUM_PARTITIONS
+    = static_cast<size_t>(Partition::COUNT);
+  static constexpr size_t INVALID_IDX = ~size_t(0);
+
+  //----------------------------------------------------------------------------
+  // Field arrays (indexed by entity index)
+  std::vector<float> posX;
+  std::vector<float> posY;
+  std::vector<float> posZ;
+  std::vector<float> velX;
+  std::vector<float> velY;
+  std::vector<float> velZ;
+  std::vector<float> birthTimeS;
+  std::vector<size_t> pathIdx;
+  std::vector<ModelResource> model;
+
+  // Positions at the start of the current simulation step
+  std::vector<float> prevPosX;
+  std::vector<float> prevPosY;
+  std::vector<float> prevPosZ;
+
+  EntityStore() { configure(PoolSizes()); }
+
+  // Reallocates the pools. Every entity other than the player is killed, and
+  // the pool limits and statistics are reset.
+  void configure(const PoolSizes& sizes);
+  const PoolSizes& capacity() const { return m_capacity; }
+
+  // Total number of indices, including unused padding between partitions
+  size_t size() const { return m_begin[NUM_PARTITIONS]; }
+
+  //----------------------------------------------------------------------------
+  size_t partitionBegin(Partition p) const
+  {
+    return m_begin[static_cast<size_t>(p)];
+  }
+  size_t partitionEnd(Partition p) const
+  {
+    return partitionBegin(p) + m_capacity[p];
+  }
+  Partition partitionOf(size_t idx) const;
+
+  //----------------------------------------------------------------------------
+  sim::Vec3 position(size_t idx) const
+  {
+    return sim::Vec3(posX[idx], posY[idx], posZ[idx]);
+  }
+  void setPosition(size_t idx, const sim::Vec3& p)
+  {
+    posX[idx] = p.x;
+    posY[idx] = p.y;
+    posZ[idx] = p.z;
+  }
+
+  // Snapshots the positions at the start of a simulation step, so rendering
+  // can interpolate between the last two steps
+  void beginStep();
+
+  // alpha 0 is the previous step and 1 the current one. Entities spawned
+  // during the current step have no previous position and don't blend.
+  sim::Vec3 interpolatedPosition(size_t idx, float alpha) const
+  {
+    if (test(m_spawnedThisStep, idx))
+    {
+      return position(idx);
+    }
+    return sim::Vec3(
+      prevPosX[idx] + (posX[idx] - prevPosX[idx]) * alpha,
+      prevPosY[idx] + (posY[idx] - prevPosY[idx]) * alpha,
+      prevPosZ[idx] + (posZ[idx] - prevPosZ[idx]) * alpha);
+  }
+
+  sim::Vec3 velocity(size_t idx) const
+  {
+    return sim::Vec3(velX[idx], velY[idx], velZ[idx]);
+  }
+  void setVelocity(size_t idx, const sim::Vec3& v)
+  {
+    velX[idx] = v.x;
+    velY[idx] = v.y;
+    velZ[idx] = v.z;
+  }
+
+  //----------------------------------------------------------------------------
+  // Takes a free index from the pool, or returns INVALID_IDX when the pool
+  // (or its limit) is full
+  size_t spawn(Partition p);
+
+  // Returns the entity to its pool. Does nothing if it's already dead.
+  void despawn(size_t idx);
+
+  // Deferred despawn for loops split into word ranges (see aliveInWords()).
+  // A request only writes the bitset word holding idx, so ranges on separate
+  // threads don't race, while despawn() touches the shared free lists.
+  void requestDespawn(size_t idx) { assign(m_despawnRequests, idx, true); }
+
+  // Despawns every requested entity, in index order
+  void applyDespawnRequests();
+
+  // Caps the number of live entities in a pool below its capacity.
+  // Entities already alive beyond the limit are left alone.
+  void setLimit(Partition p, size_t limit);
+  size_t limit(Partition p) const { return m_limit[static_cast<size_t>(p)]; }
+
+  //----------------------------------------------------------------------------
+  bool isAlive(size_t idx) const { return test(m_alive, idx); }
+
+  bool isColliding(size_t idx) const { return test(m_colliding, idx); }
+  void setColliding(size_t idx, bool colliding)
+  {
+    assign(m_colliding, idx, colliding);
+  }
+
+  // Kills (and clears the collision flag of) every entity in the partition
+  void clear(Partition p);
+  void clearColliding()
+  {
+    std::fill(m_colliding.begin(), m_colliding.end(), 0);
+  }
+
+  bool anyAlive(Partition p) const { return numAlive(p) != 0; }
+  size_t numAlive(Partition p) const
+  {
+    return m_numAlive[static_cast<size_t>(p)];
+  }
+
+  // Iterate the indices of the live entities in a partition:
+  //   for (size_t idx : entities.alive(Partition::Enemies)) {..}
+  LiveRange alive(Partition p) const
+  {
+    return LiveRange{m_alive.data() + (partitionBegin(p) / 64),
+                     numWords(p),
+                     partitionBegin(p)};
+  }
+
+  // Bitset words [beginWord, endWord) cover 64 entities each, and partitions
+  // own whole words, so loops can be split into word ranges that run on
+  // separate threads. A range may span adjacent partitions.
+  size_t beginWord(Partition p) const { return partitionBegin(p) / 64; }
+  size_t endWord(Partition p) const { return beginWord(p) + numWords(p); }
+  LiveRange aliveInWords(size_t beginWord, size_t endWord) const
+  {
+    return LiveRange{
+      m_alive.data() + beginWord, endWord - beginWord, beginWord * 64};
+  }
+
+  //----------------------------------------------------------------------------
+  // Pool statistics, since configure() or resetStats()
+  size_t highWaterMark(Partition p) const
+  {
+    return m_highWaterMark[static_cast<size_t>(p)];
+  }
+  size_t numFailedSpawns(Partition p) const
+  {
+    return m_numFailedSpawns[static_cast<size_t>(p)];
+  }
+  void resetStats();
+
+private:
+  using Bits = std::vector<uint64_t>;
+
+  size_t numWords(Partition p) const { return (m_capacity[p] + 63) / 64; }
+
+  static bool test(const Bits& bits, size_t idx)
+  {
+    return (bits[idx / 64] >> (idx % 64)) & 1;
+  }
+
+  static void assign(Bits& bits, size_t idx, bool value)
+  {
+    uint64_t& word     = bits[idx / 64];
+    const uint64_t bit = uint64_t(1) << (idx % 64);
+    word               = value ? (word | bit) : (word & ~bit);
+  }
+
+  void resetFreeList(Partition p);
+
+  PoolSizes m_capacity;
+
+  // Partitions start on a 64 entity boundary, so each owns whole bitset words
+  std::array<size_t, NUM_PARTITIONS + 1> m_begin = {};
+
+  Bits m_alive;
+  Bits m_colliding;
+  Bits m_spawnedThisStep;
+  Bits m_despawnRequests;
+
+  // Per partition: stack of free indices, lowest index on top
+  std::array<std::vector<uint32_t>, NUM_PARTITIONS> m_free;
+  std::array<size_t, NUM_PARTITIONS> m_limit           = {};
+  std::array<size_t, NUM_PARTITIONS> m_numAlive        = {};
+  std::array<size_t, NUM_PARTITIONS> m_highWaterMark   = {};
+  std::array<size_t, NUM_PARTITIONS> m_numFailedSpawns = {};
+};
+
+//------------------------------------------------------------------------------
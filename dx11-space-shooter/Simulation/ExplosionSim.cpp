@@ -0,0 +1,152 @@
+#include "Simulation/ExplosionSim.h"
+
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+static size_t
+highestSetBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanReverse64(&idx, bits);
+  return static_cast<size_t>(idx);
+#else
+  return 63 - static_cast<size_t>(__builtin_clzll(bits));
+#endif
+}
+
+//------------------------------------------------------------------------------
+ExplosionSim::ExplosionSim(sim::Random::Seed seed, size_t maxNumParticles)
+    : m_random(seed)
+{
+  m_particles.resize(maxNumParticles);
+  m_deadMask.resize(sim::ParticleArrays::maskWords(maxNumParticles));
+}
+
+//------------------------------------------------------------------------------
+void
+ExplosionSim::reset()
+{
+  TRACE
+  m_numParticles    = 0;
+  m_nextReplacedIdx = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+ExplosionSim::update(float elapsedTimeS)
+{
+  TRACE
+  integrateWords(
+    elapsedTimeS, 0, sim::ParticleArrays::maskWords(m_numParticles));
+  removeDead();
+}
+
+//------------------------------------------------------------------------------
+void
+ExplosionSim::emit(
+  const sim::Vec3& origin, const sim::Vec3& baseVelocity, size_t numParticles)
+{
+  constexpr float TWO_PI = 6.283185307f;
+
+  auto& p = m_particles;
+  for (size_t i = 0; i < numParticles; ++i)
+  {
+    size_t idx = m_numParticles;
+    if (m_numParticles < p.capacity())
+    {
+      m_numParticles++;
+    }
+    else
+    {
+      idx = m_nextReplacedIdx;
+      m_nextReplacedIdx++;
+      if (m_nextReplacedIdx >= p.capacity())
+      {
+        m_nextReplacedIdx = 0;
+      }
+    }
+
+    // Position
+    const float spreadDistance
+      = m_random.uniformFloat(-ORIGIN_SPREAD, ORIGIN_SPREAD);
+    const float theta = m_random.uniformFloat(0.0f, TWO_PI);
+    sim::Vec3 spread(std::cos(theta), std::sin(theta), 0.0f);
+    const sim::Vec3 position = origin + (spread * spreadDistance);
+    p.x[idx]                 = position.x;
+    p.y[idx]                 = position.y;
+    p.z[idx]                 = position.z;
+
+    // Velocity
+    const float velocity = m_random.uniformFloat(VELOCITY_MIN, VELOCITY_MAX);
+    p.vx[idx]            = baseVelocity.x - (spread.x * velocity);
+    p.vy[idx]            = baseVelocity.y - (spread.y * velocity);
+
+    // Energy
+    p.energy[idx] = m_random.uniformFloat(ENERGY_MIN, ENERGY_MAX);
+  }
+}
+
+//------------------------------------------------------------------------------
+sim::JobSystem::Job*
+ExplosionSim::scheduleUpdate(sim::JobSystem& jobs, float elapsedTimeS)
+{
+  constexpr size_t GRAIN_WORDS = 16;    // 1024 particles
+
+  auto* integrate = jobs.parallelFor(
+    "ExplosionIntegrate",
+    sim::ParticleArrays::maskWords(m_numParticles),
+    GRAIN_WORDS,
+    [this, elapsedTimeS](size_t begin, size_t end) {
+      integrateWords(elapsedTimeS, begin, end);
+    });
+  return jobs.run(
+    "ExplosionRemoveDead", [this] { removeDead(); }, {integrate});
+}
+
+//------------------------------------------------------------------------------
+// Ranges are in whole mask words, so concurrent ranges don't share a word
+void
+ExplosionSim::integrateWords(
+  float elapsedTimeS, size_t beginWord, size_t endWord)
+{
+  sim::integrateParticles(
+    m_particles,
+    beginWord * 64,
+    std::min(endWord * 64, m_numParticles),
+    elapsedTimeS,
+    m_deadMask.data());
+}
+
+//------------------------------------------------------------------------------
+// Fills each hole with the last live particle. Going from the highest index
+// down means every particle above the hole is already known to be alive.
+void
+ExplosionSim::removeDead()
+{
+  for (size_t w = sim::ParticleArrays::maskWords(m_numParticles); w-- > 0;)
+  {
+    uint64_t bits = m_deadMask[w];
+    while (bits)
+    {
+      const size_t bit = highestSetBit(bits);
+      bits &= ~(uint64_t(1) << bit);
+
+      const size_t idx = (w * 64) + bit;
+      m_numParticles--;
+      if (idx != m_numParticles)
+      {
+        m_particles.move(idx, m_numParticles);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
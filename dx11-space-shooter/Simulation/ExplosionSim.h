@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Simulation/JobSystem.h"
+#include "Simulation/ParticleKernel.h"
+#include "Simulation/SimMath.h"
+#include "Simulation/SimRandom.h"
+
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Explosion particle state, in world space. Rendering lives in the game's
+// Explosions class, which projects the particles to the screen each frame.
+//
+// The live particles are packed at the front of the arrays, in no particular
+// order: dead ones are replaced by the last live particle. So an update costs
+// the number of live particles, not the capacity.
+//------------------------------------------------------------------------------
+class ExplosionSim
+{
+public:
+  static constexpr size_t MAX_NUM_PARTICLES = 2048;    // Default capacity
+
+  static constexpr float VELOCITY_MIN  = 1.2f;    // World units per second
+  static constexpr float VELOCITY_MAX  = 1.8f;
+  static constexpr float ENERGY_MIN    = 0.8f;    // Energy controls life
+  static constexpr float ENERGY_MAX    = 1.0f;
+  static constexpr float ORIGIN_SPREAD = 2.0f;
+
+  explicit ExplosionSim(
+    sim::Random::Seed seed, size_t maxNumParticles = MAX_NUM_PARTICLES);
+
+  void reset();
+  void update(float elapsedTimeS);
+
+  // The same update with the particles split across the job system. Nothing
+  // may emit until the job has finished.
+  sim::JobSystem::Job* scheduleUpdate(sim::JobSystem& jobs, float elapsedTimeS);
+
+  // Particles spread out in the XY plane, baseVelocity.z is ignored. Once
+  // full, new particles replace existing ones.
+  void emit(
+    const sim::Vec3& origin,
+    const sim::Vec3& baseVelocity,
+    size_t numParticles = 200);
+
+  // Particles [0, numParticles()) are alive
+  const sim::ParticleArrays& particles() const { return m_particles; }
+  size_t numParticles() const { return m_numParticles; }
+  size_t capacity() const { return m_particles.capacity(); }
+
+  sim::Random& random() { return m_random; }
+
+private:
+  void integrateWords(float elapsedTimeS, size_t beginWord, size_t endWord);
+  void removeDead();
+
+  sim::ParticleArrays m_particles;
+  size_t m_numParticles = 0;
+  std::vector<uint64_t> m_deadMask;    // Written by integrateWords()
+  size_t m_nextReplacedIdx = 0;        // Where emit() writes once full
+  sim::Random m_random;
+};
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,511 @@
+#include "Simulation/GameSim.h"
+#include "Simulation/SimClock.h"
+
+#include "utils/Log.h"
+
+#include <algorithm>
+
+using sim::Vec3;
+
+//------------------------------------------------------------------------------
+const Vec3 GameSim::PLAYER_MAX_POSITION = {36.0f, 18.0f, 0.0f};
+const Vec3 GameSim::PLAYER_START_POS    = {0.0f, -18.0f, 0.0f};
+const Vec3 GameSim::SHOT_MAX_POSITION   = {60.0f, 40.0f, 0.0f};
+
+constexpr float UNIT_DIAGONAL_LENGTH = 0.7071067811865475f;
+
+constexpr size_t PLAYER_SPEED_CONTROL        = 17;
+constexpr size_t PLAYER_FRICTION_CONTROL     = 18;
+constexpr size_t PLAYER_MAX_VELOCITY_CONTROL = 19;
+constexpr size_t PLAYER_MIN_VELOCITY_CONTROL = 20;
+
+//------------------------------------------------------------------------------
+GameSim::GameSim(
+  SimContext& context,
+  const sim::IClock& clock,
+  sim::Random& random,
+  ISimEventListener& listener,
+  sim::JobSystem& jobs)
+    : m_context(context)
+    , m_listener(listener)
+    , m_jobs(jobs)
+    , m_enemies(context, clock, random, listener)
+    , m_enemyGrid(
+        -SHOT_MAX_POSITION.x,
+        -SHOT_MAX_POSITION.y,
+        SHOT_MAX_POSITION.x,
+        SHOT_MAX_POSITION.y,
+        COLLISION_CELL_SIZE,
+        0,
+        0)
+    , m_enemyShotGrid(
+        -SHOT_MAX_POSITION.x,
+        -SHOT_MAX_POSITION.y,
+        SHOT_MAX_POSITION.x,
+        SHOT_MAX_POSITION.y,
+        COLLISION_CELL_SIZE,
+        0,
+        0)
+{
+  TRACE
+  resizeCollisionData();
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::reset()
+{
+  TRACE
+
+  auto& entities = m_context.entities;
+  entities.clear(Partition::Players);
+  entities.clear(Partition::PlayerShots);
+  entities.clear(Partition::EnemyShots);
+  m_enemies.reset();
+  m_enemyGrid.clear();
+  m_enemyShotGrid.clear();
+
+  const size_t playerIdx = entities.spawn(Partition::Players);
+  ASSERT(playerIdx == PLAYERS_IDX);
+  (void)playerIdx;
+  entities.setPosition(PLAYERS_IDX, PLAYER_START_POS);
+  entities.setVelocity(PLAYERS_IDX, Vec3());
+
+  m_context.resetPlayer();
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::applyInput(const sim::PlayerInput& input)
+{
+  TRACE
+  // NB. Must be reset, even while dead.
+  m_context.playerAccel = sim::Vec3();
+  if (m_context.playerState == PlayerState::Dying)
+  {
+    return;
+  }
+
+  if (input.isHeld(sim::Input_Up))
+  {
+    m_context.playerAccel.y = 1.0f;
+  }
+  else if (input.isHeld(sim::Input_Down))
+  {
+    m_context.playerAccel.y = -1.0f;
+  }
+
+  if (input.isHeld(sim::Input_Left))
+  {
+    m_context.playerAccel.x = -1.0f;
+  }
+  else if (input.isHeld(sim::Input_Right))
+  {
+    m_context.playerAccel.x = 1.0f;
+  }
+
+  if (m_context.playerAccel.x != 0.0f && m_context.playerAccel.y != 0.0f)
+  {
+    m_context.playerAccel *= UNIT_DIAGONAL_LENGTH;
+  }
+
+  if (input.isPressed(sim::Input_Fire))
+  {
+    m_enemies.emitPlayerShot();
+  }
+}
+
+//------------------------------------------------------------------------------
+bool
+GameSim::applyMidiControl(size_t controllerId, int value)
+{
+  switch (controllerId)
+  {
+    case PLAYER_SPEED_CONTROL:
+      m_context.playerSpeed = static_cast<float>(value * 2);
+      return true;
+
+    case PLAYER_FRICTION_CONTROL:
+      m_context.playerFriction = static_cast<float>(value * 2);
+      return true;
+
+    case PLAYER_MAX_VELOCITY_CONTROL:
+      m_context.playerMaxVelocity = static_cast<float>(value * 2);
+      return true;
+
+    case PLAYER_MIN_VELOCITY_CONTROL:
+      m_context.playerMinVelocity = static_cast<float>(value) / 10.f;
+      return true;
+
+    default: return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+GameSim::Status
+GameSim::update(
+  const sim::IClock& timer, sim::JobSystem::Dependencies eventDependencies)
+{
+  TRACE
+  float elapsedTimeS = float(timer.GetElapsedSeconds());
+
+  m_context.frameArena.reset();
+  m_context.entities.beginStep();
+  m_enemies.update(timer);
+  performPhysicsUpdate(elapsedTimeS);
+  for (auto* job : eventDependencies)
+  {
+    m_jobs.wait(job);
+  }
+
+  switch (m_context.playerState)
+  {
+    case PlayerState::Normal:
+      performCollisionTests();
+      break;
+
+    case PlayerState::Dying:
+      if ((m_context.playerDeathTimerS -= elapsedTimeS) <= 0.0f)
+      {
+        if (--m_context.playerLives > -1)
+        {
+          LOG_VERBOSE("playerState: Dying->Reviving");
+          m_context.playerState        = PlayerState::Reviving;
+          m_context.playerReviveTimerS = PLAYER_REVIVE_TIME_S;
+          m_listener.onSimEvent(
+            SimEvent::LivesChanged, m_context.entities.position(PLAYERS_IDX));
+        }
+        else
+        {
+          return Status::GameOver;
+        }
+      }
+      break;
+
+    case PlayerState::Reviving:
+      if ((m_context.playerReviveTimerS -= elapsedTimeS) <= 0.0f)
+      {
+        LOG_VERBOSE("playerState: Reviving->Normal");
+        m_context.playerState = PlayerState::Normal;
+      }
+      performCollisionTests();
+      break;
+  }
+
+  return Status::Playing;
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::performPhysicsUpdate(const float elapsedTimeS)
+{
+  TRACE
+  constexpr size_t SHOT_GRAIN_WORDS = 4;
+  auto& entities = m_context.entities;
+
+  // The enemies, the player and the shots are all independent. Despawns are
+  // deferred, so no pass modifies the pools while another is running.
+  auto* enemies = m_enemies.schedulePhysicsUpdate(m_jobs);
+  auto* player  = m_jobs.run("PlayerPhysics", [this, elapsedTimeS] {
+    integratePlayer(elapsedTimeS);
+  });
+
+  // Both shot partitions, which are adjacent
+  const size_t beginWord = entities.beginWord(Partition::PlayerShots);
+  ASSERT(
+    entities.endWord(Partition::PlayerShots)
+    == entities.beginWord(Partition::EnemyShots));
+  auto* shots = m_jobs.parallelFor(
+    "ShotPhysics",
+    entities.endWord(Partition::EnemyShots) - beginWord,
+    SHOT_GRAIN_WORDS,
+    [this, elapsedTimeS](size_t begin, size_t end) {
+      // Looked up again rather than captured, to keep the capture inline
+      const size_t firstWord
+        = m_context.entities.beginWord(Partition::PlayerShots);
+      integrateShots(elapsedTimeS, firstWord + begin, firstWord + end);
+    });
+
+  m_jobs.wait(enemies);
+  m_jobs.wait(player);
+  m_jobs.wait(shots);
+  entities.applyDespawnRequests();
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::integratePlayer(const float elapsedTimeS)
+{
+  auto& entities = m_context.entities;
+
+  // Player input forces
+  Vec3 position = entities.position(PLAYERS_IDX);
+  Vec3 velocity = entities.velocity(PLAYERS_IDX);
+  m_context.playerAccel *= m_context.playerSpeed;
+
+  Vec3 frictionNormal = -velocity;
+  frictionNormal.Normalize();
+  m_context.playerAccel += m_context.playerFriction * frictionNormal;
+
+  // Integrate Player
+  const Vec3& accel = m_context.playerAccel;
+
+  position = 0.5f * accel * (elapsedTimeS * elapsedTimeS)
+             + velocity * elapsedTimeS + position;
+  velocity = accel * elapsedTimeS + velocity;
+
+  constrainPlayer(position, velocity);
+  entities.setPosition(PLAYERS_IDX, position);
+  entities.setVelocity(PLAYERS_IDX, velocity);
+}
+
+//------------------------------------------------------------------------------
+// Ballistic entities
+void
+GameSim::integrateShots(
+  const float elapsedTimeS, const size_t beginWord, const size_t endWord)
+{
+  auto& entities = m_context.entities;
+  for (size_t i : entities.aliveInWords(beginWord, endWord))
+  {
+    // No acceleration, velocity is constant
+    entities.posX[i] += entities.velX[i] * elapsedTimeS;
+    entities.posY[i] += entities.velY[i] * elapsedTimeS;
+    entities.posZ[i] += entities.velZ[i] * elapsedTimeS;
+
+    constrainShot(i);
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::constrainPlayer(Vec3& position, Vec3& velocity)
+{
+  TRACE
+  auto slide = [& incident = velocity](Vec3 normal)
+  {
+    return incident - 1.0f * incident.Dot(normal) * normal;
+  };
+
+  // Limit position
+  if (position.x < -PLAYER_MAX_POSITION.x)
+  {
+    position.x = -PLAYER_MAX_POSITION.x;
+    velocity   = slide(Vec3(1.0f, 0.0f, 0.0f));
+  }
+  else if (position.x > PLAYER_MAX_POSITION.x)
+  {
+    position.x = PLAYER_MAX_POSITION.x;
+    velocity   = slide(Vec3(-1.0f, 0.0f, 0.0f));
+  }
+  if (position.y < -PLAYER_MAX_POSITION.y)
+  {
+    position.y = -PLAYER_MAX_POSITION.y;
+    velocity   = slide(Vec3(0.0f, 1.0f, 0.0f));
+  }
+  else if (position.y > PLAYER_MAX_POSITION.y)
+  {
+    position.y = PLAYER_MAX_POSITION.y;
+    velocity   = slide(Vec3(0.0f, -1.0f, 0.0f));
+  }
+
+  // Clamp velocity
+  float velocityMagnitude = velocity.Length();
+  if (velocityMagnitude > m_context.playerMaxVelocity)
+  {
+    velocity.Normalize();
+    velocity *= m_context.playerMaxVelocity;
+  }
+  else if (velocityMagnitude < m_context.playerMinVelocity)
+  {
+    velocity = Vec3();
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::constrainShot(const size_t entityIdx)
+{
+  auto& entities = m_context.entities;
+  const float x  = entities.posX[entityIdx];
+  const float y  = entities.posY[entityIdx];
+
+  if (
+    (y < -SHOT_MAX_POSITION.y) || (y > SHOT_MAX_POSITION.y)
+    || (x < -SHOT_MAX_POSITION.x) || (x > SHOT_MAX_POSITION.x))
+  {
+    entities.requestDespawn(entityIdx);
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::performCollisionTests()
+{
+  TRACE
+  auto& entities = m_context.entities;
+  entities.clearColliding();
+
+  resizeCollisionData();
+  updateCollisionGrid(m_enemyGrid, Partition::Enemies);
+  updateCollisionGrid(m_enemyShotGrid, Partition::EnemyShots);
+
+  auto onPlayerShotHitsEnemy =
+    [	&context	= m_context,
+      &listener	= m_listener
+    ](size_t shotIdx, size_t enemyIdx)
+  {
+    auto& entities = context.entities;
+    auto pos = entities.position(shotIdx) + context.bound(shotIdx).Center;
+    listener.onSimEvent(SimEvent::EnemyExploded, pos);
+
+    entities.setColliding(shotIdx, true);
+    entities.setColliding(enemyIdx, true);
+    entities.despawn(shotIdx);
+    entities.despawn(enemyIdx);
+    context.playerScore += POINTS_PER_KILL;
+    listener.onSimEvent(SimEvent::ScoreChanged, pos);
+  };
+
+  auto onPlayerHit =
+    [	&context	= m_context,
+      &listener	= m_listener
+    ](size_t playerIdx, size_t enemyIdx)
+  {
+    auto& entities = context.entities;
+    auto pos = entities.position(playerIdx) + context.bound(playerIdx).Center;
+    listener.onSimEvent(SimEvent::PlayerExploded, pos);
+
+    pos = entities.position(enemyIdx) + context.bound(enemyIdx).Center;
+    listener.onSimEvent(SimEvent::EnemyExploded, pos);
+
+    entities.setColliding(playerIdx, true);
+    entities.setColliding(enemyIdx, true);
+
+    entities.despawn(enemyIdx);
+    LOG_VERBOSE("playerState: Normal->Dying");
+    context.playerState       = PlayerState::Dying;
+    context.playerDeathTimerS = PLAYER_DEATH_TIME_S;
+  };
+
+  // Pass 1 - PlayerShots		-> Enemies
+  for (size_t srcIdx : entities.alive(Partition::PlayerShots))
+  {
+    collisionTestEntity(srcIdx, m_enemyGrid, onPlayerShotHitsEnemy);
+  }
+
+  // Player is invulnerable, no more collision tests
+  if (m_context.playerState == PlayerState::Reviving)
+  {
+    return;
+  }
+
+  // Pass 2 - Player				-> Enemies
+  collisionTestEntity(PLAYERS_IDX, m_enemyGrid, onPlayerHit);
+
+  // Pass 3 - Player				-> EnemyShots
+  collisionTestEntity(PLAYERS_IDX, m_enemyShotGrid, onPlayerHit);
+}
+
+//------------------------------------------------------------------------------
+// Follows the entity pools when they are reconfigured (e.g. on level load)
+void
+GameSim::resizeCollisionData()
+{
+  const auto& entities = m_context.entities;
+  auto isGridInSync    = [&entities](const CollisionGrid& grid, Partition p) {
+    return (grid.baseIdx() == entities.partitionBegin(p))
+           && (grid.capacity() == entities.capacity()[p]);
+  };
+  if (
+    isGridInSync(m_enemyGrid, Partition::Enemies)
+    && isGridInSync(m_enemyShotGrid, Partition::EnemyShots)
+    && (m_worldBounds.x.size() == entities.size()))
+  {
+    return;
+  }
+
+  m_enemyGrid.resize(
+    entities.partitionBegin(Partition::Enemies),
+    entities.capacity().enemies);
+  m_enemyShotGrid.resize(
+    entities.partitionBegin(Partition::EnemyShots),
+    entities.capacity().enemyShots);
+
+  const size_t maxCandidates
+    = std::max(entities.capacity().enemies, entities.capacity().enemyShots);
+  m_worldBounds.resize(entities.size());
+  m_candidateBounds.resize(maxCandidates);
+  m_candidates.reserve(maxCandidates);
+  m_hitMask.resize(sim::SphereArrays::maskWords(maxCandidates));
+}
+
+//------------------------------------------------------------------------------
+void
+GameSim::updateCollisionGrid(CollisionGrid& grid, const Partition partition)
+{
+  TRACE
+  const auto& entities = m_context.entities;
+  grid.removeIf([&entities](size_t idx) { return !entities.isAlive(idx); });
+
+  for (size_t idx : entities.alive(partition))
+  {
+    const auto& bound = m_context.bound(idx);
+    const Vec3 center = entities.position(idx) + bound.Center;
+    m_worldBounds.set(idx, center, bound.Radius);
+    grid.update(idx, center.x, center.y, bound.Radius);
+  }
+}
+
+//------------------------------------------------------------------------------
+template <typename Func>
+void
+GameSim::collisionTestEntity(
+  const size_t entityIdx, const CollisionGrid& targets, Func& onCollision)
+{
+  const auto& entities = m_context.entities;
+  if (!entities.isAlive(entityIdx))
+  {
+    return;
+  }
+  TRACE
+
+  auto& bound = m_context.bound(entityIdx);
+  const sim::BoundingSphere srcBound
+    = {entities.position(entityIdx) + bound.Center, bound.Radius};
+
+  // Gather the live candidates in index order, so hits are reported in the
+  // same order however the grid happens to be linked
+  m_candidates.clear();
+  targets.query(
+    srcBound.Center.x, srcBound.Center.y, srcBound.Radius, [&](size_t idx) {
+      if (entities.isAlive(idx))
+      {
+        m_candidates.push_back(idx);
+      }
+    });
+  std::sort(m_candidates.begin(), m_candidates.end());
+
+  const size_t numCandidates = m_candidates.size();
+  for (size_t i = 0; i < numCandidates; ++i)
+  {
+    const size_t idx = m_candidates[i];
+    m_candidateBounds.x[i]      = m_worldBounds.x[idx];
+    m_candidateBounds.y[i]      = m_worldBounds.y[idx];
+    m_candidateBounds.z[i]      = m_worldBounds.z[idx];
+    m_candidateBounds.radius[i] = m_worldBounds.radius[idx];
+  }
+
+  sim::sphereOverlapMask(
+    srcBound, m_candidateBounds, numCandidates, m_hitMask.data());
+
+  for (size_t w = 0; w < sim::SphereArrays::maskWords(numCandidates); ++w)
+  {
+    for (uint64_t bits = m_hitMask[w]; bits != 0; bits &= bits - 1)
+    {
+      onCollision(entityIdx, m_candidates[w * 64 + countTrailingZeros(bits)]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
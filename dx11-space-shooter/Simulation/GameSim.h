@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Simulation/CollisionGrid.h"
+#include "Simulation/Enemies.h"
+#include "Simulation/JobSystem.h"
+#include "Simulation/SimContext.h"
+#include "Simulation/SimInput.h"
+#include "Simulation/SphereKernel.h"
+
+#include <vector>
+
+namespace sim
+{
+class IClock;
+class Random;
+}
+
+//------------------------------------------------------------------------------
+// Platform independent gameplay update: player/shot physics, enemy waves and
+// collision. Anything the presentation layer needs to react to is reported
+// through the ISimEventListener.
+//------------------------------------------------------------------------------
+class GameSim
+{
+public:
+  enum class Status
+  {
+    Playing,
+    GameOver,
+  };
+
+  static const sim::Vec3 PLAYER_MAX_POSITION;
+  static const sim::Vec3 PLAYER_START_POS;
+  static const sim::Vec3 SHOT_MAX_POSITION;
+  static constexpr float PLAYER_DEATH_TIME_S  = 1.0f;
+  static constexpr float PLAYER_REVIVE_TIME_S = 2.0f;
+  static constexpr int POINTS_PER_KILL        = 1000;
+  static constexpr float COLLISION_CELL_SIZE  = 4.0f;
+
+  GameSim(
+    SimContext& context,
+    const sim::IClock& clock,
+    sim::Random& random,
+    ISimEventListener& listener,
+    sim::JobSystem& jobs);
+
+  void reset();
+
+  // Physics runs on the job system. Collision reports events that the
+  // listener may act on, so it also waits for eventDependencies (e.g. the
+  // explosion update, when kills emit explosions).
+  Status update(
+    const sim::IClock& timer,
+    sim::JobSystem::Dependencies eventDependencies = {});
+
+  // Player controls, applied before update()
+  void applyInput(const sim::PlayerInput& input);
+
+  // Tuning from a MIDI controller. Returns false for controllers the
+  // simulation doesn't use.
+  bool applyMidiControl(size_t controllerId, int value);
+
+  void performPhysicsUpdate(const float elapsedTimeS);
+  void integratePlayer(const float elapsedTimeS);
+  void integrateShots(
+    const float elapsedTimeS, const size_t beginWord, const size_t endWord);
+  void constrainPlayer(sim::Vec3& position, sim::Vec3& velocity);
+  void constrainShot(const size_t entityIdx);
+  void performCollisionTests();
+  void updateCollisionGrid(CollisionGrid& grid, const Partition partition);
+  void resizeCollisionData();
+
+  template <typename Func>
+  void collisionTestEntity(
+    const size_t entityIdx, const CollisionGrid& targets, Func& onCollision);
+
+private:
+  SimContext& m_context;
+  ISimEventListener& m_listener;
+  sim::JobSystem& m_jobs;
+
+public:
+  Enemies m_enemies;
+
+private:
+  // Broadphase for the collision targets, kept up to date incrementally
+  CollisionGrid m_enemyGrid;
+  CollisionGrid m_enemyShotGrid;
+
+  // World space bounds of the collision targets, refreshed with the grids.
+  // Candidates for each test are gathered from here into flat arrays for the
+  // batched sphere tests.
+  sim::SphereArrays m_worldBounds;
+  sim::SphereArrays m_candidateBounds;
+  std::vector<size_t> m_candidates;
+  std::vector<uint64_t> m_hitMask;
+};
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,268 @@
+#include "Simulation/InputRecording.h"
+
+#include "utils/Log.h"
+
+#include <fstream>
+
+using namespace sim;
+
+//------------------------------------------------------------------------------
+static const uint32_t FILE_MAGIC   = 0x52495353;    // "SSIR"
+static const uint32_t FILE_VERSION = 1;
+
+//------------------------------------------------------------------------------
+template <typename T>
+static void
+write(std::ofstream& file, const T& value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+static bool
+read(std::ifstream& file, T& value)
+{
+  file.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return file.good();
+}
+
+//------------------------------------------------------------------------------
+// Whether count items of itemSize bytes fit in what is left of the file, so a
+// corrupt count is caught before it is allocated for
+static bool
+isCountInFile(std::ifstream& file, uint64_t count, uint64_t itemSize)
+{
+  const std::streampos pos = file.tellg();
+  file.seekg(0, std::ios::end);
+  const std::streampos end = file.tellg();
+  file.seekg(pos);
+  if (!file.good() || pos < 0 || end < pos)
+  {
+    return false;
+  }
+  return count <= static_cast<uint64_t>(end - pos) / itemSize;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecording::clear()
+{
+  setup = Setup();
+  ticks.clear();
+  midiChanges.clear();
+}
+
+//------------------------------------------------------------------------------
+bool
+InputRecording::save(const std::string& filename) const
+{
+  TRACE
+  std::ofstream file(filename, std::ios::binary);
+  if (!file.is_open())
+  {
+    LOG_ERROR("Unable to save the input recording to %s", filename.c_str());
+    return false;
+  }
+
+  write(file, FILE_MAGIC);
+  write(file, FILE_VERSION);
+  write(file, setup.gameSeed);
+  write(file, setup.explosionSeed);
+  write(file, setup.starFieldSeed);
+  write(file, setup.stepSeconds);
+  write(file, setup.starFieldBounds.screenWidth);
+  write(file, setup.starFieldBounds.screenHeight);
+  write(file, setup.starFieldBounds.starWidth);
+  write(file, setup.starFieldBounds.starHeight);
+
+  write(file, static_cast<uint64_t>(ticks.size()));
+  for (const auto& tick : ticks)
+  {
+    write(file, tick.flags);
+    write(file, tick.numMidiChanges);
+    write(file, tick.input.held);
+    write(file, tick.input.pressed);
+  }
+
+  write(file, static_cast<uint64_t>(midiChanges.size()));
+  for (const auto& change : midiChanges)
+  {
+    write(file, change.controllerId);
+    write(file, change.value);
+  }
+
+  return file.good();
+}
+
+//------------------------------------------------------------------------------
+bool
+InputRecording::load(const std::string& filename)
+{
+  TRACE
+  clear();
+
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open())
+  {
+    LOG_ERROR("Input recording %s could not be found", filename.c_str());
+    return false;
+  }
+
+  uint32_t magic = 0, version = 0;
+  if (
+    !read(file, magic) || !read(file, version) || (magic != FILE_MAGIC)
+    || (version != FILE_VERSION))
+  {
+    LOG_ERROR("%s is not a supported input recording", filename.c_str());
+    return false;
+  }
+
+  read(file, setup.gameSeed);
+  read(file, setup.explosionSeed);
+  read(file, setup.starFieldSeed);
+  read(file, setup.stepSeconds);
+  read(file, setup.starFieldBounds.screenWidth);
+  read(file, setup.starFieldBounds.screenHeight);
+  read(file, setup.starFieldBounds.starWidth);
+  read(file, setup.starFieldBounds.starHeight);
+
+  uint64_t numTicks     = 0;
+  size_t numMidiChanges = 0;
+  const uint64_t TICK_SIZE
+    = sizeof(InputTick::flags) + sizeof(InputTick::numMidiChanges)
+      + sizeof(PlayerInput::held) + sizeof(PlayerInput::pressed);
+  if (!read(file, numTicks) || !isCountInFile(file, numTicks, TICK_SIZE))
+  {
+    LOG_ERROR("Input recording %s is truncated", filename.c_str());
+    clear();
+    return false;
+  }
+  ticks.resize(static_cast<size_t>(numTicks));
+  for (auto& tick : ticks)
+  {
+    read(file, tick.flags);
+    read(file, tick.numMidiChanges);
+    read(file, tick.input.held);
+    read(file, tick.input.pressed);
+    numMidiChanges += tick.numMidiChanges;
+  }
+
+  uint64_t numStoredChanges = 0;
+  const uint64_t CHANGE_SIZE
+    = sizeof(MidiChange::controllerId) + sizeof(MidiChange::value);
+  if (
+    !read(file, numStoredChanges)
+    || !isCountInFile(file, numStoredChanges, CHANGE_SIZE))
+  {
+    LOG_ERROR("Input recording %s is truncated", filename.c_str());
+    clear();
+    return false;
+  }
+  midiChanges.resize(static_cast<size_t>(numStoredChanges));
+  for (auto& change : midiChanges)
+  {
+    read(file, change.controllerId);
+    read(file, change.value);
+  }
+
+  if (!file.good() || (numStoredChanges != numMidiChanges))
+  {
+    LOG_ERROR("Input recording %s is truncated", filename.c_str());
+    clear();
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecorder::start(const InputRecording::Setup& setup)
+{
+  m_recording.clear();
+  m_recording.setup = setup;
+  m_tick            = InputTick();
+  m_state           = State::Recording;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecorder::stop()
+{
+  m_state = State::Off;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecorder::recordNewGame()
+{
+  if (!isRecording())
+  {
+    return;
+  }
+  m_tick.flags |= InputTick::NewGame;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecorder::recordInput(const PlayerInput& input)
+{
+  if (!isRecording())
+  {
+    return;
+  }
+  m_tick.flags |= InputTick::Gameplay;
+  m_tick.input = input;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecorder::recordMidiChange(size_t controllerId, int value)
+{
+  if (!isRecording())
+  {
+    return;
+  }
+  ASSERT(controllerId <= UINT8_MAX && value >= 0 && value <= UINT8_MAX);
+  MidiChange change;
+  change.controllerId = static_cast<uint8_t>(controllerId);
+  change.value        = static_cast<uint8_t>(value);
+
+  // Once the tick's count is full, only the last value per controller is kept
+  if (m_tick.numMidiChanges == UINT8_MAX)
+  {
+    auto& changes = m_recording.midiChanges;
+    for (auto it = changes.end() - UINT8_MAX; it != changes.end(); ++it)
+    {
+      if (it->controllerId == change.controllerId)
+      {
+        it->value = change.value;
+        return;
+      }
+    }
+    LOG_WARNING(
+      "Dropping MIDI change for controller %zu, tick is full", controllerId);
+    return;
+  }
+  m_recording.midiChanges.push_back(change);
+  m_tick.numMidiChanges++;
+}
+
+//------------------------------------------------------------------------------
+void
+InputRecorder::endTick(bool starFieldUpdated)
+{
+  if (!isRecording())
+  {
+    return;
+  }
+
+  if (starFieldUpdated)
+  {
+    m_tick.flags |= InputTick::StarField;
+  }
+  m_recording.ticks.push_back(m_tick);
+  m_tick = InputTick();
+}
+
+//------------------------------------------------------------------------------
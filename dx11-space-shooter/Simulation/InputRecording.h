@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+// Capture and replay of a play session.
+//
+// The recorder logs one entry per fixed update of the app: the player's
+// controls, MIDI controller changes, and which parts of the simulation ran.
+// It also stores the seeds of every random engine and the star field setup.
+// Feeding a recording back through GameSim, ExplosionSim and StarFieldSim
+// reproduces the session exactly, without a window or input devices (see
+// Headless/HeadlessMain.cpp), so the same session can be timed repeatedly and
+// compared between builds.
+//
+// Recording starts with a new game, because the recording has to start from
+// a known simulation state. Window resizes and level edits aren't captured.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "Simulation/SimInput.h"
+#include "Simulation/SimRandom.h"
+#include "Simulation/StarFieldSim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+constexpr const char* DEFAULT_INPUT_RECORDING_FILENAME = "input.rec";
+
+//------------------------------------------------------------------------------
+// What happened during one fixed update of the app
+//------------------------------------------------------------------------------
+struct InputTick
+{
+  enum Flags : uint8_t
+  {
+    NewGame   = 1 << 0,    // GameSim and ExplosionSim were reset
+    StarField = 1 << 1,    // StarFieldSim was updated
+    Gameplay  = 1 << 2,    // Input applied, then explosions and GameSim updated
+  };
+
+  uint8_t flags          = 0;
+  uint8_t numMidiChanges = 0;
+  PlayerInput input;
+};
+
+//------------------------------------------------------------------------------
+struct MidiChange
+{
+  uint8_t controllerId = 0;
+  uint8_t value        = 0;
+};
+
+//------------------------------------------------------------------------------
+struct InputRecording
+{
+  struct Setup
+  {
+    Random::Seed gameSeed      = 0;
+    Random::Seed explosionSeed = 0;
+    Random::Seed starFieldSeed = 0;
+    double stepSeconds         = 0.0;
+    StarFieldSim::Bounds starFieldBounds;
+  };
+
+  Setup setup;
+  std::vector<InputTick> ticks;
+
+  // In tick order, InputTick::numMidiChanges per tick
+  std::vector<MidiChange> midiChanges;
+
+  void clear();
+  bool save(const std::string& filename) const;
+  bool load(const std::string& filename);
+};
+
+//------------------------------------------------------------------------------
+class InputRecorder
+{
+public:
+  // Recording starts when the next game does
+  void arm() { m_state = State::Armed; }
+  bool isArmed() const { return m_state == State::Armed; }
+  bool isRecording() const { return m_state == State::Recording; }
+
+  // The random engines must have been seeded from setup beforehand
+  void start(const InputRecording::Setup& setup);
+  void stop();
+
+  // Notes for the current tick
+  void recordNewGame();
+  void recordInput(const PlayerInput& input);
+  void recordMidiChange(size_t controllerId, int value);
+
+  // Called at the end of every fixed update
+  void endTick(bool starFieldUpdated);
+
+  const InputRecording& recording() const { return m_recording; }
+
+private:
+  enum class State
+  {
+    Off,
+    Armed,
+    Recording,
+  };
+
+  State m_state = State::Off;
+  InputTick m_tick;
+  InputRecording m_recording;
+};
+
+//------------------------------------------------------------------------------
+// Steps through a recording, one tick at a time
+//------------------------------------------------------------------------------
+class InputPlayer
+{
+public:
+  explicit InputPlayer(const InputRecording& recording)
+      : m_recording(recording)
+  {
+  }
+
+  bool isFinished() const { return m_tickIdx >= m_recording.ticks.size(); }
+  size_t tickIdx() const { return m_tickIdx; }
+
+  const InputTick& tick() const { return m_recording.ticks[m_tickIdx]; }
+  const MidiChange* midiChanges() const
+  {
+    return m_recording.midiChanges.data() + m_midiChangeIdx;
+  }
+
+  void next()
+  {
+    m_midiChangeIdx += tick().numMidiChanges;
+    m_tickIdx++;
+  }
+
+private:
+  const InputRecording& m_recording;
+  size_t m_tickIdx       = 0;
+  size_t m_midiChangeIdx = 0;
+};
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
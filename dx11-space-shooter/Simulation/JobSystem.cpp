@@ -0,0 +1,348 @@
+#include "Simulation/JobSystem.h"
+
+#include "utils/Log.h"
+
+#include <algorithm>
+
+using namespace sim;
+
+//------------------------------------------------------------------------------
+JobSystem::JobSystem(size_t numWorkers)
+{
+  TRACE
+  m_queues.reserve(numWorkers + 1);
+  for (size_t i = 0; i < numWorkers + 1; ++i)
+  {
+    m_queues.push_back(std::make_unique<TaskQueue>());
+    m_queues.back()->tasks.resize(TaskQueue::INITIAL_CAPACITY);
+  }
+
+  m_workers.reserve(numWorkers);
+  for (size_t i = 0; i < numWorkers; ++i)
+  {
+    m_workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+  }
+}
+
+//------------------------------------------------------------------------------
+JobSystem::~JobSystem()
+{
+  waitAll();
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_isQuitting = true;
+  }
+  m_wake.notify_all();
+
+  for (auto& worker : m_workers)
+  {
+    worker.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+size_t
+JobSystem::defaultNumWorkers()
+{
+  const size_t numCores = std::thread::hardware_concurrency();
+  return (numCores > 1) ? numCores - 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+JobSystem::Job*
+JobSystem::run(const char* name, Func func, Dependencies dependencies)
+{
+  Job* job    = createJob(name, 1, 1, dependencies);
+  job->m_func = std::move(func);
+  release(0, job);
+  return job;
+}
+
+//------------------------------------------------------------------------------
+JobSystem::Job*
+JobSystem::parallelFor(
+  const char* name,
+  size_t count,
+  size_t grainSize,
+  RangeFunc func,
+  Dependencies dependencies)
+{
+  Job* job
+    = createJob(name, count, std::max<size_t>(grainSize, 1), dependencies);
+  job->m_rangeFunc = std::move(func);
+  release(0, job);
+  return job;
+}
+
+//------------------------------------------------------------------------------
+// The job holds an extra blocker, so it can't start until the caller has set
+// its function and released it
+JobSystem::Job*
+JobSystem::createJob(
+  const char* name, size_t count, size_t grainSize, Dependencies dependencies)
+{
+  if (m_numJobs == m_jobs.size())
+  {
+    m_jobs.push_back(std::make_unique<Job>());
+    m_jobs.back()->m_dependents.reserve(Job::INITIAL_DEPENDENTS);
+  }
+  Job* job         = m_jobs[m_numJobs++].get();
+  job->m_name      = name;
+  job->m_count     = count;
+  job->m_grainSize = grainSize;
+  job->m_numRemaining.store(count);
+  job->m_numBlockers.store(1);
+  job->m_isFinished.store(false);
+  job->m_dependents.clear();
+  job->m_isDone = false;
+
+  std::lock_guard<std::mutex> lock(m_graphMutex);
+  for (Job* dependency : dependencies)
+  {
+    ASSERT(dependency);
+    if (!dependency->m_isDone)
+    {
+      dependency->m_dependents.push_back(job);
+      job->m_numBlockers++;
+    }
+  }
+  return job;
+}
+
+//------------------------------------------------------------------------------
+// Drops one blocker, queueing the job once none are left
+void
+JobSystem::release(size_t threadIdx, Job* job)
+{
+  if (job->m_numBlockers.fetch_sub(1) != 1)
+  {
+    return;
+  }
+
+  if (job->m_count == 0)
+  {
+    finish(threadIdx, job);
+    return;
+  }
+  push(threadIdx, Task{job, 0, job->m_count});
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::finish(size_t threadIdx, Job* job)
+{
+  {
+    // Freezes m_dependents, so it can be walked without the lock
+    std::lock_guard<std::mutex> lock(m_graphMutex);
+    job->m_isDone = true;
+  }
+
+  for (Job* dependent : job->m_dependents)
+  {
+    release(threadIdx, dependent);
+  }
+
+  // Last touch of the job, waitAll() may recycle it once it's finished
+  job->m_isFinished = true;
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::TaskQueue::pushBack(const Task& task)
+{
+  if (count == tasks.size())
+  {
+    // Unwrap into a buffer twice the size
+    const size_t capacity = tasks.size() * 2;
+    std::vector<Task> grown(
+      (capacity > INITIAL_CAPACITY) ? capacity : INITIAL_CAPACITY);
+    for (size_t i = 0; i < count; ++i)
+    {
+      grown[i] = tasks[(head + i) % tasks.size()];
+    }
+    tasks.swap(grown);
+    head = 0;
+  }
+  tasks[(head + count) % tasks.size()] = task;
+  count++;
+}
+
+//------------------------------------------------------------------------------
+JobSystem::Task
+JobSystem::TaskQueue::popBack()
+{
+  ASSERT(count > 0);
+  count--;
+  return tasks[(head + count) % tasks.size()];
+}
+
+//------------------------------------------------------------------------------
+JobSystem::Task
+JobSystem::TaskQueue::popFront()
+{
+  ASSERT(count > 0);
+  const Task task = tasks[head];
+  head            = (head + 1) % tasks.size();
+  count--;
+  return task;
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::push(size_t threadIdx, const Task& task)
+{
+  auto& queue = *m_queues[threadIdx];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.pushBack(task);
+    m_numQueued++;
+  }
+
+  // A worker going to sleep bumps m_numSleeping before re-checking
+  // m_numQueued, so one of the two always sees the other
+  if (m_numSleeping.load() > 0)
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_wake.notify_one();
+  }
+}
+
+//------------------------------------------------------------------------------
+bool
+JobSystem::pop(size_t threadIdx, Task& task)
+{
+  auto& queue = *m_queues[threadIdx];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.count == 0)
+  {
+    return false;
+  }
+  task = queue.popBack();
+  m_numQueued--;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+JobSystem::steal(size_t threadIdx, Task& task)
+{
+  const size_t numQueues = m_queues.size();
+  for (size_t i = 1; i < numQueues; ++i)
+  {
+    auto& queue = *m_queues[(threadIdx + i) % numQueues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.count != 0)
+    {
+      task = queue.popFront();
+      m_numQueued--;
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool
+JobSystem::findTask(size_t threadIdx, Task& task)
+{
+  return pop(threadIdx, task) || steal(threadIdx, task);
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::execute(size_t threadIdx, Task task)
+{
+  Job* job = task.job;
+
+  // Keep the first half and offer the rest up for stealing
+  while (task.end - task.begin > job->m_grainSize)
+  {
+    const size_t mid = task.begin + (task.end - task.begin) / 2;
+    push(threadIdx, Task{job, mid, task.end});
+    task.end = mid;
+  }
+
+  if (job->m_rangeFunc)
+  {
+    job->m_rangeFunc(task.begin, task.end);
+  }
+  else
+  {
+    job->m_func();
+  }
+
+  const size_t numItems = task.end - task.begin;
+  if (job->m_numRemaining.fetch_sub(numItems) == numItems)
+  {
+    finish(threadIdx, job);
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::wait(Job* job)
+{
+  TRACE
+  ASSERT(job);
+  Task task;
+  while (!job->isFinished())
+  {
+    if (findTask(0, task))
+    {
+      execute(0, task);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::waitAll()
+{
+  TRACE
+  for (size_t i = 0; i < m_numJobs; ++i)
+  {
+    Job* job = m_jobs[i].get();
+    if (!job->isFinished())
+    {
+      wait(job);
+    }
+
+    // Drop the captures now rather than when the job is next reused
+    job->m_func      = nullptr;
+    job->m_rangeFunc = nullptr;
+  }
+  m_numJobs = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+JobSystem::workerLoop(size_t threadIdx)
+{
+  logger::TimedRaiiBlock::setThreadName("Worker");
+
+  Task task;
+  for (;;)
+  {
+    if (findTask(threadIdx, task))
+    {
+      execute(threadIdx, task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_numSleeping++;
+    m_wake.wait(
+      lock, [this] { return m_isQuitting || (m_numQueued.load() > 0); });
+    m_numSleeping--;
+    if (m_isQuitting)
+    {
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
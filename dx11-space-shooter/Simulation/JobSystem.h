@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+// Work-stealing job scheduler.
+//
+// Jobs form a dependency graph: a job is queued once every job it depends on
+// has finished. A job covers a range [0, count) and is split in half
+// repeatedly, down to its grain size, as it runs. The split-off halves go on
+// the running thread's queue, where idle threads can steal them, so large
+// arrays fan out across cores.
+//
+// Each thread owns a queue. The owner pops its newest task (depth first, so
+// the data is still in cache) and thieves take the oldest (the largest
+// ranges). The thread that owns the JobSystem runs tasks while it waits, so
+// with no worker threads everything runs inline, in submission order.
+//
+// Jobs are created and waited on from the owning thread only. Jobs are kept
+// until waitAll(), which the owner calls once per frame, then recycled, so
+// once the queues and job pool have grown to fit a frame, scheduling doesn't
+// allocate. Keep captures small (two pointers) so std::function stores them
+// inline.
+//
+// TRACE records on the workers too, each in its own flame graph lane (see
+// utils/Log.h), but the logging macros aren't thread-safe, so job functions
+// shouldn't log.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+class JobSystem
+{
+public:
+  using Func      = std::function<void()>;
+  using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+  //----------------------------------------------------------------------------
+  class Job
+  {
+  public:
+    const char* name() const { return m_name; }
+    bool isFinished() const { return m_isFinished.load(); }
+
+  private:
+    friend class JobSystem;
+
+    const char* m_name = nullptr;
+    Func m_func;    // Either this or m_rangeFunc is set
+    RangeFunc m_rangeFunc;
+    size_t m_count     = 0;
+    size_t m_grainSize = 1;
+
+    std::atomic<size_t> m_numRemaining{0};    // Items not yet run
+    std::atomic<size_t> m_numBlockers{0};     // Unfinished dependencies
+    std::atomic<bool> m_isFinished{false};
+
+    // Guarded by m_graphMutex. No dependents are added once m_isDone is set.
+    // Reserved for INITIAL_DEPENDENTS when the job is pooled.
+    static const size_t INITIAL_DEPENDENTS = 8;
+    std::vector<Job*> m_dependents;
+    bool m_isDone = false;
+  };
+  using Dependencies = std::initializer_list<Job*>;
+
+  // All cores but the calling thread's by default
+  explicit JobSystem(size_t numWorkers = defaultNumWorkers());
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  static size_t defaultNumWorkers();
+  size_t numWorkers() const { return m_workers.size(); }
+
+  // Runs func once, after the dependencies have finished
+  Job* run(const char* name, Func func, Dependencies dependencies = {});
+
+  // Runs func over [0, count), in ranges of at least grainSize items
+  Job* parallelFor(
+    const char* name,
+    size_t count,
+    size_t grainSize,
+    RangeFunc func,
+    Dependencies dependencies = {});
+
+  // Runs tasks on the calling thread until the job has finished
+  void wait(Job* job);
+
+  // Waits for every job, then releases them
+  void waitAll();
+
+private:
+  struct Task
+  {
+    Job* job     = nullptr;
+    size_t begin = 0;
+    size_t end   = 0;
+  };
+
+  // Ring buffer, only grows when a frame queues more tasks than ever before.
+  // Starts with room for INITIAL_CAPACITY, as when a queue first fills
+  // depends on timing and may be well after warm-up.
+  struct TaskQueue
+  {
+    static const size_t INITIAL_CAPACITY = 64;
+
+    std::mutex mutex;
+    std::vector<Task> tasks;
+    size_t head  = 0;
+    size_t count = 0;
+
+    void pushBack(const Task& task);
+    Task popBack();
+    Task popFront();
+  };
+
+  Job* createJob(
+    const char* name, size_t count, size_t grainSize, Dependencies dependencies);
+  void release(size_t threadIdx, Job* job);
+  void finish(size_t threadIdx, Job* job);
+
+  void push(size_t threadIdx, const Task& task);
+  bool pop(size_t threadIdx, Task& task);
+  bool steal(size_t threadIdx, Task& task);
+  bool findTask(size_t threadIdx, Task& task);
+  void execute(size_t threadIdx, Task task);
+
+  void workerLoop(size_t threadIdx);
+
+  // Queue 0 belongs to the owning thread, the rest to the workers
+  std::vector<std::unique_ptr<TaskQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+
+  // Reused each frame, m_jobs[0, m_numJobs) are in use
+  std::vector<std::unique_ptr<Job>> m_jobs;
+  size_t m_numJobs = 0;
+  std::mutex m_graphMutex;
+
+  std::atomic<size_t> m_numQueued{0};
+  std::atomic<size_t> m_numSleeping{0};
+  std::atomic<bool> m_isQuitting{false};
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+};
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
@@ -1,6 +1,10 @@
-#include "pch.h"
-#include "LevelData.h"
+#include "Simulation/LevelData.h"
 #include "json11/json11.hpp"
+#include "utils/StringUtils.h"
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
 
 #include "utils/Log.h"
 
@@ -24,6 +28,11 @@ static const std::string SPAWN_TIME_KEY   = "spawnTimeS";
 static const std::string FORMATION_ID_KEY = "formationId";
 
 static const std::string WAVES_KEY = "waves";
+static const std::string POOLS_KEY = "pools";
+
+static const std::string POOL_PLAYER_SHOTS_KEY = "playerShots";
+static const std::string POOL_ENEMY_SHOTS_KEY  = "enemyShots";
+static const std::string POOL_ENEMIES_KEY      = "enemies";
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -60,7 +69,7 @@ Waypoint::from_json(const json11::Json& json)
         pts[i++] = static_cast<float>(coord.number_value());
       }
     }
-    point = DirectX::SimpleMath::Vector3(pts);
+    point = sim::Vec3(pts[0], pts[1], pts[2]);
   }
   return ret;
 }
@@ -75,57 +84,6 @@ Waypoint::to_json() const
      json11::Json::array{controlPoint.x, controlPoint.y, controlPoint.z}}};
 }
 
-//------------------------------------------------------------------------------
-void
-Path::debugRender(
-  DX::DebugBatchType* batch,
-  size_t selectedPointIdx,
-  size_t selectedControlIdx) const
-{
-  using DirectX::XMVECTOR;
-
-  static const float radius   = 0.6f;
-  static const XMVECTOR xaxis = DirectX::g_XMIdentityR0 * radius;
-  static const XMVECTOR yaxis = DirectX::g_XMIdentityR1 * radius;
-
-  static const XMVECTOR SELECTED_COLOR = DirectX::Colors::OrangeRed;
-  static const XMVECTOR POINT_COLOR    = DirectX::Colors::White;
-  static const XMVECTOR CONTROL_COLOR  = DirectX::Colors::Yellow;
-
-  ASSERT(!waypoints.empty());
-  auto prevPoint = waypoints[0].wayPoint;
-  DX::DrawRing(
-    batch,
-    prevPoint,
-    xaxis,
-    yaxis,
-    (selectedPointIdx == 0) ? SELECTED_COLOR : POINT_COLOR);
-
-  for (size_t i = 1; i < waypoints.size(); ++i)
-  {
-    const auto& point   = waypoints[i].wayPoint;
-    const auto& control = waypoints[i].controlPoint;
-
-    DX::DrawCurve(batch, prevPoint, point, control);
-    DX::DrawRing(
-      batch,
-      point,
-      xaxis,
-      yaxis,
-      (selectedPointIdx == i) ? SELECTED_COLOR : POINT_COLOR);
-
-    DX::DrawLine(batch, point, control, DirectX::Colors::Yellow);
-    DX::DrawRing(
-      batch,
-      control,
-      xaxis,
-      yaxis,
-      (selectedControlIdx == i) ? SELECTED_COLOR : CONTROL_COLOR);
-
-    prevPoint = point;
-  }
-}
-
 //------------------------------------------------------------------------------
 Path
 Path::from_json(const json11::Json& json)
@@ -155,9 +113,88 @@ Path::from_json(const json11::Json& json)
       }
     }
   }
+  ret.bake();
   return ret;
 }
 
+//------------------------------------------------------------------------------
+static sim::Vec3
+bezier(
+  float t,
+  const sim::Vec3& startPos,
+  const sim::Vec3& endPos,
+  const sim::Vec3& control)
+{
+  // https://pomax.github.io/bezierinfo/
+  float t2  = t * t;
+  float mt  = 1 - t;
+  float mt2 = mt * mt;
+  return (startPos * mt2) + (control * (2 * mt * t)) + (endPos * t2);
+}
+
+//------------------------------------------------------------------------------
+void
+Path::bake()
+{
+  // Fine steps measure the length, then the samples are spaced along it
+  constexpr size_t STEPS_PER_SEGMENT = SAMPLES_PER_SEGMENT * 4;
+  static std::atomic<uint64_t> s_lastVersion{0};
+
+  version = ++s_lastVersion;
+  arcSamples.clear();
+  durationS   = 0.0f;
+  samplesPerS = 0.0f;
+  if (waypoints.size() < 2)
+  {
+    // Nothing to travel along, ships finish as soon as they start
+    arcSamples.push_back(
+      waypoints.empty() ? sim::Vec3() : waypoints[0].wayPoint);
+    return;
+  }
+
+  const size_t numSegments = waypoints.size() - 1;
+  std::vector<sim::Vec3> steps;
+  std::vector<float> distances;
+  steps.reserve(numSegments * STEPS_PER_SEGMENT + 1);
+  distances.reserve(numSegments * STEPS_PER_SEGMENT + 1);
+  steps.push_back(waypoints[0].wayPoint);
+  distances.push_back(0.0f);
+  for (size_t seg = 0; seg < numSegments; ++seg)
+  {
+    const auto& start = waypoints[seg];
+    const auto& end   = waypoints[seg + 1];
+    for (size_t i = 1; i <= STEPS_PER_SEGMENT; ++i)
+    {
+      const float t = static_cast<float>(i) / STEPS_PER_SEGMENT;
+      const sim::Vec3 point
+        = bezier(t, start.wayPoint, end.wayPoint, end.controlPoint);
+      distances.push_back(distances.back() + (point - steps.back()).Length());
+      steps.push_back(point);
+    }
+  }
+
+  const size_t numSamples = numSegments * SAMPLES_PER_SEGMENT + 1;
+  const float length      = distances.back();
+  arcSamples.resize(numSamples);
+  size_t step = 0;
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    const float distance = length * i / (numSamples - 1);
+    while ((step + 2 < steps.size()) && (distances[step + 1] < distance))
+    {
+      ++step;
+    }
+    const float span = distances[step + 1] - distances[step];
+    const float frac
+      = (span > 0.0f) ? (distance - distances[step]) / span : 0.0f;
+    arcSamples[i]
+      = steps[step] + (steps[step + 1] - steps[step]) * std::min(frac, 1.0f);
+  }
+
+  durationS   = numSegments * SEGMENT_DURATION_S;
+  samplesPerS = (numSamples - 1) / durationS;
+}
+
 //------------------------------------------------------------------------------
 json11::Json
 Path::to_json() const
@@ -310,6 +347,19 @@ Level::from_json(const json11::Json& json)
         ret.waves.emplace_back(Wave::from_json(wave));
       }
     }
+    else if (value.is_object() && key == POOLS_KEY)
+    {
+      auto readSize = [&value](const std::string& poolKey, size_t& size) {
+        const auto& poolSize = value[poolKey];
+        if (poolSize.is_number() && poolSize.int_value() >= 0)
+        {
+          size = static_cast<size_t>(poolSize.int_value());
+        }
+      };
+      readSize(POOL_PLAYER_SHOTS_KEY, ret.pools.playerShots);
+      readSize(POOL_ENEMY_SHOTS_KEY, ret.pools.enemyShots);
+      readSize(POOL_ENEMIES_KEY, ret.pools.enemies);
+    }
   }
   return ret;
 }
@@ -318,7 +368,19 @@ Level::from_json(const json11::Json& json)
 json11::Json
 Level::to_json() const
 {
-  return json11::Json::object{{WAVES_KEY, waves}};
+  // Only levels that override the default pool sizes store them
+  if (pools == PoolSizes())
+  {
+    return json11::Json::object{{WAVES_KEY, waves}};
+  }
+
+  return json11::Json::object{
+    {WAVES_KEY, waves},
+    {POOLS_KEY,
+     json11::Json::object{
+       {POOL_PLAYER_SHOTS_KEY, static_cast<int>(pools.playerShots)},
+       {POOL_ENEMY_SHOTS_KEY, static_cast<int>(pools.enemyShots)},
+       {POOL_ENEMIES_KEY, static_cast<int>(pools.enemies)}}}};
 }
 
 //------------------------------------------------------------------------------
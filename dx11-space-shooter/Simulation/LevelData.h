@@ -1,6 +1,14 @@
 #pragma once
 
 #include "ResourceIDs.h"    // ModelResource
+#include "Simulation/EntityStore.h"    // PoolSizes
+#include "Simulation/SimMath.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace json11
 {
 class Json;
@@ -9,23 +17,53 @@ class Json;
 //------------------------------------------------------------------------------
 struct Waypoint
 {
-  DirectX::SimpleMath::Vector3 wayPoint     = {};
-  DirectX::SimpleMath::Vector3 controlPoint = {};
+  sim::Vec3 wayPoint     = {};
+  sim::Vec3 controlPoint = {};
 
   static Waypoint from_json(const json11::Json& json);
   json11::Json to_json() const;
 };
 
+//------------------------------------------------------------------------------
+// A chain of quadratic bezier segments, one between each pair of waypoints.
+//
+// Ships take SEGMENT_DURATION_S per segment, but travel at constant speed
+// along the whole path: bake() resamples the curve into points spaced evenly
+// by arc length, and positionAtTime() interpolates between them. Every ship
+// on the path shares the table. Rebake whenever the waypoints change.
+//
+// Each bake also gives the path a new, globally unique version, so anything
+// built from the waypoints (e.g. debug geometry) can be cached against it.
 //------------------------------------------------------------------------------
 struct Path
 {
+  static constexpr float SEGMENT_DURATION_S   = 1.2f;
+  static constexpr size_t SAMPLES_PER_SEGMENT = 32;
+
   std::wstring id;
   std::vector<Waypoint> waypoints;
 
-  void debugRender(
-    DX::DebugBatchType* batch,
-    size_t selectedPointIdx   = -1,
-    size_t selectedControlIdx = -1) const;
+  // Baked
+  std::vector<sim::Vec3> arcSamples;
+  float durationS   = 0.0f;
+  float samplesPerS = 0.0f;
+  uint64_t version  = 0;    // 0 until baked
+
+  void bake();
+
+  // Position of a ship that started the path timeS ago. Clamped to the ends.
+  sim::Vec3 positionAtTime(float timeS) const
+  {
+    const size_t lastIdx = arcSamples.size() - 1;
+    const float x        = std::max(timeS * samplesPerS, 0.0f);
+    const size_t idx     = static_cast<size_t>(x);
+    if (idx >= lastIdx)
+    {
+      return arcSamples[lastIdx];
+    }
+    const sim::Vec3& a = arcSamples[idx];
+    return a + (arcSamples[idx + 1] - a) * (x - static_cast<float>(idx));
+  }
 
   static Path from_json(const json11::Json& json);
   json11::Json to_json() const;
@@ -70,6 +108,7 @@ struct Wave
 struct Level
 {
   std::vector<Wave> waves;
+  PoolSizes pools;    // Max live entities of each type during the level
 
   static Level from_json(const json11::Json& json);
   json11::Json to_json() const;
@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+// Clock interface the simulation is driven by.
+//
+// The game passes its DX::StepTimer (QueryPerformanceCounter based), while the
+// headless runner uses FixedStepClock to advance time by a constant step as
+// fast as the CPU allows.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+// Rate the gameplay is simulated at, whatever the display rate
+constexpr double FIXED_STEP_SECONDS = 1.0 / 60.0;
+
+//------------------------------------------------------------------------------
+class IClock
+{
+public:
+  virtual ~IClock() = default;
+
+  // Time since the previous update
+  virtual double GetElapsedSeconds() const = 0;
+
+  // Time since the start of the simulation
+  virtual double GetTotalSeconds() const = 0;
+};
+
+//------------------------------------------------------------------------------
+class FixedStepClock : public IClock
+{
+public:
+  explicit FixedStepClock(double stepSeconds = FIXED_STEP_SECONDS)
+      : m_stepSeconds(stepSeconds)
+  {
+  }
+
+  double GetElapsedSeconds() const override { return m_elapsedSeconds; }
+  double GetTotalSeconds() const override { return m_totalSeconds; }
+  uint64_t GetFrameCount() const { return m_frameCount; }
+
+  void setStepSeconds(double stepSeconds) { m_stepSeconds = stepSeconds; }
+  double stepSeconds() const { return m_stepSeconds; }
+
+  void tick()
+  {
+    m_elapsedSeconds = m_stepSeconds;
+    m_frameCount++;
+
+    // Derived from the frame count rather than accumulated, so long runs
+    // don't drift.
+    m_totalSeconds = m_frameCount * m_stepSeconds;
+  }
+
+  void reset()
+  {
+    m_elapsedSeconds = 0.0;
+    m_totalSeconds   = 0.0;
+    m_frameCount     = 0;
+  }
+
+private:
+  double m_stepSeconds;
+  double m_elapsedSeconds = 0.0;
+  double m_totalSeconds   = 0.0;
+  uint64_t m_frameCount   = 0;
+};
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
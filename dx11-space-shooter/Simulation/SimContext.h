@@ -0,0 +1,98 @@
+#pragma once
+
+#include "ResourceIDs.h"    // ModelResource
+#include "Simulation/EntityStore.h"
+#include "Simulation/SimMath.h"
+#include "utils/LinearArena.h"
+
+#include <array>
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+constexpr int INITIAL_NUM_PLAYER_LIVES = 2;
+
+//------------------------------------------------------------------------------
+enum class PlayerState
+{
+  Normal,
+  Dying,
+  Reviving,
+};
+
+//------------------------------------------------------------------------------
+// Things that happen during a simulation update which the presentation layer
+// (audio, particles, HUD) reacts to.
+//------------------------------------------------------------------------------
+enum class SimEvent
+{
+  PlayerShot,
+  EnemyShot,
+  PlayerExploded,
+  EnemyExploded,
+  ScoreChanged,
+  LivesChanged,
+};
+
+//------------------------------------------------------------------------------
+class ISimEventListener
+{
+public:
+  virtual ~ISimEventListener() = default;
+
+  // position is the world space centre of the entity involved (if any)
+  virtual void onSimEvent(SimEvent event, const sim::Vec3& position) = 0;
+};
+
+//------------------------------------------------------------------------------
+// All of the state mutated by the simulation. Contains no rendering or
+// platform types so it can be driven headless.
+//------------------------------------------------------------------------------
+struct SimContext
+{
+  EntityStore entities;
+
+  // Collision bounds of each model, populated once the models are loaded
+  static constexpr size_t NUM_MODELS
+    = static_cast<size_t>(ModelResource::COUNT);
+  std::array<sim::BoundingSphere, NUM_MODELS> modelBounds = {};
+
+  sim::Vec3 playerAccel    = {};
+  int playerScore          = 0;
+  int playerLives          = INITIAL_NUM_PLAYER_LIVES;
+  PlayerState playerState  = PlayerState::Normal;
+  float playerDeathTimerS  = 0.0f;
+  float playerReviveTimerS = 0.0f;
+
+  float playerSpeed       = 200.0f;
+  float playerFriction    = 60.0f;
+  float playerMaxVelocity = 40.0f;
+  float playerMinVelocity = 0.3f;
+
+  // Scratch memory for the current update, reset at the start of each step
+  static constexpr size_t FRAME_ARENA_SIZE = 64 * 1024;
+  memory::LinearArena frameArena{FRAME_ARENA_SIZE};
+
+  //----------------------------------------------------------------------------
+  const sim::BoundingSphere& bound(size_t entityIdx) const
+  {
+    return modelBounds[static_cast<size_t>(entities.model[entityIdx])];
+  }
+
+  sim::BoundingSphere& modelBound(ModelResource model)
+  {
+    return modelBounds[static_cast<size_t>(model)];
+  }
+
+  //----------------------------------------------------------------------------
+  void resetPlayer()
+  {
+    playerAccel        = sim::Vec3();
+    playerScore        = 0;
+    playerLives        = INITIAL_NUM_PLAYER_LIVES;
+    playerState        = PlayerState::Normal;
+    playerDeathTimerS  = 0.0f;
+    playerReviveTimerS = 0.0f;
+  }
+};
+
+//------------------------------------------------------------------------------
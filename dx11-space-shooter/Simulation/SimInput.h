@@ -0,0 +1,34 @@
+//------------------------------------------------------------------------------
+// Player controls for one simulation update, independent of the input device.
+// The game maps the keyboard onto these, and input recordings store them.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+enum InputButton : uint8_t
+{
+  Input_Up      = 1 << 0,
+  Input_Down    = 1 << 1,
+  Input_Left    = 1 << 2,
+  Input_Right   = 1 << 3,
+  Input_Fire    = 1 << 4,
+  Input_Explode = 1 << 5,    // Debug explosion on the player
+};
+
+//------------------------------------------------------------------------------
+struct PlayerInput
+{
+  uint8_t held    = 0;    // InputButtons currently down
+  uint8_t pressed = 0;    // InputButtons that went down this update
+
+  bool isHeld(InputButton button) const { return (held & button) != 0; }
+  bool isPressed(InputButton button) const { return (pressed & button) != 0; }
+};
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+// Minimal vector math for the simulation core.
+//
+// The game renders with DirectXMath/SimpleMath, which is not available on
+// every platform the simulation needs to build on. These types mirror the
+// subset of SimpleMath::Vector3 / DirectX::BoundingSphere that gameplay uses.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cmath>
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+struct Vec3
+{
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+
+  Vec3() = default;
+  constexpr Vec3(float _x, float _y, float _z)
+      : x(_x)
+      , y(_y)
+      , z(_z)
+  {
+  }
+
+  Vec3& operator+=(const Vec3& v)
+  {
+    x += v.x;
+    y += v.y;
+    z += v.z;
+    return *this;
+  }
+  Vec3& operator-=(const Vec3& v)
+  {
+    x -= v.x;
+    y -= v.y;
+    z -= v.z;
+    return *this;
+  }
+  Vec3& operator*=(float s)
+  {
+    x *= s;
+    y *= s;
+    z *= s;
+    return *this;
+  }
+
+  float Dot(const Vec3& v) const { return x * v.x + y * v.y + z * v.z; }
+  float LengthSquared() const { return Dot(*this); }
+  float Length() const { return std::sqrt(LengthSquared()); }
+
+  // NB. Zero length vectors normalize to zero (matching XMVector3Normalize)
+  void Normalize()
+  {
+    const float length = Length();
+    if (length > 0.0f)
+    {
+      *this *= (1.0f / length);
+    }
+    else
+    {
+      x = y = z = 0.0f;
+    }
+  }
+};
+
+//------------------------------------------------------------------------------
+inline Vec3
+operator+(const Vec3& a, const Vec3& b)
+{
+  return Vec3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+inline Vec3
+operator-(const Vec3& a, const Vec3& b)
+{
+  return Vec3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
+
+inline Vec3
+operator-(const Vec3& v)
+{
+  return Vec3(-v.x, -v.y, -v.z);
+}
+
+inline Vec3
+operator*(const Vec3& v, float s)
+{
+  return Vec3(v.x * s, v.y * s, v.z * s);
+}
+
+inline Vec3
+operator*(float s, const Vec3& v)
+{
+  return Vec3(v.x * s, v.y * s, v.z * s);
+}
+
+//------------------------------------------------------------------------------
+struct BoundingSphere
+{
+  Vec3 Center;
+  float Radius = 0.0f;
+};
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,55 @@
+//------------------------------------------------------------------------------
+// Seedable random number source for the simulation.
+//
+// std::default_random_engine and the std distributions are implementation
+// defined, so the same seed produces different sequences under MSVC and
+// libstdc++. Using a fixed engine (mt19937) and our own range mapping keeps a
+// seed reproducible across compilers and platforms.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <random>
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+class Random
+{
+public:
+  using Seed = uint32_t;
+
+  explicit Random(Seed seed = std::mt19937::default_seed) { this->seed(seed); }
+
+  void seed(Seed seed)
+  {
+    m_seed = seed;
+    m_engine.seed(seed);
+  }
+  Seed currentSeed() const { return m_seed; }
+
+  uint32_t next() { return static_cast<uint32_t>(m_engine()); }
+
+  // [min, max)
+  float uniformFloat(float min, float max)
+  {
+    // 24 random bits fills a float mantissa exactly
+    const float unit = (next() >> 8) * (1.0f / 16777216.0f);
+    return min + (unit * (max - min));
+  }
+
+  // [0, count)
+  size_t uniformIndex(size_t count)
+  {
+    return static_cast<size_t>((static_cast<uint64_t>(next()) * count) >> 32);
+  }
+
+private:
+  Seed m_seed = 0;
+  std::mt19937 m_engine;
+};
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+// Batched sphere vs sphere overlap tests.
+//
+// Tests one sphere against many, stored as flat arrays of centres and radii,
+// 8 (AVX2) or 4 (SSE2) at a time, with a scalar loop for the remainder and
+// for other platforms. Overlap uses squared distances, so there's no sqrt.
+//
+// The result is a bit mask: bit i of mask[i / 64] is set if sphere i overlaps.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "Simulation/SimMath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#define SIM_SPHERE_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)                                     \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIM_SPHERE_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace sim
+{
+//------------------------------------------------------------------------------
+struct SphereArrays
+{
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> radius;
+
+  static size_t maskWords(size_t count) { return (count + 63) / 64; }
+
+  void resize(size_t count)
+  {
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    radius.resize(count);
+  }
+
+  void set(size_t i, const Vec3& center, float r)
+  {
+    x[i]      = center.x;
+    y[i]      = center.y;
+    z[i]      = center.z;
+    radius[i] = r;
+  }
+};
+
+//------------------------------------------------------------------------------
+inline bool
+spheresOverlap(
+  float ax, float ay, float az, float ar, float bx, float by, float bz, float br)
+{
+  const float dx   = ax - bx;
+  const float dy   = ay - by;
+  const float dz   = az - bz;
+  const float rSum = ar + br;
+  return (dx * dx + dy * dy + dz * dz) <= (rSum * rSum);
+}
+
+//------------------------------------------------------------------------------
+// mask must have room for (count + 63) / 64 words
+inline void
+sphereOverlapMask(
+  const BoundingSphere& sphere,
+  const float* x,
+  const float* y,
+  const float* z,
+  const float* radius,
+  size_t count,
+  uint64_t* mask)
+{
+  for (size_t w = 0; w < SphereArrays::maskWords(count); ++w)
+  {
+    mask[w] = 0;
+  }
+
+  const float sx = sphere.Center.x;
+  const float sy = sphere.Center.y;
+  const float sz = sphere.Center.z;
+  const float sr = sphere.Radius;
+  size_t i       = 0;
+
+#if defined(SIM_SPHERE_KERNEL_AVX2)
+  const __m256 vx = _mm256_set1_ps(sx);
+  const __m256 vy = _mm256_set1_ps(sy);
+  const __m256 vz = _mm256_set1_ps(sz);
+  const __m256 vr = _mm256_set1_ps(sr);
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 dx   = _mm256_sub_ps(vx, _mm256_loadu_ps(x + i));
+    const __m256 dy   = _mm256_sub_ps(vy, _mm256_loadu_ps(y + i));
+    const __m256 dz   = _mm256_sub_ps(vz, _mm256_loadu_ps(z + i));
+    const __m256 rSum = _mm256_add_ps(vr, _mm256_loadu_ps(radius + i));
+    const __m256 distSq = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+      _mm256_mul_ps(dz, dz));
+    const __m256 hit = _mm256_cmp_ps(
+      distSq, _mm256_mul_ps(rSum, rSum), _CMP_LE_OQ);
+    mask[i / 64] |= uint64_t(_mm256_movemask_ps(hit)) << (i % 64);
+  }
+#elif defined(SIM_SPHERE_KERNEL_SSE2)
+  const __m128 vx = _mm_set1_ps(sx);
+  const __m128 vy = _mm_set1_ps(sy);
+  const __m128 vz = _mm_set1_ps(sz);
+  const __m128 vr = _mm_set1_ps(sr);
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128 dx     = _mm_sub_ps(vx, _mm_loadu_ps(x + i));
+    const __m128 dy     = _mm_sub_ps(vy, _mm_loadu_ps(y + i));
+    const __m128 dz     = _mm_sub_ps(vz, _mm_loadu_ps(z + i));
+    const __m128 rSum   = _mm_add_ps(vr, _mm_loadu_ps(radius + i));
+    const __m128 distSq = _mm_add_ps(
+      _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    const __m128 hit = _mm_cmple_ps(distSq, _mm_mul_ps(rSum, rSum));
+    mask[i / 64] |= uint64_t(_mm_movemask_ps(hit)) << (i % 64);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    if (spheresOverlap(sx, sy, sz, sr, x[i], y[i], z[i], radius[i]))
+    {
+      mask[i / 64] |= uint64_t(1) << (i % 64);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void
+sphereOverlapMask(
+  const BoundingSphere& sphere,
+  const SphereArrays& spheres,
+  size_t count,
+  uint64_t* mask)
+{
+  sphereOverlapMask(
+    sphere,
+    spheres.x.data(),
+    spheres.y.data(),
+    spheres.z.data(),
+    spheres.radius.data(),
+    count,
+    mask);
+}
+
+}    // namespace sim
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,339 @@
+#include "Simulation/StarFieldSim.h"
+#include "Simulation/EntityStore.h"    // countTrailingZeros
+
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define SIM_STAR_KERNEL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)                                     \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIM_STAR_KERNEL_SSE2
+#include <emmintrin.h>
+#endif
+
+const float ZBOUNDMIN = 1.0f;
+const float ZBOUNDMAX = 8.5f;
+const float SCALE_MIN = 0.2f;
+const float SCALE_MAX = 0.5f;
+
+const float MILLISECS_PER_SEC = 1000.0f;
+
+// Fraction of the x range an analytic star moves across each time it wraps.
+// The golden ratio spreads the successive positions evenly.
+const float WRAP_X_STEP = 0.618034f;
+
+//------------------------------------------------------------------------------
+StarFieldSim::StarFieldSim(sim::Random::Seed seed)
+    : m_random(seed)
+{
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::setBounds(
+  float screenWidth, float screenHeight, float starWidth, float starHeight)
+{
+  setBounds(Bounds{screenWidth, screenHeight, starWidth, starHeight});
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::setBounds(const Bounds& bounds)
+{
+  TRACE
+  m_bounds = bounds;
+  initialisePositions();
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::reset(sim::Random::Seed seed)
+{
+  TRACE
+  m_random.seed(seed);
+  initialisePositions();
+}
+
+//------------------------------------------------------------------------------
+float
+StarFieldSim::randomX()
+{
+  return m_random.uniformFloat(-m_bounds.starWidth, m_bounds.screenWidth);
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::initialisePositions()
+{
+  TRACE
+  const float xRange = m_bounds.screenWidth + m_bounds.starWidth;
+  for (size_t l = 0; l < NUM_LAYERS; ++l)
+  {
+    for (size_t i = 0; i < MAX_NUM_PARTICLES; ++i)
+    {
+      auto& p      = m_particleLayers[l][i];
+      p.position.x = randomX();
+      p.position.y
+        = m_random.uniformFloat(-m_bounds.starHeight, m_bounds.screenHeight);
+      p.position.z = m_random.uniformFloat(ZBOUNDMIN, ZBOUNDMAX);
+      p.scale      = m_random.uniformFloat(SCALE_MIN, SCALE_MAX);
+
+      m_startY[l][i] = p.position.y + m_bounds.starHeight;
+      m_startX[l][i]
+        = (xRange > 0.0f) ? (p.position.x + m_bounds.starWidth) / xRange : 0.0f;
+    }
+  }
+  m_timeS = 0.0;
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::update(float elapsedTimeS)
+{
+  TRACE
+  m_numUpdates++;
+  m_timeS += elapsedTimeS;
+  if (m_mode == Mode::Analytic)
+  {
+    return;
+  }
+
+  moveLayers(elapsedTimeS, 0, NUM_LAYERS);
+  regenerateWrapped();
+}
+
+//------------------------------------------------------------------------------
+sim::JobSystem::Job*
+StarFieldSim::scheduleUpdate(sim::JobSystem& jobs, float elapsedTimeS)
+{
+  m_numUpdates++;
+  m_timeS += elapsedTimeS;
+  if (m_mode == Mode::Analytic)
+  {
+    return nullptr;
+  }
+
+  auto* motion = jobs.parallelFor(
+    "StarFieldMotion",
+    NUM_LAYERS,
+    1,
+    [this, elapsedTimeS](size_t begin, size_t end) {
+      moveLayers(elapsedTimeS, begin, end);
+    });
+  return jobs.run(
+    "StarFieldRegenerate", [this] { regenerateWrapped(); }, {motion});
+}
+
+//------------------------------------------------------------------------------
+// Each layer is slower than the one before. Accumulated the same way in every
+// range, so the speeds don't depend on how the layers were split.
+float
+StarFieldSim::layerSpeed(size_t layerIdx) const
+{
+  float speed = m_bounds.screenHeight / (m_timePerWrapMs / MILLISECS_PER_SEC);
+  const float layerSpeedOffset = speed / (NUM_LAYERS + 2);
+  for (size_t i = 0; i <= layerIdx; ++i)
+  {
+    speed -= layerSpeedOffset;
+  }
+  return speed;
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::moveLayers(float elapsedTimeS, size_t beginLayer, size_t endLayer)
+{
+  for (size_t l = beginLayer; l < endLayer; ++l)
+  {
+    const float speed = layerSpeed(l);
+    auto& wrapped     = m_wrapped[l];
+    wrapped.fill(0);
+
+    auto& layer = m_particleLayers[l];
+    for (size_t i = 0; i < MAX_NUM_PARTICLES; ++i)
+    {
+      // Particle Motion
+      auto& p = layer[i];
+      p.position.y += speed * elapsedTimeS;
+
+      if (p.position.y > m_bounds.screenHeight)
+      {
+        p.position.y
+          = -m_bounds.starHeight + (p.position.y - m_bounds.screenHeight);
+        wrapped[i / 64] |= uint64_t(1) << (i % 64);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Regenerate old particles
+void
+StarFieldSim::regenerateWrapped()
+{
+  for (size_t l = 0; l < NUM_LAYERS; ++l)
+  {
+    for (size_t w = 0; w < m_wrapped[l].size(); ++w)
+    {
+      for (uint64_t bits = m_wrapped[l][w]; bits != 0; bits &= bits - 1)
+      {
+        const size_t i = w * 64 + countTrailingZeros(bits);
+        m_particleLayers[l][i].position.x = randomX();
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+StarFieldSim::evaluatePositions(float* x, float* y) const
+{
+  TRACE
+  for (size_t l = 0; l < NUM_LAYERS; ++l)
+  {
+    float* layerX = x + (l * MAX_NUM_PARTICLES);
+    float* layerY = y + (l * MAX_NUM_PARTICLES);
+    if (m_mode == Mode::Analytic)
+    {
+      evaluateLayer(l, layerX, layerY);
+      continue;
+    }
+
+    for (size_t i = 0; i < MAX_NUM_PARTICLES; ++i)
+    {
+      layerX[i] = m_particleLayers[l][i].position.x;
+      layerY[i] = m_particleLayers[l][i].position.y;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Analytic positions for one layer of stars
+struct StarTransform
+{
+  float phase;    // Distance past the layer's last whole wrap
+  float wrapHeight;
+  float xPhase;    // Fraction of the x range moved over the whole wraps
+  float xRange;
+  float xOffset;
+  float yOffset;
+};
+
+//------------------------------------------------------------------------------
+// Every path does the same operations per lane, and x stays positive until
+// the final scale so truncating is a floor
+static void
+evaluateStars(
+  const float* startX,
+  const float* startY,
+  size_t count,
+  const StarTransform& t,
+  float* x,
+  float* y)
+{
+  size_t i = 0;
+
+#if defined(SIM_STAR_KERNEL_AVX2)
+  const __m256 phase   = _mm256_set1_ps(t.phase);
+  const __m256 height  = _mm256_set1_ps(t.wrapHeight);
+  const __m256 xPhase  = _mm256_set1_ps(t.xPhase);
+  const __m256 xRange  = _mm256_set1_ps(t.xRange);
+  const __m256 step    = _mm256_set1_ps(WRAP_X_STEP);
+  const __m256 xOffset = _mm256_set1_ps(t.xOffset);
+  const __m256 yOffset = _mm256_set1_ps(t.yOffset);
+  for (; i < count - (count % 8); i += 8)
+  {
+    const __m256 s       = _mm256_add_ps(_mm256_loadu_ps(startY + i), phase);
+    const __m256 wrapped = _mm256_cmp_ps(s, height, _CMP_GE_OQ);
+    const __m256 newY    = _mm256_sub_ps(
+      _mm256_sub_ps(s, _mm256_and_ps(wrapped, height)), yOffset);
+
+    __m256 u = _mm256_add_ps(
+      _mm256_add_ps(_mm256_loadu_ps(startX + i), xPhase),
+      _mm256_and_ps(wrapped, step));
+    u = _mm256_sub_ps(u, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(u)));
+    const __m256 newX = _mm256_sub_ps(_mm256_mul_ps(u, xRange), xOffset);
+
+    _mm256_storeu_ps(x + i, newX);
+    _mm256_storeu_ps(y + i, newY);
+  }
+#elif defined(SIM_STAR_KERNEL_SSE2)
+  const __m128 phase   = _mm_set1_ps(t.phase);
+  const __m128 height  = _mm_set1_ps(t.wrapHeight);
+  const __m128 xPhase  = _mm_set1_ps(t.xPhase);
+  const __m128 xRange  = _mm_set1_ps(t.xRange);
+  const __m128 step    = _mm_set1_ps(WRAP_X_STEP);
+  const __m128 xOffset = _mm_set1_ps(t.xOffset);
+  const __m128 yOffset = _mm_set1_ps(t.yOffset);
+  for (; i < count - (count % 4); i += 4)
+  {
+    const __m128 s       = _mm_add_ps(_mm_loadu_ps(startY + i), phase);
+    const __m128 wrapped = _mm_cmpge_ps(s, height);
+    const __m128 newY
+      = _mm_sub_ps(_mm_sub_ps(s, _mm_and_ps(wrapped, height)), yOffset);
+
+    __m128 u = _mm_add_ps(
+      _mm_add_ps(_mm_loadu_ps(startX + i), xPhase),
+      _mm_and_ps(wrapped, step));
+    u = _mm_sub_ps(u, _mm_cvtepi32_ps(_mm_cvttps_epi32(u)));
+    const __m128 newX = _mm_sub_ps(_mm_mul_ps(u, xRange), xOffset);
+
+    _mm_storeu_ps(x + i, newX);
+    _mm_storeu_ps(y + i, newY);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    const float s      = startY[i] + t.phase;
+    const bool wrapped = s >= t.wrapHeight;
+    y[i]               = (s - (wrapped ? t.wrapHeight : 0.0f)) - t.yOffset;
+
+    float u = (startX[i] + t.xPhase) + (wrapped ? WRAP_X_STEP : 0.0f);
+    u       = u - static_cast<float>(static_cast<int>(u));
+    x[i]    = u * t.xRange - t.xOffset;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Each star has travelled speed * time down a wrap range of screenHeight +
+// starHeight. The whole number of wraps for the layer is taken in double
+// precision, so the per-star part stays accurate however long the game runs:
+// a star has wrapped once more than the layer if its start plus the layer's
+// remainder passes the bottom, and moved WRAP_X_STEP across for every wrap.
+void
+StarFieldSim::evaluateLayer(size_t layerIdx, float* x, float* y) const
+{
+  StarTransform transform;
+  transform.wrapHeight = m_bounds.screenHeight + m_bounds.starHeight;
+  transform.xRange     = m_bounds.screenWidth + m_bounds.starWidth;
+  transform.xOffset    = m_bounds.starWidth;
+  transform.yOffset    = m_bounds.starHeight;
+  if (!(transform.wrapHeight > 0.0f))
+  {
+    std::fill(x, x + MAX_NUM_PARTICLES, 0.0f);
+    std::fill(y, y + MAX_NUM_PARTICLES, 0.0f);
+    return;
+  }
+
+  const double distance = double(layerSpeed(layerIdx)) * m_timeS;
+  const double numWraps = std::floor(distance / transform.wrapHeight);
+  const double xSteps   = numWraps * WRAP_X_STEP;
+  transform.phase
+    = static_cast<float>(distance - numWraps * transform.wrapHeight);
+  transform.xPhase = static_cast<float>(xSteps - std::floor(xSteps));
+
+  evaluateStars(
+    m_startX[layerIdx].data(),
+    m_startY[layerIdx].data(),
+    MAX_NUM_PARTICLES,
+    transform,
+    x,
+    y);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Simulation/JobSystem.h"
+#include "Simulation/SimMath.h"
+#include "Simulation/SimRandom.h"
+
+#include <array>
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+// Scrolling star positions in screen pixels. Rendering lives in the game's
+// StarField class.
+//
+// Two modes:
+//  Simulated - every update moves each star and rerolls its x when it wraps
+//  Analytic  - updates only advance the clock. A star's position is a closed
+//              form function of its starting position, its layer and the time
+//              since the stars were scattered: y wraps modulo the screen
+//              (plus star) height, and x steps by a fixed fraction of the
+//              width on each wrap. evaluatePositions() computes every star in
+//              one batched pass, with no per-frame state or random numbers.
+//------------------------------------------------------------------------------
+class StarFieldSim
+{
+public:
+  enum SPEED_TimePerScreenWrapMs
+  {
+    SPEED_Slow   = 5000,
+    SPEED_Medium = 2500,
+    SPEED_Fast   = 1200
+  };
+
+  struct Star
+  {
+    sim::Vec3 position;
+    float scale = 1.0f;
+  };
+  static constexpr size_t MAX_NUM_PARTICLES = 256;
+  static constexpr size_t NUM_LAYERS        = 6;
+  static constexpr size_t NUM_STARS         = NUM_LAYERS * MAX_NUM_PARTICLES;
+  using ParticleLayer = std::array<Star, MAX_NUM_PARTICLES>;
+  using Layers        = std::array<ParticleLayer, NUM_LAYERS>;
+
+  struct Bounds
+  {
+    float screenWidth  = 0.0f;
+    float screenHeight = 0.0f;
+    float starWidth    = 0.0f;
+    float starHeight   = 0.0f;
+  };
+
+  enum class Mode
+  {
+    Simulated,
+    Analytic
+  };
+
+  explicit StarFieldSim(sim::Random::Seed seed);
+
+  void setMode(Mode mode) { m_mode = mode; }
+  Mode mode() const { return m_mode; }
+
+  void setBounds(
+    float screenWidth, float screenHeight, float starWidth, float starHeight);
+  void setBounds(const Bounds& bounds);
+  const Bounds& bounds() const { return m_bounds; }
+
+  // Reseeds and scatters the stars again
+  void reset(sim::Random::Seed seed);
+
+  void update(float elapsedTimeS);
+
+  // The same update on the job system: layers move in parallel, then the
+  // stars that wrapped are regenerated in order, as the random engine is
+  // shared. Returns nullptr in Analytic mode, there's nothing to run.
+  sim::JobSystem::Job* scheduleUpdate(sim::JobSystem& jobs, float elapsedTimeS);
+  void setSpeed(SPEED_TimePerScreenWrapMs speed) { m_timePerWrapMs = speed; }
+
+  // Current positions of all NUM_STARS stars, layer by layer. The scales and
+  // z are in layers(), whose positions are only kept up to date in Simulated
+  // mode.
+  void evaluatePositions(float* x, float* y) const;
+
+  const Layers& layers() const { return m_particleLayers; }
+  sim::Random& random() { return m_random; }
+
+  // Number of update() calls so far
+  uint64_t numUpdates() const { return m_numUpdates; }
+
+private:
+  void initialisePositions();
+  float randomX();
+  float layerSpeed(size_t layerIdx) const;
+  void moveLayers(float elapsedTimeS, size_t beginLayer, size_t endLayer);
+  void regenerateWrapped();
+  void evaluateLayer(size_t layerIdx, float* x, float* y) const;
+
+  Mode m_mode = Mode::Analytic;
+  Layers m_particleLayers;
+
+  // Analytic mode: the scattered positions, y from the top of the wrap range
+  // and x as a fraction of the x range, plus the time since scattering
+  using StartLayer = std::array<float, MAX_NUM_PARTICLES>;
+  std::array<StartLayer, NUM_LAYERS> m_startY = {};
+  std::array<StartLayer, NUM_LAYERS> m_startX = {};
+  double m_timeS = 0.0;
+
+  // Stars that scrolled off the bottom during the current update
+  using WrappedBits = std::array<uint64_t, (MAX_NUM_PARTICLES + 63) / 64>;
+  std::array<WrappedBits, NUM_LAYERS> m_wrapped = {};
+  sim::Random m_random;
+
+  Bounds m_bounds;
+  uint64_t m_numUpdates = 0;
+
+  SPEED_TimePerScreenWrapMs m_timePerWrapMs = SPEED_Medium;
+};
+
+//------------------------------------------------------------------------------
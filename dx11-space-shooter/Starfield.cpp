@@ -6,78 +6,30 @@
 
 #include "utils/Log.h"
 
-const float ZBOUNDMIN = 1.0f;
-const float ZBOUNDMAX = 8.5f;
-const float SCALE_MIN = 0.2f;
-const float SCALE_MAX = 0.5f;
-
-const float MILLISECS_PER_SEC = 1000.0f;
-
 using namespace DirectX;
 //------------------------------------------------------------------------------
-StarField::StarField(AppContext& context, Texture& texture)
+StarField::StarField(
+  AppContext& context, const TextureAtlas& atlas, sim::Random::Seed seed)
     : m_context(context)
-    , m_texture(texture)
-    , m_engine(m_device())
+    , m_atlas(atlas)
+    , m_sprite(atlas.sprite("star"))
+    , m_sim(seed)
 {
 }
 
 //------------------------------------------------------------------------------
 void
-StarField::initialisePositions()
+StarField::update(DX::StepTimer const& timer)
 {
-  TRACE
-  std::uniform_real_distribution<float> yRand(
-    static_cast<float>(-m_texture.height), m_context.screenHeight);
-
-  std::uniform_real_distribution<float> zRand(ZBOUNDMIN, ZBOUNDMAX);
-  std::uniform_real_distribution<float> sizeRand(SCALE_MIN, SCALE_MAX);
-
-  for (auto& l : m_particleLayers)
-  {
-    for (auto& p : l)
-    {
-      p.position.x = m_xRand(m_engine);
-      p.position.y = yRand(m_engine);
-      p.position.z = zRand(m_engine);
-
-      float scale = sizeRand(m_engine);
-      p.scale.x   = scale;
-      p.scale.y   = scale;
-      p.scale.z   = scale;
-      p.scale.w   = scale;
-    }
-  }
+  m_sim.update(static_cast<float>(timer.GetElapsedSeconds()));
 }
 
 //------------------------------------------------------------------------------
-void
-StarField::update(DX::StepTimer const& timer)
+sim::JobSystem::Job*
+StarField::scheduleUpdate(DX::StepTimer const& timer, sim::JobSystem& jobs)
 {
-  TRACE
-  float speed = m_context.screenHeight / (m_timePerWrapMs / MILLISECS_PER_SEC);
-  const float layerSpeedOffset = speed / (NUM_LAYERS + 2);
-
-  int layerCount = 0;
-  for (auto& l : m_particleLayers)
-  {
-    speed -= layerSpeedOffset;
-
-    for (auto& p : l)
-    {
-      // Particle Motion
-      p.position.y += static_cast<float>(speed * timer.GetElapsedSeconds());
-
-      // Regenerate old particles
-      if (p.position.y > m_context.screenHeight)
-      {
-        p.position.y = static_cast<float>(-m_texture.height)
-                       + (p.position.y - m_context.screenHeight);
-        p.position.x = m_xRand(m_engine);
-      }
-    }
-    ++layerCount;
-  }
+  return m_sim.scheduleUpdate(
+    jobs, static_cast<float>(timer.GetElapsedSeconds()));
 }
 
 //------------------------------------------------------------------------------
@@ -85,35 +37,35 @@ void
 StarField::render(DirectX::SpriteBatch& batch)
 {
   TRACE
-  XMVECTOR origin = {0.0f, 0.0f, 0.0f};
-  for (auto& l : m_particleLayers)
+  m_sim.evaluatePositions(m_x.data(), m_y.data());
+
+  size_t starIdx = 0;
+  for (auto& l : m_sim.layers())
   {
     for (auto& p : l)
     {
-      batch.Draw(
-        m_texture.texture.Get(),
-        XMLoadFloat3(&p.position),
-        nullptr,
-        Colors::White,
-        0.f,
-        origin,
-        XMLoadFloat4(&p.scale),
-        SpriteEffects_None,
-        0.f);
+      m_scale[starIdx++] = p.scale;
     }
   }
+
+  SpriteQuads quads;
+  quads.x     = m_x.data();
+  quads.y     = m_y.data();
+  quads.scale = m_scale.data();
+  quads.count = StarFieldSim::NUM_STARS;
+  batch.DrawQuads(m_atlas.texture(), quads, &m_sprite.rect);
 }
 
 //------------------------------------------------------------------------------
 void
 StarField::setWindowSize(float screenWidth, float screenHeight)
 {
-  UNREFERENCED_PARAMETER(screenHeight);
-
   TRACE
-  m_xRand = std::uniform_real_distribution<float>(
-    static_cast<float>(-m_texture.width), screenWidth);
-  initialisePositions();
+  m_sim.setBounds(
+    screenWidth,
+    screenHeight,
+    static_cast<float>(m_sprite.width),
+    static_cast<float>(m_sprite.height));
 }
 
 //------------------------------------------------------------------------------
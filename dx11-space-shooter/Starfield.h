@@ -1,7 +1,8 @@
 #pragma once
 #include "pch.h"
+#include "Simulation/StarFieldSim.h"
+#include "TextureAtlas.h"
 
-struct Texture;
 struct AppContext;
 
 namespace DX
@@ -13,42 +14,29 @@ class StepTimer;
 class StarField
 {
 public:
-  StarField(AppContext& context, Texture& texture);
+  StarField(
+    AppContext& context, const TextureAtlas& atlas, sim::Random::Seed seed);
   void update(DX::StepTimer const& timer);
+  sim::JobSystem::Job*
+  scheduleUpdate(DX::StepTimer const& timer, sim::JobSystem& jobs);
   void render(DirectX::SpriteBatch& batch);
   void setWindowSize(float screenWidth, float screenHeight);
 
-  enum SPEED_TimePerScreenWrapMs
-  {
-    SPEED_Slow   = 5000,
-    SPEED_Medium = 2500,
-    SPEED_Fast   = 1200
-  };
-  void setSpeed(SPEED_TimePerScreenWrapMs speed) { m_timePerWrapMs = speed; }
+  using SPEED_TimePerScreenWrapMs = StarFieldSim::SPEED_TimePerScreenWrapMs;
+  void setSpeed(SPEED_TimePerScreenWrapMs speed) { m_sim.setSpeed(speed); }
 
-private:
-  AppContext& m_context;
-  Texture& m_texture;
-
-  struct StarParticle
-  {
-    DirectX::XMFLOAT3 position;
-    DirectX::XMFLOAT4 scale;
-  };
-  static const size_t MAX_NUM_PARTICLES = 256;
-  static const size_t NUM_LAYERS        = 6;
-  using ParticleLayer = std::array<StarParticle, MAX_NUM_PARTICLES>;
-  std::array<ParticleLayer, NUM_LAYERS> m_particleLayers;
-
-  // Random Generators
-  std::random_device m_device;
-  std::default_random_engine m_engine;
-  std::uniform_real_distribution<float> m_xRand;
-
-  SPEED_TimePerScreenWrapMs m_timePerWrapMs = SPEED_Medium;
+  StarFieldSim& sim() { return m_sim; }
 
 private:
-  void initialisePositions();
+  AppContext& m_context;
+  const TextureAtlas& m_atlas;
+  AtlasSprite m_sprite;
+  StarFieldSim m_sim;
+
+  // Quads for the current frame
+  std::array<float, StarFieldSim::NUM_STARS> m_x     = {};
+  std::array<float, StarFieldSim::NUM_STARS> m_y     = {};
+  std::array<float, StarFieldSim::NUM_STARS> m_scale = {};
 };
 
 //------------------------------------------------------------------------------
@@ -7,10 +7,12 @@
 #include <exception>
 #include <stdint.h>
 
+#include "Simulation/SimClock.h"
+
 namespace DX
 {
 // Helper class for animation and simulation timing.
-class StepTimer
+class StepTimer : public sim::IClock
 {
 public:
   StepTimer()
@@ -40,7 +42,10 @@ public:
 
   // Get elapsed time since the previous Update call.
   uint64_t GetElapsedTicks() const { return m_elapsedTicks; }
-  double GetElapsedSeconds() const { return TicksToSeconds(m_elapsedTicks); }
+  double GetElapsedSeconds() const override
+  {
+    return TicksToSeconds(m_elapsedTicks);
+  }
 
   // This time will be smaller than GetElapsedSeconds()
   // as it represents only a partial tick (until now)
@@ -69,11 +74,26 @@ public:
 
   // Get total time since the start of the program.
   uint64_t GetTotalTicks() const { return m_totalTicks; }
-  double GetTotalSeconds() const { return TicksToSeconds(m_totalTicks); }
+  double GetTotalSeconds() const override
+  {
+    return TicksToSeconds(m_totalTicks);
+  }
   void PauseTotalTimer(bool pause) { m_isTotalTicksPaused = pause; }
   bool IsTotalTimerPaused() const { return m_isTotalTicksPaused; }
   void ResetTotalTimer() { m_totalTicks = 0; }
 
+  // How far the clock is between the last fixed update and the next one
+  // [0, 1), used to interpolate rendering between the last two updates.
+  // Always 1 in variable timestep mode, where rendering follows the update.
+  double GetInterpolationAlpha() const
+  {
+    if (!m_isFixedTimeStep)
+    {
+      return 1.0;
+    }
+    return static_cast<double>(m_leftOverTicks) / m_targetElapsedTicks;
+  }
+
   // Get total number of updates since start of the program.
   uint32_t GetFrameCount() const { return m_frameCount; }
 
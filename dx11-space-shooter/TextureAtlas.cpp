@@ -0,0 +1,145 @@
+#include "pch.h"
+#include "TextureAtlas.h"
+#include "json11/json11.hpp"
+
+#include "utils/Log.h"
+
+//------------------------------------------------------------------------------
+static const std::string SPRITES_KEY      = "sprites";
+static const std::string FONTS_KEY        = "fonts";
+static const std::string GLYPHS_KEY       = "glyphs";
+static const std::string LINE_SPACING_KEY = "lineSpacing";
+static const std::string DEFAULT_CHAR_KEY = "defaultCharacter";
+
+//------------------------------------------------------------------------------
+void
+TextureAtlas::load(
+  ID3D11Device* d3dDevice,
+  const wchar_t* textureFileName,
+  const std::string& descriptionFileName)
+{
+  TRACE
+  HRESULT hr = DirectX::CreateDDSTextureFromFile(
+    d3dDevice, textureFileName, nullptr, m_texture.ReleaseAndGetAddressOf());
+  if (FAILED(hr))
+  {
+    LOG_ERROR("Couldn't load texture from file: %ws", textureFileName);
+    throw std::exception("TextureAtlas");
+  }
+
+  std::ifstream fileIn(descriptionFileName);
+  if (!fileIn.is_open())
+  {
+    LOG_ERROR("Couldn't load atlas from file: %s", descriptionFileName.c_str());
+    throw std::exception("TextureAtlas");
+  }
+
+  std::stringstream ss;
+  ss << fileIn.rdbuf();
+
+  std::string err;
+  json11::Json json = json11::Json::parse(ss.str(), err);
+  if (json.is_null())
+  {
+    LOG_ERROR("Couldn't parse atlas: %s", err.c_str());
+    throw std::exception("TextureAtlas");
+  }
+
+  m_sprites.clear();
+  for (const auto& [name, rect] : json[SPRITES_KEY].object_items())
+  {
+    AtlasSprite sprite;
+    sprite.width       = rect[2].int_value();
+    sprite.height      = rect[3].int_value();
+    sprite.rect.left   = rect[0].int_value();
+    sprite.rect.top    = rect[1].int_value();
+    sprite.rect.right  = sprite.rect.left + sprite.width;
+    sprite.rect.bottom = sprite.rect.top + sprite.height;
+    sprite.origin      = {sprite.width / 2.0f, sprite.height / 2.0f};
+    m_sprites[name]    = sprite;
+  }
+
+  m_fonts.clear();
+  for (const auto& [name, font] : json[FONTS_KEY].object_items())
+  {
+    Font& f = m_fonts[name];
+
+    f.lineSpacing = static_cast<float>(font[LINE_SPACING_KEY].number_value());
+    f.defaultCharacter
+      = static_cast<wchar_t>(font[DEFAULT_CHAR_KEY].int_value());
+
+    // [character, left, top, right, bottom, xOffset, yOffset, xAdvance]
+    for (const auto& g : font[GLYPHS_KEY].array_items())
+    {
+      DirectX::SpriteFont::Glyph glyph;
+      glyph.Character      = static_cast<uint32_t>(g[0].int_value());
+      glyph.Subrect.left   = g[1].int_value();
+      glyph.Subrect.top    = g[2].int_value();
+      glyph.Subrect.right  = g[3].int_value();
+      glyph.Subrect.bottom = g[4].int_value();
+      glyph.XOffset        = static_cast<float>(g[5].number_value());
+      glyph.YOffset        = static_cast<float>(g[6].number_value());
+      glyph.XAdvance       = static_cast<float>(g[7].number_value());
+      f.glyphs.push_back(glyph);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+TextureAtlas::reset()
+{
+  m_texture.Reset();
+}
+
+//------------------------------------------------------------------------------
+const AtlasSprite&
+TextureAtlas::sprite(const std::string& name) const
+{
+  auto it = m_sprites.find(name);
+  if (it == m_sprites.end())
+  {
+    LOG_ERROR("Sprite not in atlas: %s", name.c_str());
+    throw std::exception("TextureAtlas");
+  }
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+render::SpriteRef
+TextureAtlas::spriteRef(const std::string& name) const
+{
+  const AtlasSprite& atlasSprite = sprite(name);
+  render::SpriteRef ref;
+  ref.texture = render::TextureId::Atlas;
+  ref.left    = atlasSprite.rect.left;
+  ref.top     = atlasSprite.rect.top;
+  ref.right   = atlasSprite.rect.right;
+  ref.bottom  = atlasSprite.rect.bottom;
+  ref.originX = atlasSprite.origin.x;
+  ref.originY = atlasSprite.origin.y;
+  return ref;
+}
+
+//------------------------------------------------------------------------------
+std::unique_ptr<DirectX::SpriteFont>
+TextureAtlas::createFont(const std::string& name) const
+{
+  auto it = m_fonts.find(name);
+  if (it == m_fonts.end())
+  {
+    LOG_ERROR("Font not in atlas: %s", name.c_str());
+    throw std::exception("TextureAtlas");
+  }
+
+  const Font& f = it->second;
+  auto font     = std::make_unique<DirectX::SpriteFont>(
+    m_texture.Get(), f.glyphs.data(), f.glyphs.size(), f.lineSpacing);
+  if (f.defaultCharacter)
+  {
+    font->SetDefaultCharacter(f.defaultCharacter);
+  }
+  return font;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+#pragma once
+#include "pch.h"
+#include "Render/CommandList.h"    // SpriteRef
+
+//------------------------------------------------------------------------------
+// Gameplay sprites and font glyphs packed into one texture by the atlas_packer
+// tool, so SpriteBatch can draw them without switching texture.
+//------------------------------------------------------------------------------
+struct AtlasSprite
+{
+  RECT rect  = {};
+  int width  = 0;
+  int height = 0;
+  DirectX::XMFLOAT2 origin;    // Centre, relative to the rect
+};
+
+//------------------------------------------------------------------------------
+class TextureAtlas
+{
+public:
+  void load(
+    ID3D11Device* d3dDevice,
+    const wchar_t* textureFileName,
+    const std::string& descriptionFileName);
+  void reset();
+
+  ID3D11ShaderResourceView* texture() const { return m_texture.Get(); }
+  const AtlasSprite& sprite(const std::string& name) const;
+  render::SpriteRef spriteRef(const std::string& name) const;
+  std::unique_ptr<DirectX::SpriteFont>
+  createFont(const std::string& name) const;
+
+private:
+  struct Font
+  {
+    std::vector<DirectX::SpriteFont::Glyph> glyphs;
+    float lineSpacing        = 0.0f;
+    wchar_t defaultCharacter = 0;
+  };
+
+  Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_texture;
+  std::map<std::string, AtlasSprite> m_sprites;
+  std::map<std::string, Font> m_fonts;
+};
+
+//------------------------------------------------------------------------------
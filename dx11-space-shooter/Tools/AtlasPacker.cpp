@@ -0,0 +1,620 @@
+//------------------------------------------------------------------------------
+// Texture atlas packer
+//
+// Packs sprite textures (.dds) and the textures of sprite fonts (.spritefont)
+// into one texture, so everything drawn from it can share SpriteBatch
+// batches. Writes the atlas as an uncompressed RGBA .dds, plus a .json
+// description the game's TextureAtlas loads: the rectangle of each sprite, and
+// each font's glyph table with its rectangles moved to where the font landed.
+//
+// Inputs are decoded from BC2/BC3 (as texconv and MakeSpriteFont write them)
+// or RGBA, so sprites and fonts that were compressed differently can share the
+// atlas without being compressed again. Alpha is kept as it is: the inputs are
+// already premultiplied.
+//
+// usage: atlas_packer outAtlas.dds outAtlas.json name=input ...
+//------------------------------------------------------------------------------
+#include "json11/json11.hpp"
+
+#define LOGGER_PROFILER_IMPLEMENTATION
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+constexpr int PADDING        = 2;    // Transparent texels between entries
+constexpr int MAX_SIZE       = 4096;
+constexpr uint32_t DDS_MAGIC = 0x20534444;    // "DDS "
+
+// The subset of DXGI_FORMAT the packer reads
+constexpr uint32_t DXGI_FORMAT_R8G8B8A8_UNORM = 28;
+constexpr uint32_t DXGI_FORMAT_BC2_UNORM      = 74;
+constexpr uint32_t DXGI_FORMAT_BC3_UNORM      = 77;
+
+//------------------------------------------------------------------------------
+struct Image
+{
+  int width  = 0;
+  int height = 0;
+  std::vector<uint32_t> texels;    // RGBA, R in the low byte
+};
+
+struct Glyph
+{
+  uint32_t character;
+  int32_t left, top, right, bottom;
+  float xOffset, yOffset, xAdvance;
+};
+
+struct Entry
+{
+  std::string name;
+  Image image;
+  int x = 0;
+  int y = 0;
+
+  bool isFont = false;
+  std::vector<Glyph> glyphs;
+  float lineSpacing         = 0.0f;
+  uint32_t defaultCharacter = 0;
+};
+
+//------------------------------------------------------------------------------
+class Reader
+{
+public:
+  explicit Reader(std::vector<uint8_t> bytes)
+      : m_bytes(std::move(bytes))
+  {
+  }
+
+  template <typename T>
+  T read()
+  {
+    T value{};
+    if (m_pos + sizeof(T) <= m_bytes.size())
+    {
+      std::memcpy(&value, &m_bytes[m_pos], sizeof(T));
+    }
+    m_pos += sizeof(T);
+    return value;
+  }
+
+  const uint8_t* take(size_t numBytes)
+  {
+    const size_t start = m_pos;
+    m_pos += numBytes;
+    return (m_pos <= m_bytes.size()) ? &m_bytes[start] : nullptr;
+  }
+
+  void seek(size_t pos) { m_pos = pos; }
+  bool ok() const { return m_pos <= m_bytes.size(); }
+
+private:
+  std::vector<uint8_t> m_bytes;
+  size_t m_pos = 0;
+};
+
+//------------------------------------------------------------------------------
+static bool
+readFile(const std::string& filename, std::vector<uint8_t>& bytes)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open())
+  {
+    return false;
+  }
+  bytes.assign(
+    std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t
+rgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+  return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+//------------------------------------------------------------------------------
+// BC2 and BC3 colour blocks always use the four colour mode
+static void
+decodeColorBlock(const uint8_t* block, uint32_t colors[16])
+{
+  uint16_t c0, c1;
+  uint32_t indices;
+  std::memcpy(&c0, block, 2);
+  std::memcpy(&c1, block + 2, 2);
+  std::memcpy(&indices, block + 4, 4);
+
+  auto expand = [](uint16_t c, uint32_t rgb[3]) {
+    const uint32_t r = (c >> 11) & 31;
+    const uint32_t g = (c >> 5) & 63;
+    const uint32_t b = c & 31;
+    rgb[0]           = (r << 3) | (r >> 2);
+    rgb[1]           = (g << 2) | (g >> 4);
+    rgb[2]           = (b << 3) | (b >> 2);
+  };
+
+  uint32_t palette[4][3];
+  expand(c0, palette[0]);
+  expand(c1, palette[1]);
+  for (int ch = 0; ch < 3; ++ch)
+  {
+    palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+    palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+  }
+
+  for (int i = 0; i < 16; ++i)
+  {
+    const uint32_t* c = palette[(indices >> (2 * i)) & 3];
+    colors[i]         = rgba(c[0], c[1], c[2], 0);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+decodeExplicitAlpha(const uint8_t* block, uint32_t alphas[16])
+{
+  for (int i = 0; i < 16; ++i)
+  {
+    const uint32_t a = (block[i / 2] >> (4 * (i % 2))) & 15;
+    alphas[i]        = a * 17;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void
+decodeInterpolatedAlpha(const uint8_t* block, uint32_t alphas[16])
+{
+  const uint32_t a0 = block[0];
+  const uint32_t a1 = block[1];
+
+  uint32_t palette[8] = {a0, a1};
+  if (a0 > a1)
+  {
+    for (uint32_t i = 1; i < 7; ++i)
+    {
+      palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    }
+  }
+  else
+  {
+    for (uint32_t i = 1; i < 5; ++i)
+    {
+      palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+
+  uint64_t indices = 0;
+  std::memcpy(&indices, block + 2, 6);
+  for (int i = 0; i < 16; ++i)
+  {
+    alphas[i] = palette[(indices >> (3 * i)) & 7];
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool
+decode(
+  uint32_t format,
+  int width,
+  int height,
+  const uint8_t* data,
+  size_t stride,
+  Image& image)
+{
+  image.width  = width;
+  image.height = height;
+  image.texels.assign(size_t(width) * height, 0);
+
+  if (format == DXGI_FORMAT_R8G8B8A8_UNORM)
+  {
+    for (int y = 0; y < height; ++y)
+    {
+      std::memcpy(
+        &image.texels[size_t(y) * width], data + y * stride, width * 4);
+    }
+    return true;
+  }
+
+  if (format != DXGI_FORMAT_BC2_UNORM && format != DXGI_FORMAT_BC3_UNORM)
+  {
+    return false;
+  }
+
+  const int blocksWide = (width + 3) / 4;
+  const int blocksHigh = (height + 3) / 4;
+  for (int by = 0; by < blocksHigh; ++by)
+  {
+    for (int bx = 0; bx < blocksWide; ++bx)
+    {
+      const uint8_t* block = data + by * stride + bx * 16;
+
+      uint32_t colors[16];
+      uint32_t alphas[16];
+      decodeColorBlock(block + 8, colors);
+      if (format == DXGI_FORMAT_BC2_UNORM)
+      {
+        decodeExplicitAlpha(block, alphas);
+      }
+      else
+      {
+        decodeInterpolatedAlpha(block, alphas);
+      }
+
+      for (int i = 0; i < 16; ++i)
+      {
+        const int x = bx * 4 + i % 4;
+        const int y = by * 4 + i / 4;
+        if (x < width && y < height)
+        {
+          image.texels[size_t(y) * width + x] = colors[i] | (alphas[i] << 24);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t
+fourCC(const char* code)
+{
+  return uint32_t(code[0]) | (uint32_t(code[1]) << 8)
+         | (uint32_t(code[2]) << 16) | (uint32_t(code[3]) << 24);
+}
+
+//------------------------------------------------------------------------------
+// Top mip of a 2D .dds
+static bool
+loadDDS(const std::string& filename, Image& image)
+{
+  std::vector<uint8_t> bytes;
+  if (!readFile(filename, bytes))
+  {
+    LOG_ERROR("Couldn't read %s", filename.c_str());
+    return false;
+  }
+
+  Reader reader(std::move(bytes));
+  if (reader.read<uint32_t>() != DDS_MAGIC)
+  {
+    LOG_ERROR("%s is not a .dds file", filename.c_str());
+    return false;
+  }
+
+  // DDS_HEADER: size, flags, height, width, ... pixel format at byte 72
+  reader.seek(4 + 8);
+  const int height = reader.read<int32_t>();
+  const int width  = reader.read<int32_t>();
+  reader.seek(4 + 72 + 4);
+  const uint32_t pfFlags  = reader.read<uint32_t>();
+  const uint32_t pfFourCC = reader.read<uint32_t>();
+  const uint32_t bitCount = reader.read<uint32_t>();
+  const uint32_t redMask  = reader.read<uint32_t>();
+  reader.seek(4 + 124);
+
+  static const uint32_t DDPF_FOURCC = 0x4;
+  static const uint32_t DDPF_RGB    = 0x40;
+
+  uint32_t format = 0;
+  if ((pfFlags & DDPF_FOURCC) && pfFourCC == fourCC("DX10"))
+  {
+    format = reader.read<uint32_t>();
+    reader.seek(4 + 124 + 20);
+  }
+  else if (pfFlags & DDPF_FOURCC)
+  {
+    if (pfFourCC == fourCC("DXT2") || pfFourCC == fourCC("DXT3"))
+    {
+      format = DXGI_FORMAT_BC2_UNORM;
+    }
+    else if (pfFourCC == fourCC("DXT4") || pfFourCC == fourCC("DXT5"))
+    {
+      format = DXGI_FORMAT_BC3_UNORM;
+    }
+  }
+  else if ((pfFlags & DDPF_RGB) && bitCount == 32 && redMask == 0xff)
+  {
+    format = DXGI_FORMAT_R8G8B8A8_UNORM;
+  }
+
+  const size_t stride = (format == DXGI_FORMAT_R8G8B8A8_UNORM)
+                          ? size_t(width) * 4
+                          : size_t((width + 3) / 4) * 16;
+  const size_t rows = (format == DXGI_FORMAT_R8G8B8A8_UNORM)
+                        ? size_t(height)
+                        : size_t((height + 3) / 4);
+  const uint8_t* data = reader.take(stride * rows);
+  if (!data || !decode(format, width, height, data, stride, image))
+  {
+    LOG_ERROR("%s: unsupported or truncated .dds", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// MakeSpriteFont output, as read by DirectX::SpriteFont
+static bool
+loadSpriteFont(const std::string& filename, Entry& entry)
+{
+  std::vector<uint8_t> bytes;
+  if (!readFile(filename, bytes))
+  {
+    LOG_ERROR("Couldn't read %s", filename.c_str());
+    return false;
+  }
+
+  Reader reader(std::move(bytes));
+  for (const char* magic = "DXTKfont"; *magic; ++magic)
+  {
+    if (reader.read<char>() != *magic)
+    {
+      LOG_ERROR("%s is not a .spritefont file", filename.c_str());
+      return false;
+    }
+  }
+
+  const uint32_t numGlyphs = reader.read<uint32_t>();
+  entry.glyphs.resize(numGlyphs);
+  for (auto& glyph : entry.glyphs)
+  {
+    glyph = reader.read<Glyph>();
+  }
+  entry.lineSpacing      = reader.read<float>();
+  entry.defaultCharacter = reader.read<uint32_t>();
+
+  const int width       = reader.read<uint32_t>();
+  const int height      = reader.read<uint32_t>();
+  const uint32_t format = reader.read<uint32_t>();
+  const uint32_t stride = reader.read<uint32_t>();
+  const uint32_t rows   = reader.read<uint32_t>();
+  const uint8_t* data   = reader.take(size_t(stride) * rows);
+  entry.isFont          = true;
+  if (!reader.ok() || !data
+      || !decode(format, width, height, data, stride, entry.image))
+  {
+    LOG_ERROR("%s: unsupported or truncated .spritefont", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Shelves of entries from tallest to shortest, in an atlas of the given width.
+// Returns the height used.
+static int
+pack(std::vector<Entry*>& entries, int width)
+{
+  int shelfY      = 0;
+  int shelfHeight = 0;
+  int x           = 0;
+  for (Entry* e : entries)
+  {
+    const int w = e->image.width + PADDING;
+    const int h = e->image.height + PADDING;
+    if (x + w > width)
+    {
+      shelfY += shelfHeight;
+      shelfHeight = 0;
+      x           = 0;
+    }
+    e->x = x;
+    e->y = shelfY;
+    x += w;
+    shelfHeight = std::max(shelfHeight, h);
+  }
+  return shelfY + shelfHeight;
+}
+
+//------------------------------------------------------------------------------
+// Tries each power of two width that fits the widest entry and keeps the one
+// with the least area
+static bool
+packSmallest(std::vector<Entry>& entries, int& atlasWidth, int& atlasHeight)
+{
+  std::vector<Entry*> order;
+  int widest = 0;
+  for (auto& e : entries)
+  {
+    order.push_back(&e);
+    widest = std::max(widest, e.image.width + PADDING);
+  }
+  std::stable_sort(order.begin(), order.end(), [](Entry* a, Entry* b) {
+    return a->image.height > b->image.height;
+  });
+
+  int bestWidth = 0;
+  int bestArea  = 0;
+  for (int width = 4; width <= MAX_SIZE; width *= 2)
+  {
+    if (width < widest)
+    {
+      continue;
+    }
+    const int height = (pack(order, width) + 3) & ~3;
+    if (height <= MAX_SIZE && (!bestWidth || width * height < bestArea))
+    {
+      bestWidth = width;
+      bestArea  = width * height;
+    }
+  }
+  if (!bestWidth)
+  {
+    return false;
+  }
+
+  atlasWidth  = bestWidth;
+  atlasHeight = (pack(order, bestWidth) + 3) & ~3;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool
+writeDDS(const std::string& filename, const Image& image)
+{
+  // Magic then DDS_HEADER, with a legacy pixel format the loader reads as
+  // DXGI_FORMAT_R8G8B8A8_UNORM
+  uint32_t header[32] = {};
+  header[0]           = DDS_MAGIC;
+  header[1]           = 124;                              // Header size
+  header[2]           = 0x1 | 0x2 | 0x4 | 0x8 | 0x1000;    // Valid fields
+  header[3]           = image.height;
+  header[4]           = image.width;
+  header[5]           = image.width * 4;    // Pitch
+  header[7]           = 1;                  // Mips
+  header[19]          = 32;                 // Pixel format size
+  header[20]          = 0x40 | 0x1;         // DDPF_RGB | DDPF_ALPHAPIXELS
+  header[22]          = 32;                 // Bits per pixel
+  header[23]          = 0x000000ff;
+  header[24]          = 0x0000ff00;
+  header[25]          = 0x00ff0000;
+  header[26]          = 0xff000000;
+  header[27]          = 0x1000;    // DDSCAPS_TEXTURE
+
+  std::ofstream file(filename, std::ios::binary);
+  if (!file.is_open())
+  {
+    LOG_ERROR("Couldn't write %s", filename.c_str());
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(header), sizeof(header));
+  file.write(
+    reinterpret_cast<const char*>(image.texels.data()),
+    image.texels.size() * sizeof(uint32_t));
+  return file.good();
+}
+
+//------------------------------------------------------------------------------
+static json11::Json
+describe(const std::vector<Entry>& entries, const Image& atlas)
+{
+  json11::Json::object sprites;
+  json11::Json::object fonts;
+  for (const auto& e : entries)
+  {
+    if (!e.isFont)
+    {
+      sprites[e.name] = json11::Json::array{
+        e.x, e.y, e.image.width, e.image.height};
+      continue;
+    }
+
+    json11::Json::array glyphs;
+    for (const auto& g : e.glyphs)
+    {
+      glyphs.push_back(json11::Json::array{
+        static_cast<int>(g.character),
+        g.left + e.x,
+        g.top + e.y,
+        g.right + e.x,
+        g.bottom + e.y,
+        g.xOffset,
+        g.yOffset,
+        g.xAdvance});
+    }
+    fonts[e.name] = json11::Json::object{
+      {"lineSpacing", e.lineSpacing},
+      {"defaultCharacter", static_cast<int>(e.defaultCharacter)},
+      {"glyphs", glyphs}};
+  }
+
+  return json11::Json::object{
+    {"width", atlas.width},
+    {"height", atlas.height},
+    {"sprites", sprites},
+    {"fonts", fonts}};
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, char* argv[])
+{
+  if (argc < 4)
+  {
+    std::fprintf(
+      stderr,
+      "usage: atlas_packer outAtlas.dds outAtlas.json name=input ...\n"
+      "  inputs are .dds sprites (BC2, BC3 or RGBA) or .spritefont fonts\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Entry> entries;
+  for (int i = 3; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const size_t equals   = arg.find('=');
+    if (equals == std::string::npos || equals == 0)
+    {
+      LOG_ERROR("Expected name=input, got %s", arg.c_str());
+      return EXIT_FAILURE;
+    }
+
+    Entry entry;
+    entry.name                 = arg.substr(0, equals);
+    const std::string filename = arg.substr(equals + 1);
+    const bool isFont
+      = filename.size() > 11
+        && filename.compare(filename.size() - 11, 11, ".spritefont") == 0;
+    if (!(isFont ? loadSpriteFont(filename, entry)
+                 : loadDDS(filename, entry.image)))
+    {
+      return EXIT_FAILURE;
+    }
+    entries.push_back(std::move(entry));
+  }
+
+  Image atlas;
+  if (!packSmallest(entries, atlas.width, atlas.height))
+  {
+    LOG_ERROR("Inputs don't fit in a %dx%d atlas", MAX_SIZE, MAX_SIZE);
+    return EXIT_FAILURE;
+  }
+
+  atlas.texels.assign(size_t(atlas.width) * atlas.height, 0);
+  for (const auto& e : entries)
+  {
+    for (int y = 0; y < e.image.height; ++y)
+    {
+      std::copy_n(
+        &e.image.texels[size_t(y) * e.image.width],
+        e.image.width,
+        &atlas.texels[size_t(e.y + y) * atlas.width + e.x]);
+    }
+  }
+
+  if (!writeDDS(argv[1], atlas))
+  {
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream description(argv[2]);
+  description << describe(entries, atlas).dump() << "\n";
+  if (!description.good())
+  {
+    LOG_ERROR("Couldn't write %s", argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  std::printf(
+    "%s: %dx%d, %zu entries\n",
+    argv[1],
+    atlas.width,
+    atlas.height,
+    entries.size());
+  return EXIT_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
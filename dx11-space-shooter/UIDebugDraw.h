@@ -2,6 +2,7 @@
 
 #include "pch.h"
 #include "DebugDraw.h"
+#include "utils/InlineString.h"
 
 namespace ui
 {
@@ -36,7 +37,7 @@ void drawBox(
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-struct Text
+struct TextStyle
 {
   DirectX::SpriteFont* font = nullptr;    // TODO(James): Create/Set via Factory
 
@@ -46,14 +47,13 @@ struct Text
   DirectX::SimpleMath::Vector2 scale = DirectX::SimpleMath::Vector2(1.f, 1.f);
   float layer                        = Layer::L5_Default;
   float rotation                     = 0.0f;
-  std::wstring text;
 
-  void draw(DirectX::SpriteBatch& spriteBatch)
+  void drawString(DirectX::SpriteBatch& spriteBatch, const wchar_t* str) const
   {
     ASSERT(font);
     font->DrawString(
       &spriteBatch,
-      text.c_str(),
+      str,
       position,
       color,
       rotation,
@@ -62,8 +62,64 @@ struct Text
       DirectX::SpriteEffects_None,
       layer);
   }
+};    // struct TextStyle
+
+//------------------------------------------------------------------------------
+struct Text : TextStyle
+{
+  std::wstring text;
+
+  void draw(DirectX::SpriteBatch& spriteBatch) const
+  {
+    drawString(spriteBatch, text.c_str());
+  }
 };    // struct Text
 
+//------------------------------------------------------------------------------
+// Retained text, for labels updated every frame or on every change.
+// Formats with a compiled format string into an inline buffer, and measures
+// only when the text (or font) changes. SpriteFont caches the glyph layout of
+// each string, so unchanged text isn't laid out again either. No heap traffic.
+//
+//  static const auto FORMAT = fmt::compile<int>(FMT_STRING(L"Score: {}"));
+//  if (uiScore.format(FORMAT, score)) { uiScore.origin = uiScore.size() ... }
+//------------------------------------------------------------------------------
+template <size_t Capacity = 64>
+struct FormattedText : TextStyle
+{
+  // Each returns whether the text changed. Set the font first.
+  template <typename CompiledFormat, typename... Args>
+  bool format(const CompiledFormat& compiledFormat, const Args&... args)
+  {
+    return remeasure(m_text.format(compiledFormat, args...));
+  }
+  bool setText(const wchar_t* str) { return remeasure(m_text.assign(str)); }
+
+  const wchar_t* text() const { return m_text.c_str(); }
+  const DirectX::SimpleMath::Vector2& size() const { return m_size; }
+
+  void draw(DirectX::SpriteBatch& spriteBatch) const
+  {
+    drawString(spriteBatch, m_text.c_str());
+  }
+
+private:
+  bool remeasure(bool isTextChanged)
+  {
+    ASSERT(font);
+    if (isTextChanged || font != m_measuredFont)
+    {
+      m_size         = font->MeasureString(m_text.c_str());
+      m_measuredFont = font;
+    }
+    return isTextChanged;
+  }
+
+  strUtils::InlineWString<Capacity> m_text;
+  DirectX::SimpleMath::Vector2 m_size;
+  const DirectX::SpriteFont* m_measuredFont = nullptr;
+};    // struct FormattedText
+
 //------------------------------------------------------------------------------
 struct Button
 {
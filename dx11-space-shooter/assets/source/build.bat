@@ -22,4 +22,5 @@ cd ..
 %SRC_DIR%\MakeSpriteFont.exe "Verdana" verdana8.spritefont /FontSize:8
 %SRC_DIR%\MakeSpriteFont.exe "Courier New" mono32.spritefont /FontSize:32
 %SRC_DIR%\MakeSpriteFont.exe "Courier New" mono16.spritefont /FontSize:16
-%SRC_DIR%\MakeSpriteFont.exe "Courier New" mono8.spritefont /FontSize:8
\ No newline at end of file
+%SRC_DIR%\MakeSpriteFont.exe "Courier New" mono8.spritefont /FontSize:8
+%SRC_DIR%\atlas_packer.exe atlas.dds atlas.json star=star.dds explosion=explosion.dds verdana8=verdana8.spritefont verdana16=verdana16.spritefont verdana32=verdana32.spritefont mono8=mono8.spritefont mono16=mono16.spritefont mono32=mono32.spritefont
\ No newline at end of file
@@ -19,7 +19,6 @@
  * THE SOFTWARE.
  */
 
-#include "pch.h"
 #include "json11.hpp"
 #include <cassert>
 #include <cmath>
@@ -69,6 +69,8 @@
 #include "fmt/format.h"
 #include <crtdbg.h>
 
+#include "utils/StringUtils.h"
+
 #define ASSERT _ASSERTE
 
 namespace DX
@@ -104,38 +106,3 @@ ThrowIfFailed(HRESULT hr)
 }
 
 }    // namespace DX
-
-namespace strUtils
-{
-static std::string
-wstringToUtf8(const std::wstring& str)
-{
-  std::string outStr(str.length(), 0);
-  WideCharToMultiByte(
-    CP_UTF8,
-    0,
-    str.data(),
-    static_cast<int>(str.length()),
-    outStr.data(),
-    static_cast<int>(outStr.length()),
-    NULL,
-    NULL);
-  return outStr;
-}
-
-static std::wstring
-utf8ToWstring(const char* str)
-{
-  const size_t len = strlen(str);
-  std::wstring outStr(len, 0);
-  MultiByteToWideChar(
-    CP_UTF8,
-    0,
-    str,
-    static_cast<int>(len),
-    outStr.data(),
-    static_cast<int>(outStr.length()));
-  return outStr;
-}
-
-}    // namespace strUtils
@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+// Global heap allocation counter
+//
+// Counts every allocation made through operator new (including the standard
+// containers), so a steady-state frame can be checked to allocate nothing.
+// Thread-safe.
+//
+// Usage: (in one cpp file of the executable only, to replace operator new)
+//
+//  #define ALLOCATION_COUNTER_IMPLEMENTATION
+//  #include "utils/AllocationCounter.h"
+//
+// Without the implementation the counters stay at zero; isInstalled() tells
+// the two apart.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace memory
+{
+//------------------------------------------------------------------------------
+struct AllocationCounter
+{
+  static uint64_t numAllocations() { return allocations().load(); }
+  static uint64_t numBytes() { return bytes().load(); }
+  static bool isInstalled() { return installed(); }
+
+  //----------------------------------------------------------------------------
+  static std::atomic<uint64_t>& allocations()
+  {
+    static std::atomic<uint64_t> count{0};
+    return count;
+  }
+  static std::atomic<uint64_t>& bytes()
+  {
+    static std::atomic<uint64_t> count{0};
+    return count;
+  }
+  static bool& installed()
+  {
+    static bool isInstalled = false;
+    return isInstalled;
+  }
+
+  static void onAllocation(size_t size)
+  {
+    allocations().fetch_add(1, std::memory_order_relaxed);
+    bytes().fetch_add(size, std::memory_order_relaxed);
+  }
+};
+
+}    // namespace memory
+
+//------------------------------------------------------------------------------
+#ifdef ALLOCATION_COUNTER_IMPLEMENTATION
+
+#include <cstdlib>
+#include <new>
+
+//------------------------------------------------------------------------------
+namespace memory
+{
+static const bool s_isCounterInstalled = (AllocationCounter::installed() = true);
+
+//------------------------------------------------------------------------------
+static void*
+countedAllocate(size_t size)
+{
+  AllocationCounter::onAllocation(size);
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+//------------------------------------------------------------------------------
+static void*
+countedAllocate(size_t size, std::align_val_t alignment)
+{
+  AllocationCounter::onAllocation(size);
+  const size_t align = static_cast<size_t>(alignment);
+#ifdef _MSC_VER
+  void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+  // aligned_alloc wants a multiple of the alignment
+  void* ptr = std::aligned_alloc(align, ((size + align - 1) / align) * align);
+#endif
+  if (!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+//------------------------------------------------------------------------------
+static void
+countedFree(void* ptr, std::align_val_t)
+{
+#ifdef _MSC_VER
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+}    // namespace memory
+
+//------------------------------------------------------------------------------
+// The nothrow forms forward to these
+void*
+operator new(size_t size)
+{
+  return memory::countedAllocate(size);
+}
+
+void*
+operator new[](size_t size)
+{
+  return memory::countedAllocate(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment)
+{
+  return memory::countedAllocate(size, alignment);
+}
+
+void*
+operator new[](size_t size, std::align_val_t alignment)
+{
+  return memory::countedAllocate(size, alignment);
+}
+
+void
+operator delete(void* ptr, std::align_val_t alignment) noexcept
+{
+  memory::countedFree(ptr, alignment);
+}
+
+void
+operator delete[](void* ptr, std::align_val_t alignment) noexcept
+{
+  memory::countedFree(ptr, alignment);
+}
+
+void
+operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept
+{
+  memory::countedFree(ptr, alignment);
+}
+
+void
+operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept
+{
+  memory::countedFree(ptr, alignment);
+}
+
+#endif    // ALLOCATION_COUNTER_IMPLEMENTATION
+
+//------------------------------------------------------------------------------
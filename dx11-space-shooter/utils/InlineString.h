@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+// Fixed capacity wide string, formatted in place
+//
+// For text that is reformatted every frame or on every change: the characters
+// live inline, and formatting goes through a format string compiled once with
+// fmt/compile.h straight into the buffer, so neither allocates. Text longer
+// than the capacity is truncated.
+//
+//  static const auto SCORE_FORMAT = fmt::compile<int>(FMT_STRING(L"{}"));
+//  strUtils::InlineWString<32> score;
+//  if (score.format(SCORE_FORMAT, playerScore)) { /* re-measure etc. */ }
+//
+// Portable, so it can be used by the simulation core and benchmarks.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "utils/StringUtils.h"
+
+#include "fmt/compile.h"
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cwchar>
+
+namespace strUtils
+{
+//------------------------------------------------------------------------------
+template <size_t Capacity>
+class InlineWString
+{
+  static_assert(Capacity > 0, "Needs room for the null terminator");
+
+public:
+  //----------------------------------------------------------------------------
+  // Each returns whether the text changed
+  //----------------------------------------------------------------------------
+  template <typename CompiledFormat, typename... Args>
+  bool format(const CompiledFormat& compiledFormat, const Args&... args)
+  {
+    const auto result = fmt::format_to_n(
+      m_scratch.data(), Capacity - 1, compiledFormat, args...);
+    const size_t length = std::min(result.size, Capacity - 1);
+    m_scratch[length]   = L'\0';
+    return commitScratch(length);
+  }
+
+  bool assign(const wchar_t* str)
+  {
+    const size_t length = std::min(std::wcslen(str), Capacity - 1);
+    std::copy(str, str + length, m_scratch.begin());
+    m_scratch[length] = L'\0';
+    return commitScratch(length);
+  }
+
+  bool assignUtf8(const char* str)
+  {
+    return commitScratch(utf8ToWide(str, m_scratch.data(), Capacity));
+  }
+
+  //----------------------------------------------------------------------------
+  const wchar_t* c_str() const { return m_text.data(); }
+  size_t size() const { return m_length; }
+  bool empty() const { return m_length == 0; }
+  fmt::wstring_view view() const { return {m_text.data(), m_length}; }
+
+private:
+  bool commitScratch(size_t length)
+  {
+    if (
+      length == m_length
+      && std::equal(
+        m_scratch.begin(), m_scratch.begin() + length, m_text.begin()))
+    {
+      return false;
+    }
+    std::copy_n(m_scratch.begin(), length + 1, m_text.begin());
+    m_length = length;
+    return true;
+  }
+
+  std::array<wchar_t, Capacity> m_text    = {};
+  std::array<wchar_t, Capacity> m_scratch = {};
+  size_t m_length                         = 0;
+};
+
+}    // namespace strUtils
+
+//------------------------------------------------------------------------------
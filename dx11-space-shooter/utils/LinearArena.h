@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------
+// Linear (bump pointer) arena for transient per-frame data
+//
+// Allocations are a pointer bump and are never freed individually; reset()
+// releases everything at once, typically at the start of each frame.
+// Running out of space allocates an overflow block from the heap, and the
+// next reset() merges the blocks into one big enough for the whole frame, so
+// the arena stops touching the heap once it has seen its largest frame.
+//
+// NOT thread-safe. Destructors of objects placed in the arena aren't run.
+// (Uses plain assert, utils/Log.h includes this for the profiler.)
+//
+// ArenaAllocator adapts an arena to the standard containers:
+//
+//  memory::ArenaVector<size_t> idxs{memory::ArenaAllocator<size_t>(arena)};
+//
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace memory
+{
+//------------------------------------------------------------------------------
+class LinearArena
+{
+public:
+  explicit LinearArena(size_t capacity = 0) { reserve(capacity); }
+
+  LinearArena(const LinearArena&) = delete;
+  LinearArena& operator=(const LinearArena&) = delete;
+
+  //----------------------------------------------------------------------------
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+  {
+    assert((alignment & (alignment - 1)) == 0);
+    size_t offset = alignUp(m_used, alignment);
+    if (offset + size > m_currentSize)
+    {
+      addOverflowBlock(size + alignment);
+      offset = alignUp(m_used, alignment);
+    }
+
+    m_used = offset + size;
+    m_numBytes += size;
+    return m_current + offset;
+  }
+
+  template <typename T>
+  T* allocate(size_t count)
+  {
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  //----------------------------------------------------------------------------
+  // Frees everything. Merges any overflow blocks, so the same load fits next
+  // time without allocating.
+  void reset()
+  {
+    if (!m_overflow.empty())
+    {
+      const size_t total = m_capacity + m_overflowSize;
+      m_overflow.clear();
+      m_overflowSize = 0;
+      m_block.reset();
+      reserve(total);
+    }
+
+    m_current     = m_block.get();
+    m_currentSize = m_capacity;
+    m_used        = 0;
+    m_numBytes    = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  size_t capacity() const { return m_capacity + m_overflowSize; }
+  size_t numBytesAllocated() const { return m_numBytes; }
+
+private:
+  //----------------------------------------------------------------------------
+  void reserve(size_t capacity)
+  {
+    if (capacity > 0)
+    {
+      m_block = std::make_unique<std::byte[]>(capacity);
+    }
+    m_capacity    = capacity;
+    m_current     = m_block.get();
+    m_currentSize = capacity;
+    m_used        = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  void addOverflowBlock(size_t minSize)
+  {
+    // Grow geometrically so a busy frame doesn't allocate block after block
+    const size_t size = std::max(minSize, capacity());
+    m_overflow.push_back(std::make_unique<std::byte[]>(size));
+    m_overflowSize += size;
+
+    m_current     = m_overflow.back().get();
+    m_currentSize = size;
+    m_used        = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  size_t alignUp(size_t offset, size_t alignment) const
+  {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(m_current) + offset;
+    const uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+    return offset + (aligned - address);
+  }
+
+  std::unique_ptr<std::byte[]> m_block;
+  size_t m_capacity = 0;
+
+  std::vector<std::unique_ptr<std::byte[]>> m_overflow;
+  size_t m_overflowSize = 0;
+
+  std::byte* m_current = nullptr;
+  size_t m_currentSize = 0;
+  size_t m_used        = 0;
+  size_t m_numBytes    = 0;
+};
+
+//------------------------------------------------------------------------------
+// Deallocation is a no-op, the memory comes back on LinearArena::reset().
+// Containers must not outlive the arena's next reset.
+//------------------------------------------------------------------------------
+template <typename T>
+struct ArenaAllocator
+{
+  using value_type = T;
+
+  // Containers that swap or move keep pointing at the right arena
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap            = std::true_type;
+
+  LinearArena* arena = nullptr;
+
+  //----------------------------------------------------------------------------
+  // Default constructed allocators can't allocate, they only let empty
+  // containers exist before an arena is assigned
+  ArenaAllocator() noexcept = default;
+  explicit ArenaAllocator(LinearArena& a) noexcept
+      : arena(&a)
+  {
+  }
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+      : arena(other.arena)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  T* allocate(size_t count)
+  {
+    assert(arena);
+    return arena->allocate<T>(count);
+  }
+  void deallocate(T*, size_t) noexcept {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const
+  {
+    return arena == other.arena;
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const
+  {
+    return arena != other.arena;
+  }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename Key, typename Value>
+using ArenaUnorderedMap = std::unordered_map<
+  Key,
+  Value,
+  std::hash<Key>,
+  std::equal_to<Key>,
+  ArenaAllocator<std::pair<const Key, Value>>>;
+
+}    // namespace memory
+
+//------------------------------------------------------------------------------
@@ -1,7 +1,21 @@
 //------------------------------------------------------------------------------
 // Very Basic Logging and profiler
 //
-// NOT thread-safe ( see printBuffer() )
+// Logging is NOT thread-safe ( see printBuffer() ).
+//
+// The profiler records on every thread that hasn't opted out with
+// TimedRaiiBlock::setThreadProfiled(false). Each thread writes its records and
+// open-block stack to its own buffers, and Stats::signalFrameEnd() (called
+// from one thread) merges them into the frame, a call graph lane per thread.
+// Blocks still open on other threads at the end of a frame are dropped.
+//
+// Record buffers are allocated once, by Stats::init() at startup (which also
+// measures TRACE's own overhead), or on the first TRACE otherwise. Records
+// beyond their capacity are dropped and counted, not allocated.
+//
+// Each TRACE registers its site (file, line and function) once, the first time
+// it runs, and records carry the site's id. Per frame totals are summed by
+// site id, so the profiler doesn't hash or compare strings.
 //
 // Usage: (in one cpp file only and only if profiler support is required)
 //
@@ -55,13 +69,19 @@
 #include <assert.h>
 #endif
 
+#include "utils/LinearArena.h"
+
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <unordered_map>
 #include <vector>
 #include <array>
 #include <string_view>
 #include <limits>
+#include <memory>
 
 namespace logger
 {
@@ -123,7 +143,7 @@ static const size_t BUFFER_SIZE = 12 * 1024;
 static char buffer[BUFFER_SIZE];
 
 //------------------------------------------------------------------------------
-static void printBuffer()
+static inline void printBuffer()
 {
   std::cout << buffer;
   #if defined(_WIN32) && defined(_DEBUG)
@@ -135,16 +155,32 @@ static void printBuffer()
 using Ticks = uint64_t;
 
 //------------------------------------------------------------------------------
-struct TimedRecord
+// Where a TRACE is. Each TRACE registers its site the first time it runs, and
+// records refer to it by its id, which counts up from 0 (see
+// Stats::registerSite()).
+//------------------------------------------------------------------------------
+struct TraceSite
 {
-  Ticks startTime;
-  Ticks duration;
+  static const int32_t NO_SITE = -1;
 
   int32_t lineNumber;
   const char* file;
   const char* function;
+};
+
+//------------------------------------------------------------------------------
+// The call graph links records by index into their frame's records (see
+// Stats::FrameRecords), so building it doesn't allocate
+struct TimedRecord
+{
+  static const int32_t NO_RECORD = -1;
+
+  Ticks startTime;
+  Ticks duration;
 
-  std::vector<TimedRecord*> childNodes;
+  int32_t siteId;
+  int32_t firstChild  = NO_RECORD;
+  int32_t nextSibling = NO_RECORD;
 };
 
 //------------------------------------------------------------------------------
@@ -181,6 +217,92 @@ struct AccumulatedValue
   }
 };
 
+//------------------------------------------------------------------------------
+// Counts of durations in log spaced buckets: SUB_BUCKETS per power of two, so
+// a percentile is within 1/(2 * SUB_BUCKETS) of the true value. Fixed size,
+// adding doesn't allocate.
+//------------------------------------------------------------------------------
+struct Histogram
+{
+  static const int SUB_BUCKETS = 4;
+  static const int NUM_BUCKETS = SUB_BUCKETS * 31;    // Up to 2^32 ticks
+
+  struct Percentiles
+  {
+    Ticks p50;
+    Ticks p95;
+    Ticks p99;
+    Ticks p999;
+  };
+
+  std::array<uint32_t, NUM_BUCKETS> counts = {};
+  uint32_t count                           = 0;
+  Ticks max                                = 0;
+
+  void add(Ticks value)
+  {
+    counts[bucketIdx(value)]++;
+    count++;
+    if (value > max)
+    {
+      max = value;
+    }
+  }
+
+  void clear() { *this = Histogram(); }
+
+  // The middle of the bucket holding each percentile, 0 when empty
+  Percentiles percentiles() const
+  {
+    const double fractions[] = {0.5, 0.95, 0.99, 0.999};
+    Ticks values[4]          = {};
+    int fractionIdx          = 0;
+    uint32_t numBelow        = 0;
+    for (int i = 0; i < NUM_BUCKETS && fractionIdx < 4; ++i)
+    {
+      numBelow += counts[i];
+      while (fractionIdx < 4 && numBelow > 0
+             && numBelow >= fractions[fractionIdx] * count)
+      {
+        const Ticks middle  = bucketMiddle(i);
+        values[fractionIdx] = (middle < max) ? middle : max;
+        fractionIdx++;
+      }
+    }
+    return {values[0], values[1], values[2], values[3]};
+  }
+
+  // Below SUB_BUCKETS each value has its own bucket. Above, value >> exponent
+  // is in [SUB_BUCKETS, 2 * SUB_BUCKETS).
+  static int bucketIdx(Ticks value)
+  {
+    if (value < SUB_BUCKETS)
+    {
+      return static_cast<int>(value);
+    }
+    int exponent = 0;
+    while ((value >> exponent) >= 2 * SUB_BUCKETS)
+    {
+      exponent++;
+    }
+    const int idx = (SUB_BUCKETS * (exponent + 1))
+                    + static_cast<int>((value >> exponent) - SUB_BUCKETS);
+    return (idx < NUM_BUCKETS) ? idx : NUM_BUCKETS - 1;
+  }
+
+  static Ticks bucketMiddle(int idx)
+  {
+    if (idx < SUB_BUCKETS)
+    {
+      return static_cast<Ticks>(idx);
+    }
+    const int exponent = (idx / SUB_BUCKETS) - 1;
+    const Ticks lowest = static_cast<Ticks>(idx % SUB_BUCKETS + SUB_BUCKETS)
+                         << exponent;
+    return lowest + ((Ticks(1) << exponent) / 2);
+  }
+};
+
 //------------------------------------------------------------------------------
 struct AccumulatedRecord
 {
@@ -194,10 +316,7 @@ struct CollatedRecord
 {
   Ticks ticks        = 0;
   int32_t callsCount = 0;
-
-  int32_t lineNumber;
-  const char* file;
-  const char* function;
+  int32_t siteId;
 };
 
 //------------------------------------------------------------------------------
@@ -224,39 +343,264 @@ struct Timing
 struct Stats
 {
   static const int FRAME_COUNT      = 120;
-  static const int MAX_RECORD_COUNT = 120;
+  static const int MAX_THREAD_COUNT = 16;
+  static const int MAX_SITE_COUNT   = 512;
+
+  // Record capacity, fixed by init() before the first TRACE. Records that
+  // don't fit are dropped and counted.
+  struct Config
+  {
+    int recordsPerThread = 120;    // Per thread, per frame
+    int recordsPerFrame  = 240;    // Of all threads together, per frame
+  };
+
+  //----------------------------------------------------------------------------
+  // A thread's records for one frame, as TRACE writes them. Only the owning
+  // thread writes; signalFrameEnd() reads the records published by numRecords
+  // and, of those, only the ones whose block has closed.
+  //----------------------------------------------------------------------------
+  static const uint32_t INVALID_FRAME = std::numeric_limits<uint32_t>::max();
+
+  struct StagedRecord
+  {
+    Ticks startTime;
+    Ticks duration;
+    std::atomic<bool> isClosed{false};
+
+    int32_t siteId;
+    int32_t parentIdx;    // NO_RECORD for the outermost block
+  };
 
-  using TimedRecordArray = std::array<TimedRecord, MAX_RECORD_COUNT>;
+  struct StagedFrame
+  {
+    std::atomic<uint32_t> frameNumber{INVALID_FRAME};
+    std::atomic<size_t> numRecords{0};
+    std::atomic<size_t> numDropped{0};
+    size_t capacity       = 0;
+    StagedRecord* records = nullptr;
+  };
+
+  // Double buffered by frame number, so the last frame can be merged while
+  // the thread records the next
+  struct ThreadRecords
+  {
+    std::atomic<const char*> name{nullptr};
+    std::array<StagedFrame, 2> frames;
+  };
+  using ThreadRecordsArray = std::array<ThreadRecords, MAX_THREAD_COUNT>;
+
+  //----------------------------------------------------------------------------
+  // A frame of all threads' records. Each lane is the call graph of one
+  // thread: its root spans the thread's outermost blocks, which are the root's
+  // children, and has no site. A lane's records are contiguous, in the order
+  // their blocks opened, from its root's firstChild.
+  //----------------------------------------------------------------------------
+  struct Lane
+  {
+    int32_t threadIdx;
+    const char* name;
+    TimedRecord root;
+  };
+  using LaneArray = std::array<Lane, MAX_THREAD_COUNT>;
   struct FrameRecords
   {
-    size_t numRecords          = 0;
-    TimedRecord* callGraphHead = nullptr;
-    TimedRecordArray records;
+    size_t numRecords    = 0;
+    size_t numDropped    = 0;
+    size_t numLanes      = 0;
+    Ticks duration       = 0;    // Since the last frame ended, 0 for the first
+    TimedRecord* records = nullptr;    // Config::recordsPerFrame of them
+    LaneArray lanes;
+
+    const TimedRecord* firstChild(const TimedRecord& record) const
+    {
+      return toRecord(record.firstChild);
+    }
+    const TimedRecord* nextSibling(const TimedRecord& record) const
+    {
+      return toRecord(record.nextSibling);
+    }
+    const TimedRecord* toRecord(int32_t idx) const
+    {
+      return (idx == TimedRecord::NO_RECORD) ? nullptr : &records[idx];
+    }
   };
   using IntervalRecords = std::array<FrameRecords, FRAME_COUNT>;
 
-  using CollatedFrameRecords    = std::unordered_map<size_t, CollatedRecord>;
+  // A frame's records summed by site, in the order the sites first ran
+  struct CollatedFrameRecords
+  {
+    size_t numRecords       = 0;
+    CollatedRecord* records = nullptr;    // Config::recordsPerFrame of them
+
+    const CollatedRecord* begin() const { return records; }
+    const CollatedRecord* end() const { return records + numRecords; }
+  };
   using CollatedIntervalRecords = std::array<CollatedFrameRecords, FRAME_COUNT>;
 
-  using AccumulatedRecords = std::unordered_map<size_t, AccumulatedRecord>;
+  // A frame slower than the spike threshold, with its call graph
+  struct Spike
+  {
+    uint32_t frameNumber = 0;
+    FrameRecords frame;
+  };
+
+  // Percentiles are taken over windows of frames, one filling while the last
+  // complete one is read. Each site's histogram counts its time per frame, in
+  // the frames it ran in.
+  static const int DEFAULT_PERCENTILE_WINDOW = 600;
+  struct PercentileWindows
+  {
+    int numFrames       = DEFAULT_PERCENTILE_WINDOW;    // Per window
+    int numFilled       = 0;
+    int fillingIdx      = 0;
+    bool hasCompleteOne = false;
+    std::array<Histogram, 2> frames;
+    std::array<Histogram*, 2> sites = {};    // MAX_SITE_COUNT of each
+  };
+
+  // Every record buffer and histogram, allocated once from one arena
+  struct Storage
+  {
+    explicit Storage(const Config& config);
+    static size_t arenaSize(const Config& config);
+
+    Config config;
+    memory::LinearArena arena;
+    IntervalRecords frames;
+    CollatedIntervalRecords collatedFrames;
+    ThreadRecordsArray threads;
+
+    // Scratch for mergeThreadRecords(), Config::recordsPerThread of each
+    int32_t* mergedIdxs    = nullptr;
+    int32_t* lastChildIdxs = nullptr;
+
+    // Scratch for condenseFrameRecords(), MAX_SITE_COUNT of them: each site's
+    // index into the frame's collated records, or NO_RECORD
+    int32_t* siteToCollatedIdxs = nullptr;
+
+    PercentileWindows percentiles;
+
+    Ticks lastFrameEndTime    = 0;
+    Ticks spikeThresholdTicks = 0;    // 0 for no spike capture
+    size_t numSpikes          = 0;
+    bool hasSpike             = false;
+    Spike spike;
+  };
+
+  // Indexed by site id, getNumSites() of them. Valid until the arena passed
+  // to accumulateRecords() is reset.
+  using AccumulatedRecords = memory::ArenaVector<AccumulatedRecord>;
 
   //----------------------------------------------------------------------------
+  // Call at startup, on the thread that calls signalFrameEnd(), before any
+  // TRACE. Allocates the record buffers and measures the cost of a TRACE.
+  static void init(const Config& config);
+  static void init() { init(Config()); }
+  static Storage& getStorage();
+  static const Config& getConfig() { return getStorage().config; }
+
+  // The time one empty TRACE scope adds to the scope enclosing it, as
+  // measured by init(). 0 until then.
+  static double getScopeOverheadMs() { return scopeOverheadMsByRef(); }
+  static double& scopeOverheadMsByRef()
+  {
+    static double overheadMs = 0.0;
+    return overheadMs;
+  }
+
+  // Registers a TRACE's site, once, from the static its expansion declares.
+  // Thread safe. Returns NO_SITE, and the TRACE does nothing, once there are
+  // MAX_SITE_COUNT sites.
+  static int32_t
+  registerSite(const int line, const char* file, const char* function);
+  static const TraceSite& getSite(int32_t siteId)
+  {
+    return getSitesByRef()[siteId];
+  }
+  // Sites below this are registered
+  static int32_t getNumSites()
+  {
+    const int32_t numSites = getNumSitesByRef().load();
+    return (numSites < MAX_SITE_COUNT) ? numSites : MAX_SITE_COUNT;
+  }
+  static std::array<TraceSite, MAX_SITE_COUNT>& getSitesByRef();
+  static std::atomic<int32_t>& getNumSitesByRef();
+
+  // Records dropped for want of capacity, since startup
+  static size_t getNumDroppedRecords() { return numDroppedRecordsByRef(); }
+  static size_t& numDroppedRecordsByRef()
+  {
+    static size_t numDropped = 0;
+    return numDropped;
+  }
+
   static IntervalRecords& getIntervalRecords();
   static FrameRecords& getFrameRecords(const int frameIdx);
 
   static CollatedIntervalRecords& getCollatedIntervalRecords();
   static CollatedFrameRecords& getCollatedFrameRecords(const int frameIdx);
 
+  // Only used by the thread calling signalFrameEnd()
   static int& getCurrentFrameIdx();
   static int& incrementCurrentFramedIdx();
 
+  // Counts every frame, for the threads recording it
+  static std::atomic<uint32_t>& getFrameNumber();
+
+  static std::atomic<int>& getNumThreadsByRef();
+
+  // Threads turned away as there were already MAX_THREAD_COUNT. Reported by
+  // signalFrameEnd(), as logging from the threads themselves isn't safe.
+  static int getNumRejectedThreads() { return numRejectedThreadsByRef(); }
+  static std::atomic<int>& numRejectedThreadsByRef()
+  {
+    static std::atomic<int> numRejected{0};
+    return numRejected;
+  }
+
+  //----------------------------------------------------------------------------
+  // Frame time and per site percentiles. Only used by the thread calling
+  // signalFrameEnd().
+  static void setPercentileWindow(int numFrames);
+  // The last complete window, or the one filling until there is one
+  static const Histogram& getFrameHistogram();
+  static const Histogram& getSiteHistogram(int32_t siteId);
+
+  // The first frame slower than the threshold is copied and kept, for
+  // inspection after the fact, until it is released. 0 turns capture off.
+  static void setSpikeThresholdMs(double thresholdMs);
+  static const Spike* getSpike();    // nullptr until one is captured
+  static void releaseSpike();
+  // Frames slower than the threshold, since startup
+  static size_t getNumSpikes() { return getStorage().numSpikes; }
+
+  // The calling thread's buffers, registered on its first TRACE. nullptr if
+  // it isn't profiled or there are already MAX_THREAD_COUNT threads.
+  static ThreadRecords* getThreadRecords();
+  static ThreadRecords*& threadRecordsByRef()
+  {
+    thread_local ThreadRecords* records = nullptr;
+    return records;
+  }
+
   static void clearFrame(FrameRecords& frame);
   static void clearCollatedFrame(CollatedFrameRecords& frame);
 
+  static void mergeThreadRecords(uint32_t frameNumber, FrameRecords& dstFrame);
   static void condenseFrameRecords(int frameIdx);
+  static void addToPercentiles(int frameIdx);
+  static void captureSpike(uint32_t frameNumber, const FrameRecords& frame);
   static void signalFrameEnd();
 
-  static AccumulatedRecords accumulateRecords();
+  static AccumulatedRecords accumulateRecords(memory::LinearArena& arena);
+
+private:
+  static Config& configByRef()
+  {
+    static Config config;
+    return config;
+  }
+  static void measureScopeOverhead();
 };
 
 //------------------------------------------------------------------------------
@@ -265,21 +609,39 @@ struct Stats
 struct TimedRaiiBlock
 {
   const TimedRaiiBlock* _parent = nullptr;
-  TimedRecord* _record          = nullptr;
+  Stats::StagedRecord* _record  = nullptr;
+  int32_t _recordIdx            = -1;
+  uint32_t _frameNumber         = 0;
 
   //----------------------------------------------------------------------------
-  TimedRaiiBlock(const int line, const char* file, const char* function);
+  explicit TimedRaiiBlock(const int32_t siteId);
 
   ~TimedRaiiBlock();
 
+  // Per thread
   static TimedRaiiBlock*& getCurrentOpenBlockByRef();
-};
 
-//------------------------------------------------------------------------------
+  // Labels the calling thread's lane in the flame graph. The string must
+  // outlive the profiler, e.g. a literal.
+  static void setThreadName(const char* name);
+  static const char*& threadNameByRef()
+  {
+    thread_local const char* name = nullptr;
+    return name;
+  }
 
-//------------------------------------------------------------------------------
-size_t
-createTimedRecordHash(const std::string_view& filePath, const int lineNumber);
+  // Threads which opt out aren't registered, TRACE does nothing on them
+  static bool isThreadProfiled() { return threadProfiledByRef(); }
+  static void setThreadProfiled(bool isProfiled)
+  {
+    threadProfiledByRef() = isProfiled;
+  }
+  static bool& threadProfiledByRef()
+  {
+    thread_local bool isProfiled = true;
+    return isProfiled;
+  }
+};
 
 //------------------------------------------------------------------------------
 } // namespace logger
@@ -341,8 +703,9 @@ _LG_MSG, ))  // NB. Intentionally trailing comma as _GET_NTH has a trailing ...
 //------------------------------------------------------------------------------
 #undef TIMED_TRACE_IMPL
 #define TIMED_TRACE_IMPL(N)                                                    \
-  logger::TimedRaiiBlock CAT(timedBlock_,N)(                                   \
-    __LINE__, __FILENAME__, __FUNCTION__);
+  static const int32_t CAT(traceSite_,N) = logger::Stats::registerSite(        \
+    __LINE__, __FILENAME__, __FUNCTION__);                                     \
+  logger::TimedRaiiBlock CAT(timedBlock_,N)(CAT(traceSite_,N));
 
 #undef TIMED_TRACE
 #define TIMED_TRACE TIMED_TRACE_IMPL(__COUNTER__);
@@ -605,12 +968,146 @@ Timing::ticksToMilliSeconds(Ticks ticks)
 
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+size_t
+Stats::Storage::arenaSize(const Config& config)
+{
+  const size_t perThread      = static_cast<size_t>(config.recordsPerThread);
+  const size_t perFrame       = static_cast<size_t>(config.recordsPerFrame);
+  const size_t perFrameRecord = sizeof(TimedRecord) + sizeof(CollatedRecord);
+  const size_t numArrays = (FRAME_COUNT * 2) + (MAX_THREAD_COUNT * 2) + 6;
+  return (FRAME_COUNT * perFrame * perFrameRecord)
+         + (MAX_THREAD_COUNT * 2 * perThread * sizeof(StagedRecord))
+         + (2 * perThread * sizeof(int32_t))
+         + (MAX_SITE_COUNT * sizeof(int32_t))
+         + (2 * MAX_SITE_COUNT * sizeof(Histogram))
+         + (perFrame * sizeof(TimedRecord))
+         + (numArrays * alignof(std::max_align_t));
+}
+
+//------------------------------------------------------------------------------
+Stats::Storage::Storage(const Config& config_)
+    : config(config_)
+    , arena(arenaSize(config_))
+{
+  const size_t perThread = static_cast<size_t>(config.recordsPerThread);
+  const size_t perFrame  = static_cast<size_t>(config.recordsPerFrame);
+  for (auto& frame : frames)
+  {
+    frame.records = arena.allocate<TimedRecord>(perFrame);
+    std::uninitialized_value_construct_n(frame.records, perFrame);
+  }
+  for (auto& frame : collatedFrames)
+  {
+    frame.records = arena.allocate<CollatedRecord>(perFrame);
+    std::uninitialized_value_construct_n(frame.records, perFrame);
+  }
+  for (auto& thread : threads)
+  {
+    for (auto& frame : thread.frames)
+    {
+      frame.capacity = perThread;
+      frame.records  = arena.allocate<StagedRecord>(perThread);
+      std::uninitialized_default_construct_n(frame.records, perThread);
+    }
+  }
+  mergedIdxs    = arena.allocate<int32_t>(perThread);
+  lastChildIdxs = arena.allocate<int32_t>(perThread);
+
+  siteToCollatedIdxs = arena.allocate<int32_t>(MAX_SITE_COUNT);
+  const int32_t NO_RECORD = TimedRecord::NO_RECORD;
+  std::fill_n(siteToCollatedIdxs, MAX_SITE_COUNT, NO_RECORD);
+
+  for (auto& sites : percentiles.sites)
+  {
+    sites = arena.allocate<Histogram>(MAX_SITE_COUNT);
+    std::uninitialized_value_construct_n(sites, MAX_SITE_COUNT);
+  }
+  spike.frame.records = arena.allocate<TimedRecord>(perFrame);
+  std::uninitialized_value_construct_n(spike.frame.records, perFrame);
+}
+
+//------------------------------------------------------------------------------
+Stats::Storage&
+Stats::getStorage()
+{
+  static Storage storage(configByRef());
+  return storage;
+}
+
+//------------------------------------------------------------------------------
+void
+Stats::init(const Config& config)
+{
+  [[maybe_unused]] static bool isInitialised = false;
+  ASSERT(!isInitialised);
+  isInitialised = true;
+
+  configByRef() = config;
+  if (getStorage().config.recordsPerFrame != config.recordsPerFrame
+      || getStorage().config.recordsPerThread != config.recordsPerThread)
+  {
+    LOG_WARNING("Profiler already in use, capacity left unchanged");
+  }
+  measureScopeOverhead();
+}
+
+//------------------------------------------------------------------------------
+// Times batches of empty scopes on this thread, then forgets their records.
+// The fastest batch is taken, as the others include interruptions.
+void
+Stats::measureScopeOverhead()
+{
+  const int NUM_BATCHES     = 16;
+  const size_t SCOPES_BATCH = 32;
+
+  ThreadRecords* thread = getThreadRecords();
+  if (!thread)
+  {
+    return;
+  }
+
+  static const int32_t siteId
+    = registerSite(__LINE__, __FILENAME__, "measureScopeOverhead");
+  Ticks fastestTicks = std::numeric_limits<Ticks>::max();
+  size_t numScopes   = 0;
+  for (int batch = 0; batch < NUM_BATCHES; ++batch)
+  {
+    auto& frame = thread->frames[getFrameNumber().load() % 2];
+    const size_t numStartRecords
+      = (frame.frameNumber.load() == getFrameNumber().load())
+          ? frame.numRecords.load()
+          : 0;
+    if (numStartRecords + SCOPES_BATCH > frame.capacity)
+    {
+      break;
+    }
+
+    const Ticks startTime = Timing::getCurrentTimeInTicks();
+    for (size_t i = 0; i < SCOPES_BATCH; ++i)
+    {
+      TimedRaiiBlock block(siteId);
+    }
+    fastestTicks
+      = std::min(fastestTicks, Timing::getCurrentTimeInTicks() - startTime);
+    numScopes = SCOPES_BATCH;
+
+    frame.numRecords.store(numStartRecords);
+  }
+
+  if (numScopes == 0)
+  {
+    return;
+  }
+  scopeOverheadMsByRef()
+    = Timing::ticksToMilliSeconds(fastestTicks) / numScopes;
+}
+
 //------------------------------------------------------------------------------
 Stats::IntervalRecords&
 Stats::getIntervalRecords()
 {
-  static IntervalRecords interval = Stats::IntervalRecords();
-  return interval;
+  return getStorage().frames;
 }
 
 //------------------------------------------------------------------------------
@@ -624,8 +1121,7 @@ Stats::getFrameRecords(const int frameIdx)
 Stats::CollatedIntervalRecords&
 Stats::getCollatedIntervalRecords()
 {
-  static CollatedIntervalRecords interval = CollatedIntervalRecords();
-  return interval;
+  return getStorage().collatedFrames;
 }
 
 //------------------------------------------------------------------------------
@@ -635,6 +1131,35 @@ Stats::getCollatedFrameRecords(const int frameIdx)
   return getCollatedIntervalRecords()[frameIdx];
 }
 
+//------------------------------------------------------------------------------
+int32_t
+Stats::registerSite(const int line, const char* file, const char* function)
+{
+  const int32_t siteId = getNumSitesByRef().fetch_add(1);
+  if (siteId >= MAX_SITE_COUNT)
+  {
+    return TraceSite::NO_SITE;
+  }
+  getSitesByRef()[siteId] = {line, file, function};
+  return siteId;
+}
+
+//------------------------------------------------------------------------------
+std::array<TraceSite, Stats::MAX_SITE_COUNT>&
+Stats::getSitesByRef()
+{
+  static std::array<TraceSite, MAX_SITE_COUNT> sites;
+  return sites;
+}
+
+//------------------------------------------------------------------------------
+std::atomic<int32_t>&
+Stats::getNumSitesByRef()
+{
+  static std::atomic<int32_t> numSites{0};
+  return numSites;
+}
+
 //------------------------------------------------------------------------------
 int&
 Stats::getCurrentFrameIdx()
@@ -656,69 +1181,376 @@ Stats::incrementCurrentFramedIdx()
 }
 
 //------------------------------------------------------------------------------
+std::atomic<uint32_t>&
+Stats::getFrameNumber()
+{
+  static std::atomic<uint32_t> frameNumber{0};
+  return frameNumber;
+}
+
+//------------------------------------------------------------------------------
+std::atomic<int>&
+Stats::getNumThreadsByRef()
+{
+  static std::atomic<int> numThreads{0};
+  return numThreads;
+}
+
+//------------------------------------------------------------------------------
+Stats::ThreadRecords*
+Stats::getThreadRecords()
+{
+  ThreadRecords*& records        = threadRecordsByRef();
+  thread_local bool isRegistered = false;
+  if (isRegistered || !TimedRaiiBlock::isThreadProfiled())
+  {
+    return records;
+  }
+
+  isRegistered    = true;
+  auto& threads   = getStorage().threads;
+  const int index = getNumThreadsByRef().fetch_add(1);
+  if (index >= MAX_THREAD_COUNT)
+  {
+    numRejectedThreadsByRef().fetch_add(1);
+    return nullptr;
+  }
+  records = &threads[index];
+  records->name.store(TimedRaiiBlock::threadNameByRef());
+  return records;
+}
+
+//------------------------------------------------------------------------------
+// Records are reinitialised as they're reused, see mergeThreadRecords()
 void
 Stats::clearFrame(FrameRecords& frame)
 {
-  TimedRecordArray temp;
-  frame.records.swap(temp);
-  frame.numRecords    = 0;
-  frame.callGraphHead = nullptr;
+  frame.numRecords = 0;
+  frame.numDropped = 0;
+  frame.numLanes   = 0;
+  frame.duration   = 0;
 }
 
 //------------------------------------------------------------------------------
 void
 Stats::clearCollatedFrame(CollatedFrameRecords& frame)
 {
-  CollatedFrameRecords temp;
-  frame.swap(temp);
+  frame.numRecords = 0;
+}
+
+//------------------------------------------------------------------------------
+// Rebuilds each thread's call graph for the frame from its staged records,
+// which are in the order the blocks opened, so a parent precedes its children
+void
+Stats::mergeThreadRecords(uint32_t frameNumber, FrameRecords& dstFrame)
+{
+  const int32_t NO_RECORD = TimedRecord::NO_RECORD;
+  auto& storage           = getStorage();
+  const int numRegistered = getNumThreadsByRef().load();
+  const int numThreads
+    = (numRegistered < MAX_THREAD_COUNT) ? numRegistered : MAX_THREAD_COUNT;
+  for (int threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+  {
+    const auto& srcFrame = storage.threads[threadIdx].frames[frameNumber % 2];
+    if (srcFrame.frameNumber.load(std::memory_order_acquire) != frameNumber)
+    {
+      continue;
+    }
+    const size_t numSrcRecords
+      = srcFrame.numRecords.load(std::memory_order_acquire);
+    dstFrame.numDropped += srcFrame.numDropped.load(std::memory_order_relaxed);
+
+    const char* name  = storage.threads[threadIdx].name.load();
+    Lane& dstLane     = dstFrame.lanes[dstFrame.numLanes];
+    dstLane.threadIdx = threadIdx;
+    dstLane.name      = name ? name : "Thread";
+    TimedRecord& lane = dstLane.root;
+    lane.startTime    = std::numeric_limits<Ticks>::max();
+    lane.duration     = 0;
+    lane.siteId       = TraceSite::NO_SITE;
+    lane.firstChild   = NO_RECORD;
+    lane.nextSibling  = NO_RECORD;
+    int32_t laneLastChild = NO_RECORD;
+    Ticks laneEndTime     = 0;
+
+    // Where each staged record was merged to, NO_RECORD if its block is still
+    // open, and the last child merged under it so far
+    int32_t* mergedIdxs    = storage.mergedIdxs;
+    int32_t* lastChildIdxs = storage.lastChildIdxs;
+    for (size_t i = 0; i < numSrcRecords; ++i)
+    {
+      mergedIdxs[i]         = NO_RECORD;
+      lastChildIdxs[i]      = NO_RECORD;
+      const auto& srcRecord = srcFrame.records[i];
+      if (!srcRecord.isClosed.load(std::memory_order_acquire))
+      {
+        continue;
+      }
+      // Parents always precede their children; anything else is orphaned
+      const int32_t parentIdx = srcRecord.parentIdx;
+      const bool isOutermost  = (parentIdx == NO_RECORD);
+      if (!isOutermost
+          && (parentIdx < 0 || parentIdx >= static_cast<int32_t>(i)
+              || mergedIdxs[parentIdx] == NO_RECORD))
+      {
+        continue;
+      }
+      if (dstFrame.numRecords >= size_t(storage.config.recordsPerFrame))
+      {
+        dstFrame.numDropped += 1;
+        continue;
+      }
+
+      const int32_t dstIdx = static_cast<int32_t>(dstFrame.numRecords++);
+      TimedRecord& record  = dstFrame.records[dstIdx];
+      record.startTime     = srcRecord.startTime;
+      record.duration      = srcRecord.duration;
+      record.siteId        = srcRecord.siteId;
+      record.firstChild    = NO_RECORD;
+      record.nextSibling   = NO_RECORD;
+      mergedIdxs[i]        = dstIdx;
+
+      // Append to the parent's children
+      TimedRecord& parent
+        = isOutermost ? lane : dstFrame.records[mergedIdxs[parentIdx]];
+      int32_t& lastChild
+        = isOutermost ? laneLastChild : lastChildIdxs[parentIdx];
+      if (lastChild == NO_RECORD)
+      {
+        parent.firstChild = dstIdx;
+      }
+      else
+      {
+        dstFrame.records[lastChild].nextSibling = dstIdx;
+      }
+      lastChild = dstIdx;
+
+      if (isOutermost)
+      {
+        lane.startTime = std::min(lane.startTime, record.startTime);
+        laneEndTime
+          = std::max(laneEndTime, record.startTime + record.duration);
+      }
+    }
+
+    if (lane.firstChild != NO_RECORD)
+    {
+      lane.duration = laneEndTime - lane.startTime;
+      dstFrame.numLanes++;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
+// Sums the frame's records by site. A frame has no more sites than records,
+// so the collated records always fit.
 void
 Stats::condenseFrameRecords(int frameIdx)
 {
   auto& dstFrame = getCollatedFrameRecords(frameIdx);
   clearCollatedFrame(dstFrame);
 
-  const auto& srcFrame = getFrameRecords(frameIdx);
+  int32_t* siteToCollatedIdxs = getStorage().siteToCollatedIdxs;
+  const auto& srcFrame        = getFrameRecords(frameIdx);
   for (size_t i = 0; i < srcFrame.numRecords; ++i)
   {
     const auto& srcRecord = srcFrame.records[i];
 
-    size_t hash = createTimedRecordHash(srcRecord.file, srcRecord.lineNumber);
-    auto& accumRecord = dstFrame[hash];
+    int32_t& collatedIdx = siteToCollatedIdxs[srcRecord.siteId];
+    if (collatedIdx == TimedRecord::NO_RECORD)
+    {
+      collatedIdx          = static_cast<int32_t>(dstFrame.numRecords++);
+      auto& newRecord      = dstFrame.records[collatedIdx];
+      newRecord.ticks      = 0;
+      newRecord.callsCount = 0;
+      newRecord.siteId     = srcRecord.siteId;
+    }
+    auto& accumRecord = dstFrame.records[collatedIdx];
 
     accumRecord.ticks += srcRecord.duration;
     accumRecord.callsCount++;
+  }
 
-    accumRecord.lineNumber = srcRecord.lineNumber;
-    accumRecord.file       = srcRecord.file;
-    accumRecord.function   = srcRecord.function;
+  // Leave the scratch clear for the next frame
+  for (const auto& record : dstFrame)
+  {
+    siteToCollatedIdxs[record.siteId] = TimedRecord::NO_RECORD;
   }
 }
 
+//------------------------------------------------------------------------------
+// Starts the next window once this one is full
+void
+Stats::addToPercentiles(int frameIdx)
+{
+  auto& windows     = getStorage().percentiles;
+  const auto& frame = getFrameRecords(frameIdx);
+  if (frame.duration > 0)
+  {
+    windows.frames[windows.fillingIdx].add(frame.duration);
+  }
+  Histogram* sites = windows.sites[windows.fillingIdx];
+  for (const auto& record : getCollatedFrameRecords(frameIdx))
+  {
+    sites[record.siteId].add(record.ticks);
+  }
+
+  if (++windows.numFilled < windows.numFrames)
+  {
+    return;
+  }
+  windows.numFilled      = 0;
+  windows.hasCompleteOne = true;
+  windows.fillingIdx     = 1 - windows.fillingIdx;
+  windows.frames[windows.fillingIdx].clear();
+  Histogram* nextSites = windows.sites[windows.fillingIdx];
+  for (int32_t siteId = 0; siteId < getNumSites(); ++siteId)
+  {
+    nextSites[siteId].clear();
+  }
+}
+
+//------------------------------------------------------------------------------
+void
+Stats::captureSpike(uint32_t frameNumber, const FrameRecords& frame)
+{
+  auto& storage = getStorage();
+  if (storage.spikeThresholdTicks == 0
+      || frame.duration <= storage.spikeThresholdTicks)
+  {
+    return;
+  }
+  storage.numSpikes++;
+  if (storage.hasSpike)
+  {
+    return;
+  }
+
+  // The records link by index, so a copy keeps the call graph
+  storage.hasSpike          = true;
+  storage.spike.frameNumber = frameNumber;
+  FrameRecords& dstFrame    = storage.spike.frame;
+  dstFrame.numRecords       = frame.numRecords;
+  dstFrame.numDropped       = frame.numDropped;
+  dstFrame.numLanes         = frame.numLanes;
+  dstFrame.duration         = frame.duration;
+  dstFrame.lanes            = frame.lanes;
+  std::copy_n(frame.records, frame.numRecords, dstFrame.records);
+}
+
 //------------------------------------------------------------------------------
 void
 Stats::signalFrameEnd()
 {
+  auto& storage            = getStorage();
+  const Ticks endTime      = Timing::getCurrentTimeInTicks();
+  const Ticks lastEndTime  = storage.lastFrameEndTime;
+  storage.lastFrameEndTime = endTime;
+
+  // Threads start recording the next frame into their other buffer
+  const uint32_t frameNumber = getFrameNumber().fetch_add(1);
+  auto& frame                = getFrameRecords(getCurrentFrameIdx());
+  mergeThreadRecords(frameNumber, frame);
+  if (lastEndTime != 0)
+  {
+    frame.duration = Timing::getClampedDuration(lastEndTime, endTime);
+  }
   condenseFrameRecords(getCurrentFrameIdx());
+  addToPercentiles(getCurrentFrameIdx());
+  captureSpike(frameNumber, frame);
+
+  if (frame.numDropped > 0)
+  {
+    LOG_WARNING_IF(
+      getNumDroppedRecords() == 0,
+      "Profiler records dropped, increase Stats::Config capacity");
+    numDroppedRecordsByRef() += frame.numDropped;
+  }
+  if (getNumSitesByRef().load() > MAX_SITE_COUNT)
+  {
+    static bool isWarned = false;
+    LOG_WARNING_IF(
+      !isWarned, "MAX_SITE_COUNT exceeded, later TRACE sites aren't timed");
+    isWarned = true;
+  }
+  static int numReportedThreads = 0;
+  const int numRejectedThreads  = getNumRejectedThreads();
+  if (numRejectedThreads > numReportedThreads)
+  {
+    LOG_WARNING(
+      "MAX_THREAD_COUNT exceeded, %d threads aren't profiled",
+      numRejectedThreads);
+    numReportedThreads = numRejectedThreads;
+  }
 
   int newIdx = incrementCurrentFramedIdx();
   clearFrame(getFrameRecords(newIdx));
 }
 
+//------------------------------------------------------------------------------
+void
+Stats::setPercentileWindow(int numFrames)
+{
+  auto& windows     = getStorage().percentiles;
+  windows.numFrames = (numFrames > 0) ? numFrames : 1;
+}
+
+//------------------------------------------------------------------------------
+const Histogram&
+Stats::getFrameHistogram()
+{
+  const auto& windows = getStorage().percentiles;
+  const int idx
+    = windows.hasCompleteOne ? 1 - windows.fillingIdx : windows.fillingIdx;
+  return windows.frames[idx];
+}
+
+//------------------------------------------------------------------------------
+const Histogram&
+Stats::getSiteHistogram(int32_t siteId)
+{
+  const auto& windows = getStorage().percentiles;
+  const int idx
+    = windows.hasCompleteOne ? 1 - windows.fillingIdx : windows.fillingIdx;
+  return windows.sites[idx][siteId];
+}
+
+//------------------------------------------------------------------------------
+void
+Stats::setSpikeThresholdMs(double thresholdMs)
+{
+  const double ticks = thresholdMs * Timing::getQpcFrequency()
+                       / Timing::MILLISECONDS_PER_SECOND;
+  getStorage().spikeThresholdTicks = static_cast<Ticks>(ticks);
+}
+
+//------------------------------------------------------------------------------
+const Stats::Spike*
+Stats::getSpike()
+{
+  auto& storage = getStorage();
+  return storage.hasSpike ? &storage.spike : nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+Stats::releaseSpike()
+{
+  getStorage().hasSpike = false;
+}
+
 //------------------------------------------------------------------------------
 Stats::AccumulatedRecords
-Stats::accumulateRecords()
+Stats::accumulateRecords(memory::LinearArena& arena)
 {
-  AccumulatedRecords accumulatedRecords;
+  AccumulatedRecords accumulatedRecords(
+    getNumSites(), AccumulatedRecords::allocator_type(arena));
   const auto& srcFrames = getCollatedIntervalRecords();
   for (const auto& frame : srcFrames)
   {
-    for (const auto& r : frame)
+    for (const auto& srcRecord : frame)
     {
-      const auto& srcRecord = r.second;
-      auto& record          = accumulatedRecords[r.first];
+      auto& record = accumulatedRecords[srcRecord.siteId];
 
       record.ticks.accumulate(srcRecord.ticks);
       record.callsCount.accumulate(srcRecord.callsCount);
@@ -732,47 +1564,59 @@ Stats::accumulateRecords()
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
-TimedRaiiBlock::TimedRaiiBlock(
-  const int line, const char* file, const char* function)
-    : _parent(getCurrentOpenBlockByRef())
+TimedRaiiBlock::TimedRaiiBlock(const int32_t siteId)
 {
-  getCurrentOpenBlockByRef() = this;
-
-  auto& currentFrame = Stats::getFrameRecords(Stats::getCurrentFrameIdx());
-  auto recordIndex   = currentFrame.numRecords;
-
-  TimedRecord& record = currentFrame.records[recordIndex];
-  _record             = &record;
-  _record->startTime  = Timing::getCurrentTimeInTicks();
-  _record->lineNumber = line;
-  _record->file       = file;
-  _record->function   = function;
-
-  if (_parent)
-  {
-    _parent->_record->childNodes.push_back(_record);
-  }
-  else
+  Stats::ThreadRecords* thread = Stats::getThreadRecords();
+  if (!thread || siteId == TraceSite::NO_SITE)
   {
-    currentFrame.callGraphHead = _record;
+    return;
   }
 
-  if (currentFrame.numRecords < Stats::MAX_RECORD_COUNT - 1)
+  // The first block of a frame on this thread reuses the buffer of two frames
+  // ago, which signalFrameEnd() has finished merging
+  const uint32_t frameNumber = Stats::getFrameNumber().load();
+  auto& frame                = thread->frames[frameNumber % 2];
+  if (frame.frameNumber.load(std::memory_order_relaxed) != frameNumber)
   {
-    currentFrame.numRecords++;
+    frame.numRecords.store(0, std::memory_order_relaxed);
+    frame.numDropped.store(0, std::memory_order_relaxed);
+    frame.frameNumber.store(frameNumber, std::memory_order_release);
   }
-  else
+
+  // Not logged here, as logging isn't thread-safe. signalFrameEnd() reports it.
+  const size_t recordIdx = frame.numRecords.load(std::memory_order_relaxed);
+  if (recordIdx >= frame.capacity)
   {
-    LOG_ERROR("MAX_RECORD_COUNT exceeded. Increase Value");
+    frame.numDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
   }
+
+  // A block opened in an earlier frame is left out of this one's call graph
+  _parent = getCurrentOpenBlockByRef();
+  getCurrentOpenBlockByRef() = this;
+
+  _record      = &frame.records[recordIdx];
+  _recordIdx   = static_cast<int32_t>(recordIdx);
+  _frameNumber = frameNumber;
+  _record->isClosed.store(false, std::memory_order_relaxed);
+  _record->siteId    = siteId;
+  _record->parentIdx = (_parent && _parent->_frameNumber == _frameNumber)
+                         ? _parent->_recordIdx
+                         : TimedRecord::NO_RECORD;
+  _record->startTime = Timing::getCurrentTimeInTicks();
+  frame.numRecords.store(recordIdx + 1, std::memory_order_release);
 }
 
 //------------------------------------------------------------------------------
 TimedRaiiBlock::~TimedRaiiBlock()
 {
-  ASSERT(_record);
+  if (!_record)
+  {
+    return;
+  }
   _record->duration = Timing::getClampedDuration(
     _record->startTime, Timing::getCurrentTimeInTicks());
+  _record->isClosed.store(true, std::memory_order_release);
 
   getCurrentOpenBlockByRef() = const_cast<TimedRaiiBlock*>(_parent);
 }
@@ -781,25 +1625,19 @@ TimedRaiiBlock::~TimedRaiiBlock()
 TimedRaiiBlock*&
 TimedRaiiBlock::getCurrentOpenBlockByRef()
 {
-  static TimedRaiiBlock* current = nullptr;
+  thread_local TimedRaiiBlock* current = nullptr;
   return current;
 }
 
 //------------------------------------------------------------------------------
-
-//------------------------------------------------------------------------------
-size_t
-createTimedRecordHash(const std::string_view& filePath, const int lineNumber)
-{
-  // Don't bother hashing the full path. Only the last few characters
-  // will differ enough to be useful for hashing.
-  const size_t NUM_CHARS = 12;
-  const size_t subPos
-    = (filePath.length() > NUM_CHARS) ? filePath.length() - NUM_CHARS : 0;
-  const std::string_view file = filePath.substr(subPos);
-  const std::size_t h1        = std::hash<std::string_view>{}(file);
-  const std::size_t h2        = std::hash<int>{}(lineNumber);
-  return h1 ^ (h2 << 1);
+void
+TimedRaiiBlock::setThreadName(const char* name)
+{
+  threadNameByRef() = name;
+  if (Stats::ThreadRecords* thread = Stats::threadRecordsByRef())
+  {
+    thread->name.store(name);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+// UTF-8 <-> wide string conversion
+//
+// Portable (no Win32 dependency) so it can be shared by the simulation core.
+// wchar_t is treated as UTF-16 where it is 2 bytes wide (Windows) and as
+// UTF-32 elsewhere.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace strUtils
+{
+//------------------------------------------------------------------------------
+inline std::string
+wstringToUtf8(const std::wstring& str)
+{
+  std::string outStr;
+  outStr.reserve(str.length());
+
+  for (size_t i = 0; i < str.length(); ++i)
+  {
+    uint32_t codePoint = static_cast<uint32_t>(str[i]);
+    if (
+      sizeof(wchar_t) == 2 && (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+      && (i + 1 < str.length()))
+    {
+      const uint32_t low = static_cast<uint32_t>(str[i + 1]);
+      if (low >= 0xDC00 && low <= 0xDFFF)
+      {
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        ++i;
+      }
+    }
+
+    if (codePoint < 0x80)
+    {
+      outStr.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+      outStr.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+      outStr.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+      outStr.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+      outStr.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+      outStr.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+      outStr.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+      outStr.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+      outStr.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+      outStr.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+  }
+  return outStr;
+}
+
+//------------------------------------------------------------------------------
+// Calls push(wchar_t) for each wide character decoded from the UTF-8 string
+//------------------------------------------------------------------------------
+template <typename PushFunc>
+void
+decodeUtf8(const char* str, size_t len, PushFunc push)
+{
+  const auto* bytes = reinterpret_cast<const unsigned char*>(str);
+  for (size_t i = 0; i < len;)
+  {
+    uint32_t codePoint = bytes[i];
+    size_t numTrailing = 0;
+    if (codePoint >= 0xF0)
+    {
+      codePoint &= 0x07;
+      numTrailing = 3;
+    }
+    else if (codePoint >= 0xE0)
+    {
+      codePoint &= 0x0F;
+      numTrailing = 2;
+    }
+    else if (codePoint >= 0xC0)
+    {
+      codePoint &= 0x1F;
+      numTrailing = 1;
+    }
+    ++i;
+
+    for (size_t t = 0; t < numTrailing && i < len; ++t, ++i)
+    {
+      codePoint = (codePoint << 6) | (bytes[i] & 0x3F);
+    }
+
+    if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+    {
+      codePoint -= 0x10000;
+      push(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+      push(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+    }
+    else
+    {
+      push(static_cast<wchar_t>(codePoint));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+inline std::wstring
+utf8ToWstring(const char* str)
+{
+  const size_t len = strlen(str);
+  std::wstring outStr;
+  outStr.reserve(len);
+  decodeUtf8(str, len, [&outStr](wchar_t c) { outStr.push_back(c); });
+  return outStr;
+}
+
+//------------------------------------------------------------------------------
+// Converts into a caller supplied buffer, without allocating. The result is
+// truncated to fit and always null terminated. Returns its length.
+//------------------------------------------------------------------------------
+inline size_t
+utf8ToWide(const char* str, wchar_t* outBuffer, size_t bufferSize)
+{
+  if (bufferSize == 0)
+  {
+    return 0;
+  }
+
+  size_t outLen = 0;
+  decodeUtf8(str, strlen(str), [&](wchar_t c) {
+    if (outLen + 1 < bufferSize)
+    {
+      outBuffer[outLen++] = c;
+    }
+  });
+  outBuffer[outLen] = L'\0';
+  return outLen;
+}
+
+}    // namespace strUtils
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,393 @@
+//------------------------------------------------------------------------------
+// Streams the profiler's TRACE records to Chrome trace-event JSON files
+//
+// Each frame merged by logger::Stats::signalFrameEnd() is copied into a
+// preallocated queue, and a background thread writes it out as complete ("X")
+// events, one thread per profiler lane. The files load into chrome://tracing,
+// Perfetto (ui.perfetto.dev) and other trace viewers.
+//
+// Frames are written to a rolling window of files: <path>.<n>.json, each
+// holding framesPerFile frames and each a complete trace on its own. Once
+// numFiles files are written the oldest is deleted, so a long run keeps only
+// its most recent frames on disk.
+//
+// Queuing doesn't allocate. When the writer falls behind, frames are dropped
+// and counted, or with isLossless the caller waits for room instead.
+//
+// Usage: (in one cpp file only, which also has the profiler implementation)
+//
+//  #define TRACE_EXPORTER_IMPLEMENTATION
+//  #include "utils/TraceExporter.h"
+//
+//  logger::TraceExporter exporter({"capture"});
+//  ...
+//  logger::Stats::signalFrameEnd();
+//  exporter.submitLastFrame();
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace logger
+{
+//------------------------------------------------------------------------------
+class TraceExporter
+{
+public:
+  struct Config
+  {
+    const char* path       = "trace";
+    uint32_t framesPerFile = 600;
+    uint32_t numFiles      = 10;
+    uint32_t queueFrames   = 256;
+    bool isLossless        = false;
+  };
+
+  explicit TraceExporter(const Config& config);
+  ~TraceExporter();    // Writes out the queued frames first
+
+  TraceExporter(const TraceExporter&) = delete;
+  TraceExporter& operator=(const TraceExporter&) = delete;
+
+  // Queues the frame Stats::signalFrameEnd() just merged. Call straight
+  // after it, from the same thread.
+  void submitLastFrame();
+
+  uint64_t numWrittenFrames() const { return m_numWrittenFrames.load(); }
+  uint64_t numDroppedFrames() const { return m_numDroppedFrames; }
+
+private:
+  struct Event
+  {
+    Ticks startTime;
+    Ticks duration;
+    int32_t siteId;
+    int32_t lane;
+  };
+
+  struct Lane
+  {
+    int32_t threadIdx;
+    const char* name;
+  };
+
+  // Single producer (submitLastFrame), single consumer (the writer thread)
+  struct Packet
+  {
+    uint64_t frameNumber = 0;
+    size_t numEvents     = 0;
+    size_t numLanes      = 0;
+    std::array<Lane, Stats::MAX_THREAD_COUNT> lanes;
+    Event* events = nullptr;
+  };
+
+  void writerLoop();
+  void write(const Packet& packet);
+  void openFile();
+  void closeFile();
+  void writeString(const char* str);
+
+  Config m_config;
+  Ticks m_baseTime            = 0;    // Set by the first submitLastFrame()
+  double m_ticksToUs          = 0.0;
+  uint64_t m_numFrames        = 0;
+  uint64_t m_numDroppedFrames = 0;
+
+  std::vector<Packet> m_packets;
+  std::vector<Event> m_events;
+  std::atomic<uint64_t> m_head{0};    // Next packet to write
+  std::atomic<uint64_t> m_tail{0};    // Next packet to fill
+  std::atomic<uint64_t> m_numWrittenFrames{0};
+  std::atomic<bool> m_isQuitting{false};
+  std::atomic<bool> m_hasFileError{false};    // Logged by submitLastFrame()
+
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  std::thread m_writer;
+
+  // Only used by the writer thread
+  std::FILE* m_file     = nullptr;
+  uint64_t m_fileIdx    = 0;
+  uint32_t m_fileFrames = 0;
+  bool m_isFirstEvent   = true;
+  std::array<bool, Stats::MAX_THREAD_COUNT> m_isLaneNamed = {};
+};
+
+}    // namespace logger
+
+//------------------------------------------------------------------------------
+#ifdef TRACE_EXPORTER_IMPLEMENTATION
+
+#include <chrono>
+
+//------------------------------------------------------------------------------
+namespace logger
+{
+//------------------------------------------------------------------------------
+TraceExporter::TraceExporter(const Config& config)
+    : m_config(config)
+    , m_ticksToUs(1e6 / Timing::getQpcFrequency())
+    , m_packets(config.queueFrames)
+{
+  const size_t eventsPerFrame = Stats::getConfig().recordsPerFrame;
+  m_events.resize(m_packets.size() * eventsPerFrame);
+  for (size_t i = 0; i < m_packets.size(); ++i)
+  {
+    m_packets[i].events = &m_events[i * eventsPerFrame];
+  }
+  m_writer = std::thread([this] { writerLoop(); });
+}
+
+//------------------------------------------------------------------------------
+TraceExporter::~TraceExporter()
+{
+  m_isQuitting = true;
+  m_wake.notify_one();
+  m_writer.join();
+}
+
+//------------------------------------------------------------------------------
+void
+TraceExporter::submitLastFrame()
+{
+  TRACE
+  if (m_hasFileError.exchange(false))
+  {
+    LOG_ERROR("Unable to write the trace to %s.<n>.json", m_config.path);
+  }
+
+  const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+  while (tail - m_head.load(std::memory_order_acquire) >= m_packets.size())
+  {
+    if (!m_config.isLossless)
+    {
+      m_numDroppedFrames++;
+      m_numFrames++;
+      return;
+    }
+    m_wake.notify_one();
+    std::this_thread::yield();
+  }
+
+  const int frameCount = Stats::FRAME_COUNT;
+  const int frameIdx
+    = (Stats::getCurrentFrameIdx() + frameCount - 1) % frameCount;
+  const auto& frame = Stats::getFrameRecords(frameIdx);
+
+  // Timestamps count from the first frame's earliest record, which may have
+  // opened before the exporter did. The packet's release publishes it.
+  if (m_numFrames == 0)
+  {
+    m_baseTime = Timing::getCurrentTimeInTicks();
+    for (size_t i = 0; i < frame.numLanes; ++i)
+    {
+      m_baseTime = std::min(m_baseTime, frame.lanes[i].root.startTime);
+    }
+  }
+
+  Packet& packet     = m_packets[tail % m_packets.size()];
+  packet.frameNumber = m_numFrames++;
+  packet.numEvents   = 0;
+  packet.numLanes    = frame.numLanes;
+
+  // Each lane's records are contiguous, starting with its first child
+  for (size_t laneIdx = 0; laneIdx < frame.numLanes; ++laneIdx)
+  {
+    const Stats::Lane& lane = frame.lanes[laneIdx];
+    packet.lanes[laneIdx]   = {lane.threadIdx, lane.name};
+
+    const size_t begin = static_cast<size_t>(lane.root.firstChild);
+    size_t end         = frame.numRecords;
+    if (laneIdx + 1 < frame.numLanes)
+    {
+      end = static_cast<size_t>(frame.lanes[laneIdx + 1].root.firstChild);
+    }
+    for (size_t i = begin; i < end; ++i)
+    {
+      const TimedRecord& record = frame.records[i];
+      Event& event              = packet.events[packet.numEvents++];
+      event.startTime           = record.startTime;
+      event.duration            = record.duration;
+      event.siteId              = record.siteId;
+      event.lane                = lane.threadIdx;
+    }
+  }
+
+  m_tail.store(tail + 1, std::memory_order_release);
+  m_wake.notify_one();
+}
+
+//------------------------------------------------------------------------------
+void
+TraceExporter::writerLoop()
+{
+  TimedRaiiBlock::setThreadProfiled(false);
+
+  for (;;)
+  {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire))
+    {
+      if (m_isQuitting)
+      {
+        break;
+      }
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait_for(lock, std::chrono::milliseconds(10));
+      continue;
+    }
+
+    write(m_packets[head % m_packets.size()]);
+    m_head.store(head + 1, std::memory_order_release);
+    m_numWrittenFrames++;
+  }
+  closeFile();
+}
+
+//------------------------------------------------------------------------------
+void
+TraceExporter::write(const Packet& packet)
+{
+  if (m_file && m_fileFrames >= m_config.framesPerFile)
+  {
+    closeFile();
+  }
+  if (!m_file)
+  {
+    openFile();
+    if (!m_file)
+    {
+      return;
+    }
+  }
+  m_fileFrames++;
+
+  for (size_t i = 0; i < packet.numLanes; ++i)
+  {
+    const Lane& lane = packet.lanes[i];
+    if (m_isLaneNamed[lane.threadIdx])
+    {
+      continue;
+    }
+    m_isLaneNamed[lane.threadIdx] = true;
+    std::fprintf(
+      m_file,
+      "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+      "\"args\":{\"name\":\"",
+      m_isFirstEvent ? "" : ",",
+      lane.threadIdx);
+    writeString(lane.name);
+    std::fprintf(m_file, " %d\"}}", lane.threadIdx);
+    m_isFirstEvent = false;
+  }
+
+  for (size_t i = 0; i < packet.numEvents; ++i)
+  {
+    const Event& event    = packet.events[i];
+    const TraceSite& site = Stats::getSite(event.siteId);
+    std::fprintf(m_file, "%s\n{\"name\":\"", m_isFirstEvent ? "" : ",");
+    writeString(site.function);
+    std::fprintf(
+      m_file,
+      "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,"
+      "\"args\":{\"file\":\"",
+      static_cast<int64_t>(event.startTime - m_baseTime) * m_ticksToUs,
+      event.duration * m_ticksToUs,
+      event.lane);
+    writeString(site.file);
+    std::fprintf(
+      m_file,
+      "\",\"line\":%d,\"frame\":%llu}}",
+      site.lineNumber,
+      static_cast<unsigned long long>(packet.frameNumber));
+    m_isFirstEvent = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Starts the next file of the window, deleting the one that falls out of it
+void
+TraceExporter::openFile()
+{
+  char fileName[1024];
+  if (m_fileIdx >= m_config.numFiles)
+  {
+    std::snprintf(
+      fileName,
+      sizeof(fileName),
+      "%s.%llu.json",
+      m_config.path,
+      static_cast<unsigned long long>(m_fileIdx - m_config.numFiles));
+    std::remove(fileName);
+  }
+
+  std::snprintf(
+    fileName,
+    sizeof(fileName),
+    "%s.%llu.json",
+    m_config.path,
+    static_cast<unsigned long long>(m_fileIdx));
+  m_fileIdx++;
+  m_fileFrames   = 0;
+  m_isFirstEvent = true;
+  m_isLaneNamed  = {};
+
+  m_file = std::fopen(fileName, "w");
+  if (!m_file)
+  {
+    m_hasFileError = true;
+    return;
+  }
+  std::fprintf(m_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+}
+
+//------------------------------------------------------------------------------
+void
+TraceExporter::closeFile()
+{
+  if (!m_file)
+  {
+    return;
+  }
+  std::fprintf(m_file, "\n]}\n");
+  std::fclose(m_file);
+  m_file = nullptr;
+}
+
+//------------------------------------------------------------------------------
+// As a JSON string's contents
+void
+TraceExporter::writeString(const char* str)
+{
+  for (; *str; ++str)
+  {
+    const unsigned char c = static_cast<unsigned char>(*str);
+    if (c == '"' || c == '\\')
+    {
+      std::fputc('\\', m_file);
+      std::fputc(c, m_file);
+    }
+    else if (c < 0x20)
+    {
+      std::fprintf(m_file, "\\u%04x", c);
+    }
+    else
+    {
+      std::fputc(c, m_file);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+}    // namespace logger
+
+#endif    // TRACE_EXPORTER_IMPLEMENTATION